@@ -0,0 +1,113 @@
+#pragma once
+
+#include "base/magic.hpp"
+#include "base/third_party/range.h"
+#include "base/third_party/sarray.h"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace flexps {
+
+/*
+ * Helpers for the keyless dense requests (kAddRange, kGetRange and kGetRangeReply).
+ *
+ * Instead of one key per value, data[0] of these messages holds the runs of consecutive keys of a
+ * sorted request as [first_0, last_0, first_1, last_1, ...], and the values are those of the keys
+ * of the runs in order. The last key of a run is inclusive so that the runs fit in the narrow keys
+ * of base/key_width.hpp, whose tables may end at key 2^32.
+ */
+
+// Whether the sorted keys form at most keys.size() / min_run_length runs.
+inline bool IsDense(const third_party::SArray<Key>& keys, size_t min_run_length) {
+  if (keys.empty())
+    return false;
+  size_t num_runs = 1;
+  for (size_t i = 1; i < keys.size(); ++i)
+    num_runs += (keys[i] != keys[i - 1] + 1);
+  return num_runs * min_run_length <= keys.size();
+}
+
+// The runs of the sorted keys.
+inline third_party::SArray<Key> ToKeyRanges(const third_party::SArray<Key>& keys) {
+  third_party::SArray<Key> ranges;
+  if (keys.empty())
+    return ranges;
+  ranges.push_back(keys[0]);
+  for (size_t i = 1; i < keys.size(); ++i) {
+    if (keys[i] != keys[i - 1] + 1) {
+      ranges.push_back(keys[i - 1]);
+      ranges.push_back(keys[i]);
+    }
+  }
+  ranges.push_back(keys[keys.size() - 1]);
+  return ranges;
+}
+
+// Call f(first, len, pos) for every run, pos being the index of the value of its first key.
+template <typename F>
+inline void ForEachKeyRange(const third_party::SArray<Key>& ranges, F f) {
+  CHECK_EQ(ranges.size() % 2, 0) << "Key ranges come in pairs";
+  size_t pos = 0;
+  for (size_t i = 0; i < ranges.size(); i += 2) {
+    DCHECK_LE(ranges[i], ranges[i + 1]);
+    size_t len = static_cast<size_t>(ranges[i + 1] - ranges[i]) + 1;
+    f(ranges[i], len, pos);
+    pos += len;
+  }
+}
+
+// As above, for the values at [begin, end) only: the runs are clipped to them.
+template <typename F>
+inline void ForEachKeyRange(const third_party::SArray<Key>& ranges, size_t begin, size_t end, F f) {
+  ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+    size_t lo = pos > begin ? pos : begin;
+    size_t hi = pos + len < end ? pos + len : end;
+    if (lo < hi)
+      f(first + (lo - pos), hi - lo, lo);
+  });
+}
+
+inline size_t NumKeysInRanges(const third_party::SArray<Key>& ranges) {
+  size_t num_keys = 0;
+  ForEachKeyRange(ranges, [&num_keys](Key, size_t len, size_t) { num_keys += len; });
+  return num_keys;
+}
+
+inline third_party::SArray<Key> ExpandKeyRanges(const third_party::SArray<Key>& ranges) {
+  third_party::SArray<Key> keys(NumKeysInRanges(ranges));
+  ForEachKeyRange(ranges, [&keys](Key first, size_t len, size_t pos) {
+    for (size_t i = 0; i < len; ++i)
+      keys[pos + i] = first + i;
+  });
+  return keys;
+}
+
+/*
+ * Keys of a request are sorted (see KVTableBox and SimpleRangePartitionManager::Slice), so the dense
+ * storages check their range once per batch, on the first and the last key, instead of once per key.
+ * The order is checked too, in one pass, as an unsorted request would escape the range.
+ */
+// The keys of chunk_size values each fall in range.
+inline void CheckKeysInRange(const third_party::SArray<Key>& keys, const third_party::Range& range,
+                             uint32_t chunk_size = 1) {
+  if (keys.empty())
+    return;
+  CHECK(std::is_sorted(keys.begin(), keys.end())) << "Keys of a request must be sorted";
+  CHECK_GE(static_cast<uint64_t>(keys.front()) * chunk_size, range.begin());
+  CHECK_LE((static_cast<uint64_t>(keys.back()) + 1) * chunk_size, range.end());
+}
+
+// The runs of a keyless request fall in range.
+inline void CheckKeyRangesInRange(const third_party::SArray<Key>& ranges, const third_party::Range& range) {
+  if (ranges.empty())
+    return;
+  CHECK(std::is_sorted(ranges.begin(), ranges.end())) << "Key ranges of a request must be sorted";
+  CHECK_GE(ranges.front(), range.begin());
+  CHECK_LT(ranges.back(), range.end());
+}
+
+}  // namespace flexps
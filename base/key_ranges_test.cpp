@@ -0,0 +1,71 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "base/key_ranges.hpp"
+
+namespace flexps {
+namespace {
+
+class TestKeyRanges : public testing::Test {
+ public:
+  TestKeyRanges() {}
+  ~TestKeyRanges() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestKeyRanges, ToKeyRanges) {
+  third_party::SArray<Key> keys({3, 4, 5, 6, 9, 11, 12});
+  third_party::SArray<Key> ranges = ToKeyRanges(keys);
+  std::vector<Key> expected{3, 6, 9, 9, 11, 12};
+  ASSERT_EQ(ranges.size(), expected.size());
+  for (int i = 0; i < expected.size(); ++ i) {
+    EXPECT_EQ(ranges[i], expected[i]);
+  }
+  EXPECT_EQ(NumKeysInRanges(ranges), keys.size());
+
+  third_party::SArray<Key> ret = ExpandKeyRanges(ranges);
+  ASSERT_EQ(ret.size(), keys.size());
+  for (int i = 0; i < keys.size(); ++ i) {
+    EXPECT_EQ(ret[i], keys[i]);
+  }
+
+  EXPECT_EQ(ToKeyRanges(third_party::SArray<Key>()).size(), 0);
+}
+
+TEST_F(TestKeyRanges, ForEachKeyRange) {
+  third_party::SArray<Key> ranges({10, 19, 30, 30});
+  std::vector<Key> firsts;
+  std::vector<size_t> lens, poses;
+  ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+    firsts.push_back(first);
+    lens.push_back(len);
+    poses.push_back(pos);
+  });
+  EXPECT_EQ(firsts, std::vector<Key>({10, 30}));
+  EXPECT_EQ(lens, std::vector<size_t>({10, 1}));
+  EXPECT_EQ(poses, std::vector<size_t>({0, 10}));
+}
+
+TEST_F(TestKeyRanges, IsDense) {
+  EXPECT_TRUE(IsDense(third_party::SArray<Key>({1, 2, 3, 4}), 4));
+  EXPECT_FALSE(IsDense(third_party::SArray<Key>({1, 2, 3}), 4));
+  EXPECT_TRUE(IsDense(third_party::SArray<Key>({1, 2, 3, 4, 5, 6, 10, 11}), 4));
+  EXPECT_FALSE(IsDense(third_party::SArray<Key>({1, 2, 3, 4, 5, 6, 10, 12}), 4));
+  EXPECT_FALSE(IsDense(third_party::SArray<Key>(), 4));
+}
+
+TEST_F(TestKeyRanges, CheckInRange) {
+  // The first and the last value of the range are in it, out-of-range requests CHECK-fail.
+  third_party::Range range(10, 20);
+  CheckKeysInRange(third_party::SArray<Key>({10, 11, 19}), range);
+  CheckKeysInRange(third_party::SArray<Key>({5, 9}), range, 2);
+  CheckKeysInRange(third_party::SArray<Key>(), range);
+  CheckKeyRangesInRange(third_party::SArray<Key>({10, 12, 15, 19}), range);
+  CheckKeyRangesInRange(third_party::SArray<Key>(), range);
+}
+
+}  // namespace
+}  // namespace flexps
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "base/magic.hpp"
+#include "base/message.hpp"
+#include "base/third_party/sarray.h"
+
+#include <limits>
+
+namespace flexps {
+
+/*
+ * Helpers for the per-table key width on the wire.
+ *
+ * Inside a process keys are always SArray<Key>. When Key is 64-bit, messages of tables whose keys
+ * fit in 32 bits are marked with meta.key_width = 4, and the Mailbox narrows their key array
+ * before sending and widens it back after receiving.
+ */
+
+// The key width of a table whose keys are all less than key_end.
+inline uint8_t GetKeyWidth(uint64_t key_end) {
+  return key_end <= static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()) + 1 ? sizeof(uint32_t) : sizeof(Key);
+}
+
+// Whether data[0] of msg is a key array, or the key ranges of a dense request (see base/key_ranges.hpp).
+inline bool CarriesKeys(const Message& msg) {
+  if (msg.data.empty())
+    return false;
+  switch (msg.meta.flag) {
+  case Flag::kAdd:
+  case Flag::kAddChunk:
+  case Flag::kGet:
+  case Flag::kGetChunk:
+  case Flag::kGetReply:
+  case Flag::kGetChunkReply:
+  case Flag::kAddRange:
+  case Flag::kGetRange:
+  case Flag::kGetRangeReply:
+  case Flag::kSubscribe:
+    return true;
+  default:
+    return false;
+  }
+}
+
+inline void NarrowKeys(Message* msg) {
+  if (msg->meta.key_width >= sizeof(Key) || !CarriesKeys(*msg))
+    return;
+  third_party::SArray<Key> keys(msg->data[0]);
+  third_party::SArray<uint32_t> narrow_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    narrow_keys[i] = static_cast<uint32_t>(keys[i]);
+  msg->data[0] = third_party::SArray<char>(narrow_keys);
+}
+
+inline void WidenKeys(Message* msg) {
+  if (msg->meta.key_width >= sizeof(Key) || !CarriesKeys(*msg))
+    return;
+  third_party::SArray<uint32_t> narrow_keys(msg->data[0]);
+  third_party::SArray<Key> keys(narrow_keys.size());
+  for (size_t i = 0; i < narrow_keys.size(); ++i)
+    keys[i] = narrow_keys[i];
+  msg->data[0] = third_party::SArray<char>(keys);
+}
+
+}  // namespace flexps
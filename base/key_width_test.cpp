@@ -0,0 +1,57 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "base/key_width.hpp"
+
+namespace flexps {
+namespace {
+
+class TestKeyWidth : public testing::Test {
+ public:
+  TestKeyWidth() {}
+  ~TestKeyWidth() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestKeyWidth, GetKeyWidth) {
+  EXPECT_EQ(GetKeyWidth(100), sizeof(uint32_t));
+  EXPECT_EQ(GetKeyWidth(1ULL << 32), sizeof(uint32_t));
+  EXPECT_EQ(GetKeyWidth((1ULL << 32) + 1), sizeof(Key));
+}
+
+TEST_F(TestKeyWidth, NarrowWidenRoundTrip) {
+  Message m;
+  m.meta.flag = Flag::kAdd;
+  m.meta.key_width = sizeof(uint32_t);
+  third_party::SArray<Key> keys({3, 5, 4294967295u});
+  third_party::SArray<float> vals({0.1, 0.2, 0.3});
+  m.AddData(keys);
+  m.AddData(vals);
+
+  NarrowKeys(&m);
+  EXPECT_EQ(m.data[0].size(), keys.size() * sizeof(uint32_t));
+  EXPECT_EQ(m.data[1].size(), vals.size() * sizeof(float));
+  WidenKeys(&m);
+  third_party::SArray<Key> ret(m.data[0]);
+  ASSERT_EQ(ret.size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(ret[i], keys[i]);
+  }
+}
+
+TEST_F(TestKeyWidth, NoKeys) {
+  Message m;
+  m.meta.flag = Flag::kResetWorkerInModel;
+  m.meta.key_width = sizeof(uint32_t);
+  third_party::SArray<uint32_t> tids({1, 2});
+  m.AddData(tids);
+  NarrowKeys(&m);
+  EXPECT_EQ(m.data[0].size(), tids.size() * sizeof(uint32_t));
+  EXPECT_FALSE(CarriesKeys(m));
+}
+
+}  // namespace
+}  // namespace flexps
@@ -4,6 +4,11 @@
 
 namespace flexps {
 
+// Compile with -DUSE_64BIT_KEY=ON to use 64-bit keys, see Meta::key_width for the wire format.
+#ifdef USE_64BIT_KEY
+using Key = uint64_t;
+#else
 using Key = uint32_t;
+#endif
 
 }  // namespace flexps
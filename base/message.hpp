@@ -11,15 +11,18 @@ namespace flexps {
 
 struct Control {};
 
-enum class Flag : char { kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kAddChunk, kGet, kGetChunk, kGetReply, kGetChunkReply, kOther };
-static const char* FlagName[] = {"kExit", "kBarrier", "kResetWorkerInModel", "kClock", "kAdd", "kAddChunk", "kGet", "kGetChunk", "kGetReply", "kGetChunkReply","kOther"};
+enum class Flag : char { kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kAddChunk, kGet, kGetChunk, kGetReply, kGetChunkReply, kCheckpoint, kLoad, kRestore, kAddRange, kGetRange, kGetRangeReply, kSubscribe, kPush, kAdaptStaleness, kRetireWorkers, kOther };
+static const char* FlagName[] = {"kExit", "kBarrier", "kResetWorkerInModel", "kClock", "kAdd", "kAddChunk", "kGet", "kGetChunk", "kGetReply", "kGetChunkReply", "kCheckpoint", "kLoad", "kRestore", "kAddRange", "kGetRange", "kGetRangeReply", "kSubscribe", "kPush", "kAdaptStaleness", "kRetireWorkers", "kOther"};
 
 struct Meta {
   int sender;
   int recver;
   int model_id;
-  Flag flag;  // {kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kGet}
+  Flag flag = Flag::kOther;  // {kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kGet, ...}
   uint32_t version;
+  // The width in bytes of the keys in data[0] on the wire. It is sizeof(uint32_t) for tables whose
+  // keys fit in 32 bits so that they do not pay for 64-bit keys, see base/key_width.hpp.
+  uint8_t key_width = sizeof(Key);
 
   std::string DebugString() const {
     std::stringstream ss;
@@ -29,6 +32,7 @@ struct Meta {
     ss << ", model_id: " << model_id;
     ss << ", flag: " << FlagName[static_cast<int>(flag)];
     ss << ", version: " << version;
+    ss << ", key_width: " << static_cast<int>(key_width);
     ss << "}";
     return ss.str();
   }
@@ -57,7 +61,7 @@ struct Message {
 
 namespace {
 Message CreateMessage(Flag _flag, int _model_id, int _sender, int _recver, int _version, 
-                third_party::SArray<int> keys = {}, third_party::SArray<int> values = {}) {
+                third_party::SArray<Key> keys = {}, third_party::SArray<int> values = {}) {
   Message m;
   m.meta.flag = _flag;
   m.meta.model_id = _model_id;
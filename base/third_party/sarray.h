@@ -48,12 +48,18 @@ class SArray {
   /** \brief empty deconstrcutor */
   ~SArray() { }
 
+  /**
+   * \brief Create a zero-filled array with length n
+   * \param size the length
+   */
+  explicit SArray(size_t size) { resize(size); }
+
   /**
    * \brief Create an array with length n with initialized value
    * \param size the length
-   * \param val the initial length (0 in default)
+   * \param val the initial value
    */
-  explicit SArray(size_t size, V val = 0) { resize(size, val); }
+  explicit SArray(size_t size, V val) { resize(size, val); }
 
 
   /**
@@ -174,24 +180,25 @@ class SArray {
    * @brief Resizes the array to size elements
    *
    * If size <= capacity_, then only change the size. otherwise, append size -
-   * current_size entries, and then set new value to val
+   * current_size entries, and then set them to zero bytes. Does not require V
+   * to be constructible from 0, so that V can be a POD struct.
    */
-  void resize(size_t size, V val = 0) {
+  void resize(size_t size) {
     size_t cur_n = size_;
-    if (capacity_ >= size) {
-      size_ = size;
-    } else {
-      V* new_data = new V[size+5];
-      memcpy(new_data, data(), size_*sizeof(V));
-      reset(new_data, size, [](V* data){ delete [] data; });
-    }
+    grow(size);
+    if (size <= cur_n) return;
+    memset(data() + cur_n, 0, (size - cur_n)*sizeof(V));
+  }
+
+  /**
+   * @brief Resizes the array to size elements, the new entries are set to val
+   */
+  void resize(size_t size, V val) {
+    size_t cur_n = size_;
+    grow(size);
     if (size <= cur_n) return;
     V* p = data() + cur_n;
-    if (val == 0) {
-      memset(p, 0, (size - cur_n)*sizeof(V));
-    } else {
-      for (size_t i = 0; i < size - cur_n; ++i) { *p = val; ++p; }
-    }
+    for (size_t i = 0; i < size - cur_n; ++i) { *p = val; ++p; }
   }
 
   /**
@@ -282,6 +289,17 @@ class SArray {
   }
 
  private:
+  // Set the size, reallocating when size > capacity_, the new entries are uninitialized.
+  void grow(size_t size) {
+    if (capacity_ >= size) {
+      size_ = size;
+    } else {
+      V* new_data = new V[size+5];
+      memcpy(new_data, data(), size_*sizeof(V));
+      reset(new_data, size, [](V* data){ delete [] data; });
+    }
+  }
+
   size_t size_ = 0;
   size_t capacity_ = 0;
   std::shared_ptr<V> ptr_;
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 
+#include "base/key_width.hpp"
+
 #include "glog/logging.h"
 
 namespace flexps {
@@ -159,7 +161,11 @@ void Mailbox::Receiving() {
   }
 }
 
-int Mailbox::Send(const Message& msg) {
+int Mailbox::Send(const Message& msg_to_send) {
+  // Keys of tables with 32-bit key width are narrowed on the wire.
+  Message msg = msg_to_send;
+  NarrowKeys(&msg);
+
   std::lock_guard<std::mutex> lk(mu_);
   // find the socket
   int id;
@@ -268,6 +274,7 @@ int Mailbox::Recv(Message* msg) {
       }
     }
   }
+  WidenKeys(msg);
   return recv_bytes;
 }
 
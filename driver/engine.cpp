@@ -7,7 +7,7 @@
 
 namespace flexps {
 
-void Engine::StartEverything(int num_server_thread_per_node) {
+void Engine::StartEverything(int num_server_thread_per_node, int num_apply_threads) {
   // Create IdMapper
   id_mapper_.reset(new SimpleIdMapper(node_, nodes_));
   id_mapper_->Init(num_server_thread_per_node);
@@ -20,7 +20,7 @@ void Engine::StartEverything(int num_server_thread_per_node) {
 
   // Start KVEngine
   kv_engine_.reset(new KVEngine(node_, nodes_, id_mapper_.get(), mailbox_.get()));
-  kv_engine_->StartKVEngine();
+  kv_engine_->StartKVEngine(num_server_thread_per_node, num_apply_threads);
 
   // Barrier
   mailbox_->Barrier();
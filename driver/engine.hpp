@@ -16,7 +16,8 @@ class Engine {
  public:
   Engine(const Node& node, const std::vector<Node>& nodes) : node_(node), nodes_(nodes) {}
 
-  void StartEverything(int num_server_threads_per_node = 1);
+  // See KVEngine::StartKVEngine for num_apply_threads.
+  void StartEverything(int num_server_threads_per_node = 1, int num_apply_threads = 0);
 
   void StopEverything();
 
@@ -24,10 +25,57 @@ class Engine {
 
   template <typename Val>
   void CreateTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
-                   StorageType storage_type, int model_staleness = 0, uint32_t chunk_size = 1);
+                   StorageType storage_type, int model_staleness = 0, uint32_t chunk_size = 1,
+                   const OptimizerConfig& optimizer_config = OptimizerConfig(),
+                   const InitializerConfig& initializer_config = InitializerConfig(),
+                   const AdmissionConfig& admission_config = AdmissionConfig(), int num_backups = 0);
+
+  template <typename Val, typename Layout = AoS, typename Combine = AddCombine>
+  void CreateVectorTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
+                         int model_staleness = 0, uint32_t chunk_size = 1, Combine combine = Combine(),
+                         int num_backups = 0);
 
   void Run(const MLTask& task);
 
+  // The local directory of the files backing StorageType::Mmap tables, see KVEngine::SetStorageDir.
+  void SetStorageDir(const std::string& storage_dir) {
+    CHECK(kv_engine_);
+    kv_engine_->SetStorageDir(storage_dir);
+  }
+
+  // Checkpoint the local part of a table to dir, see KVEngine::Checkpoint.
+  void Checkpoint(uint32_t table_id, const std::string& dir, uint32_t every_clocks = 0) {
+    CHECK(kv_engine_);
+    kv_engine_->Checkpoint(table_id, dir, every_clocks);
+  }
+
+  // Let the staleness of an SSP table vary at runtime, see KVEngine::AdaptStaleness.
+  void AdaptStaleness(uint32_t table_id, int min_staleness, int max_staleness) {
+    CHECK(kv_engine_);
+    kv_engine_->AdaptStaleness(table_id, min_staleness, max_staleness);
+  }
+
+  // Let worker threads retire from a table during Run, see KVEngine::RetireWorkers.
+  void RetireWorkers(uint32_t table_id, const std::vector<uint32_t>& retiring, int clock) {
+    CHECK(kv_engine_);
+    kv_engine_->RetireWorkers(table_id, retiring, clock);
+  }
+
+  // Aggregate the clocks of a table per node, see KVEngine::AggregateClocks.
+  void AggregateClocks(uint32_t table_id) {
+    CHECK(kv_engine_);
+    kv_engine_->AggregateClocks(table_id);
+  }
+  // Bulk-load the local part of a table before Run, see KVEngine::LoadTable/RestoreTable.
+  void LoadTable(uint32_t table_id, const std::string& path) {
+    CHECK(kv_engine_);
+    kv_engine_->LoadTable(table_id, path);
+  }
+  void RestoreTable(uint32_t table_id, const std::string& dir) {
+    CHECK(kv_engine_);
+    kv_engine_->RestoreTable(table_id, dir);
+  }
+
   SimpleIdMapper* GetIdMapper() { 
     CHECK(id_mapper_);
     return id_mapper_.get();
@@ -58,9 +106,20 @@ class Engine {
 
 template <typename Val>
 void Engine::CreateTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
-                         StorageType storage_type, int model_staleness, uint32_t chunk_size) {
+                         StorageType storage_type, int model_staleness, uint32_t chunk_size,
+                         const OptimizerConfig& optimizer_config, const InitializerConfig& initializer_config,
+                         const AdmissionConfig& admission_config, int num_backups) {
+  CHECK(kv_engine_);
+  kv_engine_->CreateTable<Val>(table_id, ranges, model_type, storage_type, model_staleness, chunk_size,
+                               optimizer_config, initializer_config, admission_config, num_backups);
+}
+
+template <typename Val, typename Layout, typename Combine>
+void Engine::CreateVectorTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
+                               int model_staleness, uint32_t chunk_size, Combine combine, int num_backups) {
   CHECK(kv_engine_);
-  kv_engine_->CreateTable<Val>(table_id, ranges, model_type, storage_type, model_staleness, chunk_size);
+  kv_engine_->CreateVectorTable<Val, Layout, Combine>(table_id, ranges, model_type, model_staleness, chunk_size,
+                                                      combine, num_backups);
 }
 
 template <typename Val>
@@ -222,6 +222,78 @@ TEST_F(TestEngine, KVClientTableVectorStorage) {
   engine.StopEverything();
 }
 
+TEST_F(TestEngine, KVClientTableNodeClocks) {
+  Node node{0, "localhost", 12353};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  const int kTableId = 0;
+  engine.CreateTable<float>(kTableId, {{0, 10}},
+      ModelType::BSP, StorageType::Map);  // table 0, range [0,10)
+  engine.AggregateClocks(kTableId);
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 3}});  // 3 workers on node 0
+  task.SetTables({kTableId});  // Use table 0
+  task.SetLambda([kTableId](const Info& info){
+    auto table = info.CreateKVClientTable<float>(kTableId);
+    for (int i = 0; i < 5; ++ i) {
+      std::vector<Key> keys{1};
+      std::vector<float> ret;
+      table->Get(keys, &ret);
+      ASSERT_EQ(ret.size(), 1);
+      // The 3 Adds of each iteration are seen after the barrier
+      EXPECT_EQ(ret[0], float(3 * i));
+      std::vector<float> vals{1};
+      table->Add(keys, vals);
+      table->Clock();
+    }
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, RetireWorkers) {
+  Node node{0, "localhost", 12353};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  const int kTableId = 0;
+  engine.CreateTable<float>(kTableId, {{0, 10}},
+      ModelType::BSP, StorageType::Map);  // table 0, range [0,10)
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 3}});  // 3 workers on node 0
+  task.SetTables({kTableId});  // Use table 0
+  task.SetLambda([kTableId, &engine](const Info& info){
+    auto table = info.CreateKVClientTable<float>(kTableId);
+    for (int i = 0; i < 5; ++ i) {
+      std::vector<Key> keys{1};
+      std::vector<float> ret;
+      table->Get(keys, &ret);
+      ASSERT_EQ(ret.size(), 1);
+      // Worker 0 adds in the first 2 iterations only
+      EXPECT_EQ(ret[0], float(i <= 2 ? 3 * i : 6 + 2 * (i - 2)));
+      std::vector<float> vals{1};
+      table->Add(keys, vals);
+      table->Clock();
+      // The other workers would wait for worker 0 at the next barrier
+      if (info.local_id == 0 && i == 1) {
+        engine.RetireWorkers(kTableId, {info.thread_id}, 2);
+        return;
+      }
+    }
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
 TEST_F(TestEngine, SimpleKVTableMapStorage) {
   Node node{0, "localhost", 12353};
   Engine engine(node, {node});
@@ -44,6 +44,8 @@ struct Info {
   // The below fields are not supposed to be used by users
   ThreadsafeQueue<Message>* send_queue;
   std::map<uint32_t, AbstractPartitionManager*> partition_manager_map;
+  // <table_id, aggregator thread id> of the tables with node clocks
+  std::map<uint32_t, uint32_t> clock_aggregator_map;
   AbstractCallbackRunner* callback_runner;
   AbstractMailbox* mailbox;
 };
@@ -53,6 +55,9 @@ std::unique_ptr<KVClientTable<Val>> Info::CreateKVClientTable(uint32_t table_id)
   CHECK(partition_manager_map.find(table_id) != partition_manager_map.end());
   std::unique_ptr<KVClientTable<Val>> table(new KVClientTable<Val>(thread_id, table_id, send_queue, partition_manager_map.find(table_id)->second,
                            callback_runner));
+  auto it = clock_aggregator_map.find(table_id);
+  if (it != clock_aggregator_map.end())
+    table->SetClockAggregator(it->second);
   return table;
 }
 
@@ -60,6 +65,9 @@ template <typename Val>
 std::unique_ptr<SimpleKVTable<Val>> Info::CreateSimpleKVTable(uint32_t table_id) const {
   CHECK(partition_manager_map.find(table_id) != partition_manager_map.end());
   std::unique_ptr<SimpleKVTable<Val>> table(new SimpleKVTable<Val>(thread_id, table_id, send_queue, partition_manager_map.find(table_id)->second, mailbox));
+  auto it = clock_aggregator_map.find(table_id);
+  if (it != clock_aggregator_map.end())
+    table->SetClockAggregator(it->second);
   return table;
 }
 
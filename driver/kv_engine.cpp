@@ -7,9 +7,9 @@
 
 namespace flexps {
 
-void KVEngine::StartKVEngine(int num_server_thread_per_node) {
+void KVEngine::StartKVEngine(int num_server_thread_per_node, int num_apply_threads) {
   StartSender();
-  StartServerThreads();
+  StartServerThreads(num_apply_threads);
   StartWorkerHelperThreads();
 }
 
@@ -25,18 +25,21 @@ void KVEngine::StartWorkerHelperThreads() {
   auto worker_helper_thread_ids = id_mapper_->GetWorkerHelperThreadsForId(node_.id);
   CHECK_EQ(worker_helper_thread_ids.size(), 1);
   app_blocker_.reset(new AppBlocker());
-  worker_helper_thread_.reset(new WorkerHelperThread(worker_helper_thread_ids[0], app_blocker_.get()));
+  clock_aggregator_.reset(new NodeClockAggregator(worker_helper_thread_ids[0], sender_->GetMessageQueue()));
+  worker_helper_thread_.reset(
+      new WorkerHelperThread(worker_helper_thread_ids[0], app_blocker_.get(), clock_aggregator_.get()));
   mailbox_->RegisterQueue(worker_helper_thread_->GetHelperId(), worker_helper_thread_->GetWorkQueue());
   worker_helper_thread_->Start();
   VLOG(1) << "worker_helper_thread:" << worker_helper_thread_ids[0] << " starts on node:" << node_.id;
 }
 
-void KVEngine::StartServerThreads() {
+void KVEngine::StartServerThreads(int num_apply_threads) {
   CHECK(sender_);
   CHECK(mailbox_);
   auto server_thread_ids = id_mapper_->GetServerThreadsForId(node_.id);
   CHECK_GT(server_thread_ids.size(), 0);
-  server_thread_group_.reset(new ServerThreadGroup(server_thread_ids, sender_->GetMessageQueue()));
+  CHECK_GE(num_apply_threads, 0);
+  server_thread_group_.reset(new ServerThreadGroup(server_thread_ids, sender_->GetMessageQueue(), num_apply_threads));
   for (auto& server_thread : *server_thread_group_) {
     mailbox_->RegisterQueue(server_thread->GetServerId(), server_thread->GetWorkQueue());
     server_thread->Start();
@@ -97,7 +100,17 @@ void KVEngine::RegisterRangePartitionManager(uint32_t table_id, const std::vecto
   partition_manager_map_[table_id] = std::move(range_manager);
 }
 
-void KVEngine::InitTable(uint32_t table_id, const std::vector<uint32_t>& worker_ids) {
+void KVEngine::RegisterBackups(uint32_t table_id, ModelType model_type, int num_backups) {
+  if (model_type == ModelType::BackupBSP) {
+    CHECK_GT(num_backups, 0) << "A BackupBSP table needs num_backups > 0";
+    num_backups_[table_id] = num_backups;
+  } else {
+    CHECK_EQ(num_backups, 0) << "Only BackupBSP tables have backup workers";
+  }
+}
+
+void KVEngine::InitTable(uint32_t table_id, const std::vector<uint32_t>& worker_ids,
+                         const std::vector<uint32_t>& member_ids) {
   CHECK(id_mapper_);
   CHECK(mailbox_);
   std::vector<uint32_t> local_servers = id_mapper_->GetServerThreadsForId(node_.id);
@@ -114,6 +127,8 @@ void KVEngine::InitTable(uint32_t table_id, const std::vector<uint32_t>& worker_
   reset_msg.meta.model_id = table_id;
   reset_msg.meta.sender = id;
   reset_msg.AddData(third_party::SArray<uint32_t>(worker_ids));
+  if (!member_ids.empty())
+    reset_msg.AddData(third_party::SArray<uint32_t>(member_ids));
   for (auto local_server : local_servers) {
     reset_msg.meta.recver = local_server;
     sender_->GetMessageQueue()->Push(reset_msg);
@@ -131,14 +146,152 @@ void KVEngine::InitTable(uint32_t table_id, const std::vector<uint32_t>& worker_
   id_mapper_->DeallocateWorkerThread(node_.id, id);
 }
 
+void KVEngine::Checkpoint(uint32_t table_id, const std::string& dir, uint32_t every_clocks) {
+  CHECK(server_thread_group_);
+  CHECK(partition_manager_map_.find(table_id) != partition_manager_map_.end()) << "Unknown table: " << table_id;
+  for (auto& server_thread : *server_thread_group_) {
+    std::string prefix = CheckpointPrefix(dir, table_id, server_thread->GetServerId());
+    Message msg;
+    msg.meta.flag = Flag::kCheckpoint;
+    msg.meta.model_id = table_id;
+    msg.meta.sender = server_thread->GetServerId();
+    msg.meta.recver = server_thread->GetServerId();
+    third_party::SArray<char> prefix_arr;
+    prefix_arr.CopyFrom(prefix.data(), prefix.size());
+    msg.AddData(prefix_arr);
+    msg.AddData(third_party::SArray<uint32_t>({every_clocks}));
+    server_thread->GetWorkQueue()->Push(msg);
+  }
+}
+
+void KVEngine::AdaptStaleness(uint32_t table_id, int min_staleness, int max_staleness) {
+  CHECK(server_thread_group_);
+  CHECK(partition_manager_map_.find(table_id) != partition_manager_map_.end()) << "Unknown table: " << table_id;
+  CHECK_LE(min_staleness, max_staleness);
+  for (auto& server_thread : *server_thread_group_) {
+    Message msg;
+    msg.meta.flag = Flag::kAdaptStaleness;
+    msg.meta.model_id = table_id;
+    msg.meta.sender = server_thread->GetServerId();
+    msg.meta.recver = server_thread->GetServerId();
+    msg.AddData(third_party::SArray<int>({min_staleness, max_staleness}));
+    server_thread->GetWorkQueue()->Push(msg);
+  }
+}
+
+void KVEngine::RetireWorkers(uint32_t table_id, const std::vector<uint32_t>& retiring, int clock) {
+  CHECK(id_mapper_);
+  CHECK(mailbox_);
+  CHECK(partition_manager_map_.find(table_id) != partition_manager_map_.end()) << "Unknown table: " << table_id;
+  CHECK(node_clock_tables_.find(table_id) == node_clock_tables_.end())
+      << "Workers cannot retire from table " << table_id << " with node clocks";
+  std::vector<uint32_t> servers = id_mapper_->GetAllServerThreads();
+  int count = servers.size();
+  if (count == 0)
+    return;
+  // Register receiving queue
+  auto id = id_mapper_->AllocateWorkerThread(node_.id);
+  ThreadsafeQueue<Message> queue;
+  mailbox_->RegisterQueue(id, &queue);
+  Message msg;
+  msg.meta.flag = Flag::kRetireWorkers;
+  msg.meta.model_id = table_id;
+  msg.meta.sender = id;
+  msg.AddData(third_party::SArray<uint32_t>(retiring));
+  msg.AddData(third_party::SArray<int>({clock}));
+  for (auto server : servers) {
+    msg.meta.recver = server;
+    sender_->GetMessageQueue()->Push(msg);
+  }
+  // Wait for reply
+  Message reply;
+  while (count > 0) {
+    queue.WaitAndPop(&reply);
+    CHECK(reply.meta.flag == Flag::kRetireWorkers);
+    CHECK(reply.meta.model_id == table_id);
+    --count;
+  }
+  // Free receiving queue
+  mailbox_->DeregisterQueue(id);
+  id_mapper_->DeallocateWorkerThread(node_.id, id);
+}
+
+void KVEngine::AggregateClocks(uint32_t table_id) {
+  CHECK(partition_manager_map_.find(table_id) != partition_manager_map_.end()) << "Unknown table: " << table_id;
+  node_clock_tables_.insert(table_id);
+}
+
+void KVEngine::LoadTable(uint32_t table_id, const std::string& path) {
+  LoadLocalServers(table_id, Flag::kLoad, [&path](uint32_t) { return path; });
+}
+
+void KVEngine::RestoreTable(uint32_t table_id, const std::string& dir) {
+  LoadLocalServers(table_id, Flag::kRestore,
+                   [&dir, table_id](uint32_t server_id) { return CheckpointPrefix(dir, table_id, server_id); });
+}
+
+void KVEngine::LoadLocalServers(uint32_t table_id, Flag flag,
+                                const std::function<std::string(uint32_t)>& server_path) {
+  CHECK(id_mapper_);
+  CHECK(mailbox_);
+  CHECK(partition_manager_map_.find(table_id) != partition_manager_map_.end()) << "Unknown table: " << table_id;
+  std::vector<uint32_t> local_servers = id_mapper_->GetServerThreadsForId(node_.id);
+  int count = local_servers.size();
+  if (count == 0)
+    return;
+  // Register receiving queue
+  auto id = id_mapper_->AllocateWorkerThread(node_.id);
+  ThreadsafeQueue<Message> queue;
+  mailbox_->RegisterQueue(id, &queue);
+  // The servers load in parallel, each on its own thread
+  for (auto local_server : local_servers) {
+    std::string path = server_path(local_server);
+    Message msg;
+    msg.meta.flag = flag;
+    msg.meta.model_id = table_id;
+    msg.meta.sender = id;
+    msg.meta.recver = local_server;
+    third_party::SArray<char> path_arr;
+    path_arr.CopyFrom(path.data(), path.size());
+    msg.AddData(path_arr);
+    sender_->GetMessageQueue()->Push(msg);
+  }
+  // Wait for reply
+  Message reply;
+  while (count > 0) {
+    queue.WaitAndPop(&reply);
+    CHECK(reply.meta.flag == flag);
+    CHECK(reply.meta.model_id == table_id);
+    --count;
+  }
+  // Free receiving queue
+  mailbox_->DeregisterQueue(id);
+  id_mapper_->DeallocateWorkerThread(node_.id, id);
+}
+
+std::string KVEngine::CheckpointPrefix(const std::string& dir, uint32_t table_id, uint32_t server_id) {
+  return dir + "/table_" + std::to_string(table_id) + "_server_" + std::to_string(server_id);
+}
+
 void KVEngine::Run(const MLTask& task) {
   CHECK(task.IsSetup());
   WorkerSpec worker_spec = AllocateWorkers(task.GetWorkerAlloc());
 
-  // Init tables
+  // Init tables, with node clocks the servers track the worker helper threads of the nodes
   const std::vector<uint32_t>& tables = task.GetTables();
+  std::vector<uint32_t> helper_ids;
+  for (auto& kv : worker_spec.GetNodeToWorkers()) {
+    if (kv.second.empty())
+      continue;
+    auto node_helper_ids = id_mapper_->GetWorkerHelperThreadsForId(kv.first);
+    CHECK_EQ(node_helper_ids.size(), 1);
+    helper_ids.push_back(node_helper_ids[0]);
+  }
   for (auto table : tables) {
-    InitTable(table, worker_spec.GetAllThreadIds());
+    if (node_clock_tables_.find(table) != node_clock_tables_.end())
+      InitTable(table, helper_ids, worker_spec.GetAllThreadIds());
+    else
+      InitTable(table, worker_spec.GetAllThreadIds());
   }
   mailbox_->Barrier();
 
@@ -150,10 +303,15 @@ void KVEngine::Run(const MLTask& task) {
     std::vector<std::thread> thread_group(local_threads.size());
     LOG(INFO) << thread_group.size() << " workers run on proc: " << node_.id;
     std::map<uint32_t, AbstractPartitionManager*> partition_manager_map;
+    std::map<uint32_t, uint32_t> clock_aggregator_map;
     for (auto& table : tables) {
       auto it = partition_manager_map_.find(table);
       CHECK(it != partition_manager_map_.end());
       partition_manager_map[table] = it->second.get();
+      if (node_clock_tables_.find(table) != node_clock_tables_.end()) {
+        clock_aggregator_map[table] = worker_helper_thread_->GetHelperId();
+        clock_aggregator_->RegisterTable(table, local_threads, it->second->GetServerThreadIds());
+      }
     }
     for (int i = 0; i < thread_group.size(); ++i) {
       // TODO: Now I register the thread_id with the queue in worker_helper_thread to the mailbox.
@@ -166,6 +324,7 @@ void KVEngine::Run(const MLTask& task) {
       info.worker_id = local_workers[i];
       info.send_queue = sender_->GetMessageQueue();
       info.partition_manager_map = partition_manager_map;
+      info.clock_aggregator_map = clock_aggregator_map;
       info.callback_runner = app_blocker_.get();
       info.mailbox = mailbox_;
       thread_group[i] = std::thread([&task, info]() { task.RunLambda(info); });
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include "base/node.hpp"
@@ -12,29 +16,41 @@
 #include "driver/ml_task.hpp"
 #include "driver/simple_id_mapper.hpp"
 #include "driver/worker_spec.hpp"
+#include "server/admission_storage.hpp"
 #include "server/asp_model.hpp"
 #include "server/bsp_model.hpp"
+#include "server/hash_storage.hpp"
+#include "server/initializer.hpp"
 #include "server/map_storage.hpp"
+#include "server/mmap_storage.hpp"
+#include "server/model.hpp"
+#include "server/optimizer_storage.hpp"
+#include "server/quantized_storage.hpp"
 #include "server/server_thread.hpp"
 #include "server/server_thread_group.hpp"
+#include "server/sorted_storage.hpp"
 #include "server/ssp_model.hpp"
 #include "server/vector_storage.hpp"
 #include "worker/abstract_partition_manager.hpp"
 #include "worker/app_blocker.hpp"
+#include "worker/node_clock_aggregator.hpp"
 #include "worker/simple_range_manager.hpp"
 #include "worker/worker_helper_thread.hpp"
 
 // for sparsessp
 #include "server/sparsessp/abstract_sparse_ssp_recorder.hpp"
+#include "server/sparsessp/bitset_sparse_ssp_recorder.hpp"
+#include "server/sparsessp/flat_hash_sparse_ssp_recorder.hpp"
 #include "server/sparsessp/sparse_ssp_model.hpp"
 #include "server/sparsessp/unordered_map_sparse_ssp_recorder.hpp"
 #include "server/sparsessp/vector_sparse_ssp_recorder.hpp"
 
 namespace flexps {
 
-enum class ModelType { SSP, BSP, ASP, SparseSSP };
-enum class StorageType { Map, Vector };
-enum class SparseSSPRecorderType { None, Map, Vector };
+enum class ModelType { SSP, BSP, ASP, SparseSSP, BackupBSP };
+// Fp16, BF16 and Int8 are dense like Vector but store the values quantized, see QuantizedStorage.
+enum class StorageType { Map, Vector, Hash, Sorted, Mmap, Fp16, BF16, Int8 };
+enum class SparseSSPRecorderType { None, Map, Vector, Bitset, FlatHash };
 
 /*
  * KVEngine handles the kvstore module
@@ -45,8 +61,9 @@ class KVEngine {
           SimpleIdMapper* const id_mapper, Mailbox* const mailbox) 
       : node_(node), nodes_(nodes), id_mapper_(id_mapper), mailbox_(mailbox) {}
 
-  void StartKVEngine(int num_server_threads_per_node = 1);
-  void StartServerThreads();
+  // num_apply_threads more threads per server thread apply the large requests to Vector tables.
+  void StartKVEngine(int num_server_threads_per_node = 1, int num_apply_threads = 0);
+  void StartServerThreads(int num_apply_threads = 0);
   void StartWorkerHelperThreads();
   void StartSender();
 
@@ -55,9 +72,20 @@ class KVEngine {
   void StopWorkerHelperThreads();
   void StopSender();
 
+  // num_backups is the number of backup workers of a BackupBSP table, the barrier of an iteration
+  // passes once all but num_backups workers have clocked.
   template <typename Val>
   void CreateTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
-                   StorageType storage_type, int model_staleness = 0, uint32_t chunk_size = 1);
+                   StorageType storage_type, int model_staleness = 0, uint32_t chunk_size = 1,
+                   const OptimizerConfig& optimizer_config = OptimizerConfig(),
+                   const InitializerConfig& initializer_config = InitializerConfig(),
+                   const AdmissionConfig& admission_config = AdmissionConfig(), int num_backups = 0);
+
+  // Create a Vector table whose Val may be a POD struct, with the given layout and combine, see VectorStorage.
+  template <typename Val, typename Layout = AoS, typename Combine = AddCombine>
+  void CreateVectorTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
+                         int model_staleness = 0, uint32_t chunk_size = 1, Combine combine = Combine(),
+                         int num_backups = 0);
 
   // Create SparseSSP Table, for testing sparsessp use only.
   template <typename Val>
@@ -66,10 +94,111 @@ class KVEngine {
                    SparseSSPRecorderType sparse_ssp_recorder_type = SparseSSPRecorderType::None);
 
   void Run(const MLTask& task);
+
+  /*
+   * The local directory of the files backing StorageType::Mmap tables, which need one. It should be
+   * on disk: on tmpfs (often /tmp) the pages cannot be written back and the table is held in RAM.
+   */
+  void SetStorageDir(const std::string& storage_dir) { storage_dir_ = storage_dir; }
+
+  /*
+   * Checkpoint the local part of a table to dir, at once (every_clocks == 0) or whenever the min
+   * clock reaches a multiple of every_clocks. Each server thread writes the values changed since
+   * its previous checkpoint to <dir>/table_<table_id>_server_<server_id>.<n> in the background
+   * while it keeps serving requests. Only Vector and Mmap tables support checkpoints.
+   */
+  void Checkpoint(uint32_t table_id, const std::string& dir, uint32_t every_clocks = 0);
+
+  /*
+   * Let the local servers of an SSP table adjust its staleness within [min_staleness, max_staleness]
+   * at runtime, by how long the workers are blocked and how evenly they clock (see
+   * StalenessController). The changes are logged. Every node calls it, usually after CreateTable.
+   */
+  void AdaptStaleness(uint32_t table_id, int min_staleness, int max_staleness);
+
+  /*
+   * Let worker threads of the running task retire from an SSP/BSP/ASP table without node clocks. The
+   * retiring workers leave once they have clocked up to clock, so a lost worker is retired with a clock
+   * it has reached, e.g. 0. The others are released if it was the slowest. A retiring worker must not
+   * send requests to the table after reaching clock.
+   *
+   * It is called on one node during Run, from any thread of that node, e.g. by a worker of the task
+   * retiring itself or by a thread watching the workers. It updates the servers of every node and
+   * returns when they are done. Workers cannot join a running task, the worker set of a task is fixed
+   * by Run.
+   */
+  void RetireWorkers(uint32_t table_id, const std::vector<uint32_t>& retiring, int clock);
+
+  /*
+   * Aggregate the clocks of an SSP/BSP/BackupBSP/ASP table per node in the following Runs: the
+   * servers track one clock per node with workers, which the worker helper thread of the node sends
+   * when its slowest worker clocks (see NodeClockAggregator). Every node calls it, before Run.
+   * Workers cannot join or retire such a table.
+   */
+  void AggregateClocks(uint32_t table_id);
+
+  /*
+   * Bulk-load a table before Run. Every node calls it, and every local server thread copies its own
+   * range out of the mmapped file in parallel, so no values go through the mailbox. It returns
+   * when the local servers are done.
+   *
+   * LoadTable reads a file of the raw values of keys [0, n), one Val after another, visible to
+   * all nodes, e.g. on a shared file system.
+   * RestoreTable reads the checkpoints written by Checkpoint(table_id, dir) in order.
+   * Only Vector and Mmap tables support them.
+   */
+  void LoadTable(uint32_t table_id, const std::string& path);
+  void RestoreTable(uint32_t table_id, const std::string& dir);
  private:
   WorkerSpec AllocateWorkers(const std::vector<WorkerAlloc>& worker_alloc);
   void RegisterRangePartitionManager(uint32_t table_id, const std::vector<third_party::Range>& ranges, uint32_t chunk_size = 1);
-  void InitTable(uint32_t table_id, const std::vector<uint32_t>& worker_ids);
+  // A BackupBSP table needs num_backups > 0, the other tables no backups. The consistency checks at
+  // ResetWorker that there are fewer backups than workers.
+  void RegisterBackups(uint32_t table_id, ModelType model_type, int num_backups);
+  // With node clocks, worker_ids are the ids of the nodes and member_ids the ids of the workers.
+  void InitTable(uint32_t table_id, const std::vector<uint32_t>& worker_ids,
+                 const std::vector<uint32_t>& member_ids = {});
+  // Send a kLoad/kRestore message with the path of each local server and wait for the replies.
+  void LoadLocalServers(uint32_t table_id, Flag flag, const std::function<std::string(uint32_t)>& server_path);
+  static std::string CheckpointPrefix(const std::string& dir, uint32_t table_id, uint32_t server_id);
+  template <typename Storage>
+  std::unique_ptr<AbstractModel> CreateModel(uint32_t table_id, ModelType model_type, int model_staleness,
+                                             std::unique_ptr<Storage>&& storage);
+  // CreateModel, with the sparse storage behind an AdmissionStorage if admission_config is enabled.
+  template <typename Storage>
+  std::unique_ptr<AbstractModel> CreateSparseModel(uint32_t table_id, ModelType model_type, int model_staleness,
+                                                   std::unique_ptr<Storage>&& storage, uint32_t chunk_size,
+                                                   const AdmissionConfig& admission_config);
+  template <typename Val>
+  std::unique_ptr<AbstractModel> CreateOptimizerModel(uint32_t table_id, ModelType model_type,
+                                                      StorageType storage_type, int model_staleness,
+                                                      const third_party::Range& range, uint32_t chunk_size,
+                                                      const OptimizerConfig& optimizer_config, std::true_type);
+  // Optimizers need a floating point Val, this overload keeps CreateTable compiling for the other types.
+  template <typename Val>
+  std::unique_ptr<AbstractModel> CreateOptimizerModel(uint32_t, ModelType, StorageType, int,
+                                                      const third_party::Range&, uint32_t, const OptimizerConfig&,
+                                                      std::false_type) {
+    CHECK(false) << "Server-side optimizers need a floating point Val";
+    return nullptr;
+  }
+  template <typename Val, typename Optimizer>
+  std::unique_ptr<AbstractModel> CreateOptimizerModel(uint32_t table_id, ModelType model_type,
+                                                      StorageType storage_type, int model_staleness,
+                                                      const third_party::Range& range, uint32_t chunk_size,
+                                                      const OptimizerConfig& optimizer_config);
+  template <typename Val>
+  std::unique_ptr<AbstractModel> CreateQuantizedModel(uint32_t table_id, ModelType model_type,
+                                                      StorageType storage_type, int model_staleness,
+                                                      const third_party::Range& range, uint32_t chunk_size,
+                                                      std::true_type);
+  // Quantization needs a floating point Val, this overload keeps CreateTable compiling for the other types.
+  template <typename Val>
+  std::unique_ptr<AbstractModel> CreateQuantizedModel(uint32_t, ModelType, StorageType, int,
+                                                      const third_party::Range&, uint32_t, std::false_type) {
+    CHECK(false) << "Quantized storages need a floating point Val";
+    return nullptr;
+  }
 
  private:
   std::map<uint32_t, std::unique_ptr<AbstractPartitionManager>> partition_manager_map_;
@@ -85,46 +214,196 @@ class KVEngine {
   // worker elements
   std::unique_ptr<AppBlocker> app_blocker_;
   std::unique_ptr<WorkerHelperThread> worker_helper_thread_;
+  std::unique_ptr<NodeClockAggregator> clock_aggregator_;
+  // The tables with node clocks
+  std::set<uint32_t> node_clock_tables_;
+  // <table_id, number of backup workers> of the BackupBSP tables
+  std::map<uint32_t, int> num_backups_;
   // server elements
   std::unique_ptr<ServerThreadGroup> server_thread_group_;
+
+  std::string storage_dir_;
 };
 
 template <typename Val>
 void KVEngine::CreateTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
-                         StorageType storage_type, int model_staleness, uint32_t chunk_size) {
+                         StorageType storage_type, int model_staleness, uint32_t chunk_size,
+                         const OptimizerConfig& optimizer_config, const InitializerConfig& initializer_config,
+                         const AdmissionConfig& admission_config, int num_backups) {
+  RegisterBackups(table_id, model_type, num_backups);
   RegisterRangePartitionManager(table_id, ranges, chunk_size);
   CHECK(server_thread_group_);
 
   CHECK(id_mapper_);
   auto server_thread_ids = id_mapper_->GetAllServerThreads();
   CHECK_EQ(ranges.size(), server_thread_ids.size());
+  // The initial value of absent keys of the sparse storages, the dense ones start at zero.
+  CHECK(initializer_config.type == InitType::Zero || storage_type == StorageType::Map ||
+        storage_type == StorageType::Hash || storage_type == StorageType::Sorted)
+      << "Initializers are supported by Map, Hash and Sorted tables only";
+  CHECK(!admission_config.Enabled() || (optimizer_config.type == OptimizerType::None &&
+                                        (storage_type == StorageType::Map || storage_type == StorageType::Hash ||
+                                         storage_type == StorageType::Sorted)))
+      << "Admission and eviction are supported by Map, Hash and Sorted tables without optimizer only";
+  Initializer<Val> init(initializer_config);
 
   for (auto& server_thread : *server_thread_group_) {
-    std::unique_ptr<AbstractStorage> storage;
+    auto it = std::find(server_thread_ids.begin(), server_thread_ids.end(), server_thread->GetServerId());
+    const third_party::Range& range = ranges[it - server_thread_ids.begin()];
     std::unique_ptr<AbstractModel> model;
-    // Set up storage
-    if (storage_type == StorageType::Map) {
-      storage.reset(new MapStorage<Val>(chunk_size));
+    // Set up storage, the storage type is turned into a type here and the model is specialized on it
+    if (optimizer_config.type != OptimizerType::None) {
+      model = CreateOptimizerModel<Val>(table_id, model_type, storage_type, model_staleness, range, chunk_size,
+                                        optimizer_config, std::is_floating_point<Val>());
+    } else if (storage_type == StorageType::Map) {
+      model = CreateSparseModel(table_id, model_type, model_staleness,
+                                std::unique_ptr<MapStorage<Val>>(new MapStorage<Val>(chunk_size, init)), chunk_size,
+                                admission_config);
+    } else if (storage_type == StorageType::Hash) {
+      model = CreateSparseModel(table_id, model_type, model_staleness,
+                                std::unique_ptr<HashStorage<Val>>(
+                                    new HashStorage<Val>(chunk_size, HashStorage<Val>::kDefaultCapacity, init)),
+                                chunk_size, admission_config);
+    } else if (storage_type == StorageType::Sorted) {
+      model = CreateSparseModel(table_id, model_type, model_staleness,
+                                std::unique_ptr<SortedStorage<Val>>(new SortedStorage<Val>(chunk_size, init)),
+                                chunk_size, admission_config);
     } else if (storage_type == StorageType::Vector) {
-      auto it = std::find(server_thread_ids.begin(), server_thread_ids.end(), server_thread->GetServerId());
-      storage.reset(new VectorStorage<Val>(ranges[it - server_thread_ids.begin()], chunk_size));
+      std::unique_ptr<VectorStorage<Val>> storage(new VectorStorage<Val>(range, chunk_size));
+      storage->SetApplyPool(server_thread->GetApplyPool());
+      model = CreateModel(table_id, model_type, model_staleness, std::move(storage));
+    } else if (storage_type == StorageType::Mmap) {
+      CHECK(!storage_dir_.empty()) << "Mmap tables need a storage dir, see SetStorageDir";
+      std::string path = storage_dir_ + "/flexps_table_" + std::to_string(table_id) + "_server_" +
+                         std::to_string(server_thread->GetServerId());
+      model = CreateModel(table_id, model_type, model_staleness,
+                          std::unique_ptr<MmapStorage<Val>>(new MmapStorage<Val>(range, path, chunk_size)));
+    } else if (storage_type == StorageType::Fp16 || storage_type == StorageType::BF16 ||
+               storage_type == StorageType::Int8) {
+      model = CreateQuantizedModel<Val>(table_id, model_type, storage_type, model_staleness, range, chunk_size,
+                                        std::is_floating_point<Val>());
     } else {
       CHECK(false) << "Unknown storage_type";
     }
-    // Set up model
-    if (model_type == ModelType::SSP) {
-      model.reset(new SSPModel(table_id, std::move(storage), model_staleness, server_thread_group_->GetReplyQueue()));
-    } else if (model_type == ModelType::BSP) {
-      model.reset(new BSPModel(table_id, std::move(storage), server_thread_group_->GetReplyQueue()));
-    } else if (model_type == ModelType::ASP) {
-      model.reset(new ASPModel(table_id, std::move(storage), server_thread_group_->GetReplyQueue()));
-    } else {
-      CHECK(false) << "Unknown model_type";
-    }
     server_thread->RegisterModel(table_id, std::move(model));
   }
 }
 
+template <typename Val, typename Layout, typename Combine>
+void KVEngine::CreateVectorTable(uint32_t table_id, const std::vector<third_party::Range>& ranges,
+                                 ModelType model_type, int model_staleness, uint32_t chunk_size, Combine combine,
+                                 int num_backups) {
+  RegisterBackups(table_id, model_type, num_backups);
+  RegisterRangePartitionManager(table_id, ranges, chunk_size);
+  CHECK(server_thread_group_);
+
+  CHECK(id_mapper_);
+  auto server_thread_ids = id_mapper_->GetAllServerThreads();
+  CHECK_EQ(ranges.size(), server_thread_ids.size());
+
+  using Storage = VectorStorage<Val, Layout, Combine>;
+  for (auto& server_thread : *server_thread_group_) {
+    auto it = std::find(server_thread_ids.begin(), server_thread_ids.end(), server_thread->GetServerId());
+    const third_party::Range& range = ranges[it - server_thread_ids.begin()];
+    std::unique_ptr<Storage> storage(new Storage(range, chunk_size, combine));
+    storage->SetApplyPool(server_thread->GetApplyPool());
+    auto model = CreateModel(table_id, model_type, model_staleness, std::move(storage));
+    server_thread->RegisterModel(table_id, std::move(model));
+  }
+}
+
+template <typename Storage>
+std::unique_ptr<AbstractModel> KVEngine::CreateModel(uint32_t table_id, ModelType model_type, int model_staleness,
+                                                     std::unique_ptr<Storage>&& storage) {
+  std::unique_ptr<AbstractModel> model;
+  auto* reply_queue = server_thread_group_->GetReplyQueue();
+  if (model_type == ModelType::SSP) {
+    model.reset(new Model<Storage, SSPConsistency>(table_id, std::move(storage), model_staleness, reply_queue));
+  } else if (model_type == ModelType::BSP) {
+    model.reset(new Model<Storage, BSPConsistency>(table_id, std::move(storage), model_staleness, reply_queue));
+  } else if (model_type == ModelType::ASP) {
+    model.reset(new Model<Storage, ASPConsistency>(table_id, std::move(storage), model_staleness, reply_queue));
+  } else if (model_type == ModelType::BackupBSP) {
+    model.reset(new Model<Storage, BackupBSPConsistency>(
+        table_id, std::move(storage), BackupBSPConsistency(model_staleness, num_backups_.at(table_id)), reply_queue));
+  } else {
+    CHECK(false) << "Unknown model_type";
+  }
+  return model;
+}
+
+template <typename Storage>
+std::unique_ptr<AbstractModel> KVEngine::CreateSparseModel(uint32_t table_id, ModelType model_type,
+                                                           int model_staleness, std::unique_ptr<Storage>&& storage,
+                                                           uint32_t chunk_size,
+                                                           const AdmissionConfig& admission_config) {
+  if (!admission_config.Enabled())
+    return CreateModel(table_id, model_type, model_staleness, std::move(storage));
+  return CreateModel(table_id, model_type, model_staleness,
+                     std::unique_ptr<AdmissionStorage<Storage>>(
+                         new AdmissionStorage<Storage>(table_id, std::move(storage), admission_config, chunk_size)));
+}
+
+template <typename Val>
+std::unique_ptr<AbstractModel> KVEngine::CreateOptimizerModel(uint32_t table_id, ModelType model_type,
+                                                              StorageType storage_type, int model_staleness,
+                                                              const third_party::Range& range, uint32_t chunk_size,
+                                                              const OptimizerConfig& optimizer_config,
+                                                              std::true_type) {
+  if (optimizer_config.type == OptimizerType::SGD) {
+    return CreateOptimizerModel<Val, SGD<Val>>(table_id, model_type, storage_type, model_staleness, range,
+                                               chunk_size, optimizer_config);
+  } else if (optimizer_config.type == OptimizerType::AdaGrad) {
+    return CreateOptimizerModel<Val, AdaGrad<Val>>(table_id, model_type, storage_type, model_staleness, range,
+                                                   chunk_size, optimizer_config);
+  } else if (optimizer_config.type == OptimizerType::Adam) {
+    return CreateOptimizerModel<Val, Adam<Val>>(table_id, model_type, storage_type, model_staleness, range,
+                                                chunk_size, optimizer_config);
+  } else if (optimizer_config.type == OptimizerType::FTRL) {
+    return CreateOptimizerModel<Val, FTRL<Val>>(table_id, model_type, storage_type, model_staleness, range,
+                                                chunk_size, optimizer_config);
+  }
+  CHECK(false) << "Unknown optimizer type";
+  return nullptr;
+}
+
+template <typename Val, typename Optimizer>
+std::unique_ptr<AbstractModel> KVEngine::CreateOptimizerModel(uint32_t table_id, ModelType model_type,
+                                                              StorageType storage_type, int model_staleness,
+                                                              const third_party::Range& range, uint32_t chunk_size,
+                                                              const OptimizerConfig& optimizer_config) {
+  if (storage_type == StorageType::Map) {
+    using Storage = MapOptimizerStorage<Val, Optimizer>;
+    return CreateModel(table_id, model_type, model_staleness,
+                       std::unique_ptr<Storage>(new Storage(optimizer_config, chunk_size)));
+  } else if (storage_type == StorageType::Vector) {
+    using Storage = VectorOptimizerStorage<Val, Optimizer>;
+    return CreateModel(table_id, model_type, model_staleness,
+                       std::unique_ptr<Storage>(new Storage(range, optimizer_config, chunk_size)));
+  }
+  CHECK(false) << "Server-side optimizers support Map and Vector storage only";
+  return nullptr;
+}
+
+template <typename Val>
+std::unique_ptr<AbstractModel> KVEngine::CreateQuantizedModel(uint32_t table_id, ModelType model_type,
+                                                              StorageType storage_type, int model_staleness,
+                                                              const third_party::Range& range, uint32_t chunk_size,
+                                                              std::true_type) {
+  if (storage_type == StorageType::Fp16) {
+    using Storage = QuantizedStorage<Val, Fp16>;
+    return CreateModel(table_id, model_type, model_staleness, std::unique_ptr<Storage>(new Storage(range, chunk_size)));
+  } else if (storage_type == StorageType::BF16) {
+    using Storage = QuantizedStorage<Val, BF16>;
+    return CreateModel(table_id, model_type, model_staleness, std::unique_ptr<Storage>(new Storage(range, chunk_size)));
+  } else if (storage_type == StorageType::Int8) {
+    using Storage = QuantizedStorage<Val, Int8>;
+    return CreateModel(table_id, model_type, model_staleness, std::unique_ptr<Storage>(new Storage(range, chunk_size)));
+  }
+  CHECK(false) << "Unknown quantized storage_type";
+  return nullptr;
+}
+
 template <typename Val>
 void KVEngine::CreateSparseSSPTable(uint32_t table_id, const std::vector<third_party::Range>& ranges, ModelType model_type,
                          StorageType storage_type, int model_staleness, int speculation,
@@ -142,6 +421,10 @@ void KVEngine::CreateSparseSSPTable(uint32_t table_id, const std::vector<third_p
     // Set up storage
     if (storage_type == StorageType::Map) {
       storage.reset(new MapStorage<Val>());
+    } else if (storage_type == StorageType::Hash) {
+      storage.reset(new HashStorage<Val>());
+    } else if (storage_type == StorageType::Sorted) {
+      storage.reset(new SortedStorage<Val>());
     } else if (storage_type == StorageType::Vector) {
       auto it = std::find(server_thread_ids.begin(), server_thread_ids.end(), server_thread->GetServerId());
       storage.reset(new VectorStorage<Val>(ranges[it - server_thread_ids.begin()]));
@@ -158,6 +441,12 @@ void KVEngine::CreateSparseSSPTable(uint32_t table_id, const std::vector<third_p
       auto it = std::find(server_thread_ids.begin(), server_thread_ids.end(), server_thread->GetServerId());
       recorder.reset(
           new VectorSparseSSPRecorder(model_staleness, speculation, ranges[it - server_thread_ids.begin()]));
+    } else if (sparse_ssp_recorder_type == SparseSSPRecorderType::Bitset) {
+      auto it = std::find(server_thread_ids.begin(), server_thread_ids.end(), server_thread->GetServerId());
+      recorder.reset(
+          new BitsetSparseSSPRecorder(model_staleness, speculation, ranges[it - server_thread_ids.begin()]));
+    } else if (sparse_ssp_recorder_type == SparseSSPRecorderType::FlatHash) {
+      recorder.reset(new FlatHashSparseSSPRecorder(model_staleness, speculation));
     } else {
       CHECK(false) << "Unknown recorder type";
     }
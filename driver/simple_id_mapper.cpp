@@ -28,6 +28,7 @@ void SimpleIdMapper::Init(int num_server_threads_per_node) {
 
 uint32_t SimpleIdMapper::AllocateWorkerThread(uint32_t node_id) {
   CHECK(node2worker_helper_.find(node_id) != node2worker_helper_.end());
+  std::lock_guard<std::mutex> lk(worker_mu_);
   CHECK_LE(node2worker_[node_id].size(), kMaxThreadsPerNode - kMaxBgThreadsPerNode);
   for (int i = kMaxBgThreadsPerNode; i < kMaxThreadsPerNode; ++ i) {
     int tid = i + node_id * kMaxThreadsPerNode;
@@ -42,6 +43,7 @@ uint32_t SimpleIdMapper::AllocateWorkerThread(uint32_t node_id) {
 
 void SimpleIdMapper::DeallocateWorkerThread(uint32_t node_id, uint32_t tid) {
   CHECK(node2worker_helper_.find(node_id) != node2worker_helper_.end());
+  std::lock_guard<std::mutex> lk(worker_mu_);
   CHECK(node2worker_[node_id].find(tid) != node2worker_[node_id].end());
   node2worker_[node_id].erase(tid);
 }
@@ -59,6 +61,7 @@ std::vector<uint32_t> SimpleIdMapper::GetWorkerHelperThreadsForId(uint32_t node_
 }
 
 std::vector<uint32_t> SimpleIdMapper::GetWorkerThreadsForId(uint32_t node_id) {
+  std::lock_guard<std::mutex> lk(worker_mu_);
   return {node2worker_[node_id].begin(), node2worker_[node_id].end()};
 }
 
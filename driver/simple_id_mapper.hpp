@@ -5,6 +5,7 @@
 #include <cinttypes>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <unordered_map>
 #include <set>
 
@@ -23,6 +24,7 @@ class SimpleIdMapper : public AbstractIdMapper {
   virtual uint32_t GetNodeIdForThread(uint32_t tid) override;
 
   void Init(int num_server_threads_per_node = 1);
+  // The worker threads may be allocated from any thread, e.g. by KVEngine::RetireWorkers during Run.
   uint32_t AllocateWorkerThread(uint32_t node_id);
   void DeallocateWorkerThread(uint32_t node_id, uint32_t tid);
 
@@ -52,6 +54,8 @@ class SimpleIdMapper : public AbstractIdMapper {
   std::map<uint32_t, std::vector<uint32_t>> node2worker_helper_;
   std::map<uint32_t, uint32_t> node2model_init_;
   std::map<uint32_t, std::set<uint32_t>> node2worker_;
+  // Protects node2worker_
+  std::mutex worker_mu_;
 
   // A flag to check whether channel threads have been allocated.
   // For simplicity, now the channel threads can only be allocated ONCE!
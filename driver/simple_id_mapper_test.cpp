@@ -4,6 +4,9 @@
 
 #include "driver/simple_id_mapper.hpp"
 
+#include <set>
+#include <thread>
+
 namespace flexps {
 namespace {
 
@@ -62,6 +65,28 @@ TEST_F(TestSimpleIdMapper, AllocateDeallocateThread) {
   EXPECT_EQ(id_mapper.GetNodeIdForThread(SimpleIdMapper::kMaxThreadsPerNode + SimpleIdMapper::kMaxBgThreadsPerNode), 1);
 }
 
+TEST_F(TestSimpleIdMapper, AllocateFromThreads) {
+  Node n1{0, "worker1", 12352};
+  SimpleIdMapper id_mapper(n1, {n1});
+  id_mapper.Init(1);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++ i) {
+    threads.push_back(std::thread([&id_mapper]() {
+      for (int j = 0; j < 100; ++ j) {
+        uint32_t tid = id_mapper.AllocateWorkerThread(0);
+        if (j % 2 == 0)
+          id_mapper.DeallocateWorkerThread(0, tid);
+      }
+    }));
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  auto tids = id_mapper.GetWorkerThreadsForId(0);
+  EXPECT_EQ(tids.size(), 200);
+  EXPECT_EQ(std::set<uint32_t>(tids.begin(), tids.end()).size(), 200);
+}
+
 TEST_F(TestSimpleIdMapper, GetChannelThreads) {
   Node n1{0, "worker1", 12352};
   Node n2{1, "worker1", 12353};
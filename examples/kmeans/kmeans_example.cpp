@@ -87,7 +87,7 @@ void Run() {
   config.hdfs_namenode = FLAGS_hdfs_namenode;
   config.hdfs_namenode_port = FLAGS_hdfs_namenode_port;
   config.num_local_load_thread = FLAGS_num_workers_per_node;
-  using DataObj = std::pair<std::vector<std::pair<int, float>>, float>;  // input data format depende
+  using DataObj = std::pair<std::vector<std::pair<Key, float>>, float>;  // input data format depende
   zmq::context_t* zmq_context = new zmq::context_t(1);
   int num_threads_per_node = 2;
   HDFSManager hdfs_manager(my_node, nodes, config, zmq_context);
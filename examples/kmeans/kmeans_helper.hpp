@@ -1,6 +1,8 @@
 #include <utility>
 #include <vector>
 
+#include "base/magic.hpp"
+
 namespace flexps {
 
 template <typename T>
@@ -42,7 +44,7 @@ void random_init(int K, int num_features, const std::vector<T>& data, std::vecto
 }
 
 // return ID of cluster whose center is the nearest (uses euclidean distance), and the distance
-std::pair<int, float> get_nearest_center(const std::pair<std::vector<std::pair<int, float>>, float>& point, int K,
+std::pair<int, float> get_nearest_center(const std::pair<std::vector<std::pair<Key, float>>, float>& point, int K,
                                          const std::vector<std::vector<float>>& params, int num_features) {
   float square_dist, min_square_dist = std::numeric_limits<float>::max();
   int id_cluster_center = -1;
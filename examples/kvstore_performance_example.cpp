@@ -9,6 +9,8 @@
 
 DEFINE_int32(my_id, -1, "The process id of this program");
 DEFINE_string(config_file, "", "The config file path");
+DEFINE_int32(num_apply_threads, 0, "Threads per server thread applying large Adds and Gets");
+DEFINE_int32(max_staleness, -1, "Adapt the staleness within [0, max_staleness] at runtime, -1 keeps it fixed");
 
 namespace flexps {
 
@@ -27,7 +29,7 @@ void Run() {
 
   // 1. Start engine
   Engine engine(my_node, nodes);
-  engine.StartEverything();
+  engine.StartEverything(1, FLAGS_num_apply_threads);
 
   // 2. Create tables
   const int kTableId = 0;
@@ -39,6 +41,8 @@ void Run() {
 
   engine.CreateTable<float>(kTableId, range, 
       ModelType::SSP, StorageType::Vector, kStaleness);
+  if (FLAGS_max_staleness >= 0)
+    engine.AdaptStaleness(kTableId, 0, FLAGS_max_staleness);
   engine.Barrier();
 
   // 3. Construct tasks
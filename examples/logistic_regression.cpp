@@ -22,8 +22,9 @@ DEFINE_string(hdfs_namenode, "", "The hdfs namenode hostname");
 DEFINE_string(input, "", "The hdfs input url");
 DEFINE_int32(hdfs_namenode_port, -1, "The hdfs namenode port");
 
-DEFINE_string(kModelType, "", "ASP/SSP/BSP/SparseSSP");
-DEFINE_string(kStorageType, "", "Map/Vector");
+DEFINE_string(kModelType, "", "ASP/SSP/BSP/BackupBSP/SparseSSP");
+DEFINE_string(kStorageType, "", "Map/Vector/Hash/Sorted/Mmap/Fp16/BF16/Int8");
+DEFINE_string(storage_dir, "", "Mmap: the local directory of the backing files, on disk rather than tmpfs");
 DEFINE_int32(num_dims, 0, "number of dimensions");
 DEFINE_int32(batch_size, 100, "batch size of each epoch");
 DEFINE_int32(num_iters, 10, "number of iters");
@@ -32,8 +33,11 @@ DEFINE_int32(kSpeculation, 1, "speculation");
 DEFINE_string(kSparseSSPRecorderType, "", "None/Map/Vector");
 DEFINE_int32(num_workers_per_node, 1, "num_workers_per_node");
 DEFINE_int32(with_injected_straggler, 0, "with injected straggler or not, 0/1");
+DEFINE_int32(num_backup_workers, 1, "BackupBSP: the barrier passes once all but num_backup_workers workers clock");
 DEFINE_int32(num_servers_per_node, 1, "num_servers_per_node");
+DEFINE_int32(aggregate_clocks, 0, "send one clock per node instead of per worker to the servers, 0/1");
 DEFINE_double(alpha, 0.1, "learning rate");
+DEFINE_string(kOptimizer, "None", "None/SGD/AdaGrad/Adam/FTRL, the server-side optimizer, workers push gradients if set");
 
 namespace flexps {
 
@@ -88,7 +92,7 @@ void Run() {
   config.num_local_load_thread = FLAGS_num_workers_per_node;
 
   // DataObj = <feature<key, val>, label>
-  using DataObj = std::pair<std::vector<std::pair<int, float>>, float>;
+  using DataObj = std::pair<std::vector<std::pair<Key, float>>, float>;
 
   zmq::context_t* zmq_context = new zmq::context_t(1);
   HDFSManager hdfs_manager(my_node, nodes, config, zmq_context);
@@ -140,6 +144,8 @@ void Run() {
     model_type = ModelType::SSP;
   } else if (FLAGS_kModelType == "BSP") {
     model_type = ModelType::BSP;
+  } else if (FLAGS_kModelType == "BackupBSP") {
+    model_type = ModelType::BackupBSP;
   } else if (FLAGS_kModelType == "SparseSSP") {
     model_type = ModelType::SparseSSP;
   } else {
@@ -150,6 +156,19 @@ void Run() {
     storage_type = StorageType::Map;
   } else if (FLAGS_kStorageType == "Vector") {
     storage_type = StorageType::Vector;
+  } else if (FLAGS_kStorageType == "Hash") {
+    storage_type = StorageType::Hash;
+  } else if (FLAGS_kStorageType == "Sorted") {
+    storage_type = StorageType::Sorted;
+  } else if (FLAGS_kStorageType == "Mmap") {
+    storage_type = StorageType::Mmap;
+    engine.SetStorageDir(FLAGS_storage_dir);
+  } else if (FLAGS_kStorageType == "Fp16") {
+    storage_type = StorageType::Fp16;
+  } else if (FLAGS_kStorageType == "BF16") {
+    storage_type = StorageType::BF16;
+  } else if (FLAGS_kStorageType == "Int8") {
+    storage_type = StorageType::Int8;
   } else {
     CHECK(false) << "storage type error: " << FLAGS_kStorageType;
   }
@@ -163,14 +182,33 @@ void Run() {
   } else {
     CHECK(false) << "sparse_ssp_storage type error: " << FLAGS_kSparseSSPRecorderType;
   }
+  OptimizerConfig optimizer_config;
+  optimizer_config.learning_rate = FLAGS_alpha;
+  if (FLAGS_kOptimizer == "None") {
+    optimizer_config.type = OptimizerType::None;
+  } else if (FLAGS_kOptimizer == "SGD") {
+    optimizer_config.type = OptimizerType::SGD;
+  } else if (FLAGS_kOptimizer == "AdaGrad") {
+    optimizer_config.type = OptimizerType::AdaGrad;
+  } else if (FLAGS_kOptimizer == "Adam") {
+    optimizer_config.type = OptimizerType::Adam;
+  } else if (FLAGS_kOptimizer == "FTRL") {
+    optimizer_config.type = OptimizerType::FTRL;
+  } else {
+    CHECK(false) << "optimizer type error: " << FLAGS_kOptimizer;
+  }
 
   // Create SparseSSP table or normal table
   if (model_type == ModelType::SparseSSP) {
+    CHECK(optimizer_config.type == OptimizerType::None) << "SparseSSP tables do not support server-side optimizers";
     engine.CreateSparseSSPTable<float>(kTableId, range, 
         model_type, storage_type, FLAGS_kStaleness, FLAGS_kSpeculation, sparse_ssp_recorder_type);
   } else {
-    engine.CreateTable<float>(kTableId, range, 
-        model_type, storage_type, FLAGS_kStaleness);
+    const int num_backups = model_type == ModelType::BackupBSP ? FLAGS_num_backup_workers : 0;
+    engine.CreateTable<float>(kTableId, range, model_type, storage_type, FLAGS_kStaleness, 1, optimizer_config,
+                              InitializerConfig(), AdmissionConfig(), num_backups);
+    if (FLAGS_aggregate_clocks)
+      engine.AggregateClocks(kTableId);
   }
   engine.Barrier();
   // 3. Construct tasks
@@ -205,10 +243,13 @@ void Run() {
     std::chrono::steady_clock::time_point end_time;
     srand(time(0));
     //　TO DO: make it real LR algorithm
-    if (FLAGS_kModelType == "SSP" || FLAGS_kModelType == "ASP" || FLAGS_kModelType == "BSP") {  // normal mode
+    if (FLAGS_kModelType == "SSP" || FLAGS_kModelType == "ASP" || FLAGS_kModelType == "BSP" ||
+        FLAGS_kModelType == "BackupBSP") {  // normal mode
       auto table = info.CreateKVClientTable<float>(kTableId);
       third_party::SArray<float> params;
       third_party::SArray<float> deltas;
+      // With a server-side optimizer push the gradient of the loss, otherwise the SGD step itself.
+      const float step = FLAGS_kOptimizer == "None" ? FLAGS_alpha : -1.;
       for (int i = 0; i < FLAGS_num_iters; ++ i) {
         CHECK_LT(i, future_keys.size());
         auto& keys = future_keys[i];
@@ -233,7 +274,7 @@ void Run() {
             for (auto field : x) {
                 while (keys[j] < field.first)
                     j += 1;
-                deltas[j] += FLAGS_alpha * field.second * (y - pred_y);
+                deltas[j] += step * field.second * (y - pred_y);
             }
         }
         table->Add(keys, deltas);  // issue Push
@@ -6,12 +6,15 @@
 #include <gperftools/profiler.h>
 
 #include "driver/engine.hpp"
+#include "server/hash_storage.hpp"
+#include "server/sparsessp/sparse_ssp_replay.hpp"
 #include "worker/kv_client_table.hpp"
 
 #include <algorithm>
 #include <cstdlib>
 #include <chrono>
 #include <ctime>
+#include <sstream>
 
 DEFINE_int32(my_id, -1, "The process id of this program");
 DEFINE_string(config_file, "", "The config file path");
@@ -24,10 +27,13 @@ DEFINE_string(kModelType, "", "ASP/SSP/BSP/SparseSSP");
 DEFINE_string(kStorageType, "", "Map/Vector");
 DEFINE_int32(kStaleness, 0, "stalness");
 DEFINE_int32(kSpeculation, 1, "speculation");
-DEFINE_string(kSparseSSPRecorderType, "", "None/Map/Vector");
+DEFINE_string(kSparseSSPRecorderType, "", "None/Map/Vector/Bitset/FlatHash");
 DEFINE_int32(num_workers_per_node, 1, "num_workers_per_node");
 DEFINE_int32(with_injected_straggler, 0, "with injected straggler or not, 0/1");
 DEFINE_int32(num_servers_per_node, 1, "num_servers_per_node");
+DEFINE_string(bench_recorders, "",
+              "If set, replay num_workers_per_node workers on one SparseSSPModel in this process with each of "
+              "these recorders, comma separated (Map,Vector,Bitset,FlatHash), and report the time instead");
 
 namespace flexps {
 
@@ -71,12 +77,56 @@ std::vector<third_party::SArray<Key>> GenerateAllKeys(int num_dims, int num_iter
   return keys;
 }
 
+/*
+ * Replay the same random Gets of num_workers_per_node workers over num_dims keys on one SparseSSPModel
+ * with each recorder of bench_recorders, timing only the replay.
+ */
+void BenchRecorders() {
+  CHECK_GT(FLAGS_num_dims, 0);
+  CHECK_GT(FLAGS_num_nonzeros, 0);
+  CHECK_LE(FLAGS_num_nonzeros, FLAGS_num_dims);
+  CHECK_GE(FLAGS_kSpeculation, 1);
+  const int num_workers = FLAGS_num_workers_per_node;
+  auto keys = RandomReplayKeys(num_workers, FLAGS_num_iters, FLAGS_num_dims, FLAGS_num_nonzeros, 0);
+  LOG(INFO) << "Replaying " << num_workers << " workers, " << FLAGS_num_iters << " iters, up to "
+            << FLAGS_num_nonzeros << " of " << FLAGS_num_dims << " keys per Get, staleness: " << FLAGS_kStaleness
+            << " speculation: " << FLAGS_kSpeculation;
+
+  std::stringstream ss(FLAGS_bench_recorders);
+  std::string type;
+  while (std::getline(ss, type, ',')) {
+    third_party::Range range(0, FLAGS_num_dims);
+    auto start_time = std::chrono::steady_clock::now();
+    std::unique_ptr<AbstractSparseSSPRecorder> recorder;
+    if (type == "Map") {
+      recorder.reset(new UnorderedMapSparseSSPRecorder(FLAGS_kStaleness, FLAGS_kSpeculation));
+    } else if (type == "Vector") {
+      recorder.reset(new VectorSparseSSPRecorder(FLAGS_kStaleness, FLAGS_kSpeculation, range));
+    } else if (type == "Bitset") {
+      recorder.reset(new BitsetSparseSSPRecorder(FLAGS_kStaleness, FLAGS_kSpeculation, range));
+    } else if (type == "FlatHash") {
+      recorder.reset(new FlatHashSparseSSPRecorder(FLAGS_kStaleness, FLAGS_kSpeculation));
+    } else {
+      CHECK(false) << "sparse_ssp_storage type error: " << type;
+    }
+    auto replay_start_time = std::chrono::steady_clock::now();
+    CHECK(ReplaySparseSSP(std::unique_ptr<AbstractStorage>(new HashStorage<float>()), std::move(recorder),
+                          FLAGS_kStaleness, FLAGS_kSpeculation, keys, 0));
+    auto end_time = std::chrono::steady_clock::now();
+    LOG(INFO) << type << ": construct "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(replay_start_time - start_time).count()
+              << " ms, replay "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - replay_start_time).count()
+              << " ms";
+  }
+}
+
 void Run() {
   srand(0);
   CHECK_NE(FLAGS_my_id, -1);
   CHECK(!FLAGS_config_file.empty());
   CHECK(FLAGS_kModelType == "ASP" || FLAGS_kModelType == "BSP" || FLAGS_kModelType == "SSP" || FLAGS_kModelType == "SparseSSP");
-  CHECK(FLAGS_kSparseSSPRecorderType == "None" || FLAGS_kSparseSSPRecorderType == "Map" || FLAGS_kSparseSSPRecorderType == "Vector");
+  CHECK(FLAGS_kSparseSSPRecorderType == "None" || FLAGS_kSparseSSPRecorderType == "Map" || FLAGS_kSparseSSPRecorderType == "Vector" || FLAGS_kSparseSSPRecorderType == "Bitset" || FLAGS_kSparseSSPRecorderType == "FlatHash");
   CHECK(FLAGS_kStorageType == "Map" || FLAGS_kStorageType == "Vector");
   CHECK_GT(FLAGS_num_dims, 0);
   CHECK_GT(FLAGS_num_nonzeros, 0);
@@ -155,6 +205,10 @@ void Run() {
     sparse_ssp_recorder_type = SparseSSPRecorderType::Map;
   } else if (FLAGS_kSparseSSPRecorderType == "Vector") {
     sparse_ssp_recorder_type = SparseSSPRecorderType::Vector;
+  } else if (FLAGS_kSparseSSPRecorderType == "Bitset") {
+    sparse_ssp_recorder_type = SparseSSPRecorderType::Bitset;
+  } else if (FLAGS_kSparseSSPRecorderType == "FlatHash") {
+    sparse_ssp_recorder_type = SparseSSPRecorderType::FlatHash;
   } else {
     CHECK(false) << "sparse_ssp_storage type error: " << FLAGS_kSparseSSPRecorderType;
   }
@@ -268,5 +322,8 @@ void Run() {
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   google::InitGoogleLogging(argv[0]);
-  flexps::Run();
+  if (!FLAGS_bench_recorders.empty())
+    flexps::BenchRecorders();
+  else
+    flexps::Run();
 }
@@ -0,0 +1,422 @@
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+#include "base/threadsafe_queue.hpp"
+#include "server/hash_storage.hpp"
+#include "server/map_storage.hpp"
+#include "server/mmap_storage.hpp"
+#include "server/model.hpp"
+#include "server/progress_tracker.hpp"
+#include "server/quantized_storage.hpp"
+#include "server/sorted_storage.hpp"
+#include "server/ssp_model.hpp"
+#include "server/vector_storage.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+
+DEFINE_string(storage_types, "Map,Hash,Sorted", "The sparse storages to compare, comma separated");
+DEFINE_int32(min_batch_size, 1000, "The smallest batch size");
+DEFINE_int32(max_batch_size, 10000000, "The largest batch size, batch sizes grow by 10x");
+DEFINE_int32(num_rounds, 3, "Number of Add/Get rounds on the same keys per batch size");
+DEFINE_string(bench, "sparse",
+              "sparse: compare sparse storages, dense: VectorStorage against the per-key loop, "
+              "model: per-message overhead of SSPModel against Model<VectorStorage, SSPConsistency>, "
+              "mmap: VectorStorage against MmapStorage on random batches over dense_size keys, "
+              "quantized: full-model Add/Get of VectorStorage<float> against the fp16/bf16/int8 storages, "
+              "progress: ProgressTracker clocks against the map scan it replaced, for num_workers workers, "
+              "batch: the Gets released by a min clock advance, one by one against GetBatch");
+DEFINE_int32(dense_size, 10000000, "The number of keys of the dense table");
+DEFINE_string(storage_dir, "/tmp", "The directory of the MmapStorage file in the mmap bench");
+DEFINE_int32(num_msgs, 1000000, "The number of Add and Get messages per request size in the model bench");
+DEFINE_string(num_workers, "16,128,1024,4096", "The numbers of workers of the progress bench, comma separated");
+
+namespace flexps {
+
+std::unique_ptr<AbstractStorage> CreateStorage(const std::string& type) {
+  std::unique_ptr<AbstractStorage> storage;
+  if (type == "Map") {
+    storage.reset(new MapStorage<float>());
+  } else if (type == "Hash") {
+    storage.reset(new HashStorage<float>());
+  } else if (type == "Sorted") {
+    storage.reset(new SortedStorage<float>());
+  } else {
+    CHECK(false) << "Unknown storage type: " << type;
+  }
+  return storage;
+}
+
+third_party::SArray<Key> GenerateSortedKeys(size_t n, std::mt19937* gen) {
+  std::uniform_int_distribution<Key> dist(0, std::numeric_limits<Key>::max() - 1);
+  std::vector<Key> keys(n);
+  for (auto& key : keys)
+    key = dist(*gen);
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return third_party::SArray<Key>(keys);
+}
+
+template <typename F>
+double TimeMs(F f) {
+  auto start_time = std::chrono::steady_clock::now();
+  f();
+  auto end_time = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.;
+}
+
+/*
+ * Single-process microbenchmark of the server storages, without engine or messaging.
+ *
+ * For every batch size, a sorted batch of random sparse keys is added to an empty storage
+ * (insert), then added again and read num_rounds times (update/get on existing keys).
+ */
+void RunSparse() {
+  std::vector<std::string> types;
+  std::stringstream ss(FLAGS_storage_types);
+  std::string type;
+  while (std::getline(ss, type, ','))
+    types.push_back(type);
+
+  std::mt19937 gen(0);
+  for (size_t batch_size = FLAGS_min_batch_size; batch_size <= FLAGS_max_batch_size; batch_size *= 10) {
+    auto keys = GenerateSortedKeys(batch_size, &gen);
+    third_party::SArray<float> vals(keys.size(), 0.5);
+    for (const auto& type : types) {
+      auto storage = CreateStorage(type);
+      double insert_ms = TimeMs([&]() { storage->SubAdd(keys, third_party::SArray<char>(vals)); });
+      double add_ms = 0, get_ms = 0;
+      for (int i = 0; i < FLAGS_num_rounds; ++i) {
+        add_ms += TimeMs([&]() { storage->SubAdd(keys, third_party::SArray<char>(vals)); });
+        get_ms += TimeMs([&]() { storage->SubGet(keys); });
+      }
+      LOG(INFO) << "storage: " << type << ", batch_size: " << keys.size() << ", insert: " << insert_ms
+                << " ms, add: " << add_ms / FLAGS_num_rounds << " ms, get: " << get_ms / FLAGS_num_rounds << " ms";
+    }
+  }
+}
+
+/*
+ * The per-key VectorStorage loop before the run-based kernels, kept here as the baseline.
+ */
+void ScalarAdd(const third_party::Range& range, std::vector<float>* storage, const third_party::SArray<Key>& keys,
+               const third_party::SArray<float>& vals) {
+  for (size_t i = 0; i < keys.size(); i++) {
+    CHECK_GE(keys[i], range.begin());
+    CHECK_LT(keys[i], range.end());
+    (*storage)[keys[i] - range.begin()] += vals[i];
+  }
+}
+
+third_party::SArray<float> ScalarGet(const third_party::Range& range, const std::vector<float>& storage,
+                                     const third_party::SArray<Key>& keys) {
+  third_party::SArray<float> reply_vals(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    CHECK_GE(keys[i], range.begin());
+    CHECK_LT(keys[i], range.end());
+    reply_vals[i] = storage[keys[i] - range.begin()];
+  }
+  return reply_vals;
+}
+
+/*
+ * Full-model Add/Get on a dense table, like Get(all_keys) in the logistic regression example.
+ */
+void RunDense() {
+  third_party::Range range(0, FLAGS_dense_size);
+  third_party::SArray<Key> keys(FLAGS_dense_size);
+  std::iota(keys.begin(), keys.end(), 0);
+  third_party::SArray<float> vals(keys.size(), 0.5);
+
+  std::vector<float> scalar_storage(range.size());
+  VectorStorage<float> storage(range);
+  double scalar_add_ms = 0, scalar_get_ms = 0, add_ms = 0, get_ms = 0;
+  for (int i = 0; i < FLAGS_num_rounds; ++i) {
+    scalar_add_ms += TimeMs([&]() { ScalarAdd(range, &scalar_storage, keys, vals); });
+    scalar_get_ms += TimeMs([&]() { ScalarGet(range, scalar_storage, keys); });
+    add_ms += TimeMs([&]() { storage.SubAdd(keys, third_party::SArray<char>(vals)); });
+    get_ms += TimeMs([&]() { storage.SubGet(keys); });
+  }
+  LOG(INFO) << "dense_size: " << keys.size() << ", per-key loop add: " << scalar_add_ms / FLAGS_num_rounds
+            << " ms, get: " << scalar_get_ms / FLAGS_num_rounds << " ms";
+  LOG(INFO) << "dense_size: " << keys.size() << ", VectorStorage add: " << add_ms / FLAGS_num_rounds
+            << " ms, get: " << get_ms / FLAGS_num_rounds << " ms";
+}
+
+/*
+ * Feed num_msgs Add and Get messages with small consecutive key ranges to model and return the
+ * average ns per message, including popping the Get replies.
+ */
+double TimeModelNsPerMsg(AbstractModel* model, ThreadsafeQueue<Message>* reply_queue, int request_size) {
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>({0}));
+  model->ResetWorker(reset_msg);
+  reply_queue->WaitAndPop(&reset_msg);
+
+  std::vector<Message> adds, gets;
+  for (Key begin = 0; begin + request_size <= FLAGS_dense_size && adds.size() < 1000; begin += request_size) {
+    third_party::SArray<Key> keys(request_size);
+    std::iota(keys.begin(), keys.end(), begin);
+    Message add;
+    add.meta.flag = Flag::kAdd;
+    add.meta.sender = 0;
+    add.AddData(keys);
+    add.AddData(third_party::SArray<float>(request_size, 0.5));
+    adds.push_back(add);
+    Message get;
+    get.meta.flag = Flag::kGet;
+    get.meta.sender = 0;
+    get.AddData(keys);
+    gets.push_back(get);
+  }
+  Message reply;
+  double ms = TimeMs([&]() {
+    for (int i = 0; i < FLAGS_num_msgs; ++i) {
+      model->Add(adds[i % adds.size()]);
+      model->Get(gets[i % gets.size()]);
+      reply_queue->WaitAndPop(&reply);
+    }
+  });
+  return ms * 1e6 / (2. * FLAGS_num_msgs);
+}
+
+void RunModel() {
+  third_party::Range range(0, FLAGS_dense_size);
+  for (int request_size : {10, 30, 100}) {
+    ThreadsafeQueue<Message> reply_queue;
+    SSPModel virtual_model(0, std::unique_ptr<AbstractStorage>(new VectorStorage<float>(range)), 0, &reply_queue);
+    Model<VectorStorage<float>, SSPConsistency> typed_model(
+        0, std::unique_ptr<VectorStorage<float>>(new VectorStorage<float>(range)), 0, &reply_queue);
+    double virtual_ns = TimeModelNsPerMsg(&virtual_model, &reply_queue, request_size);
+    double typed_ns = TimeModelNsPerMsg(&typed_model, &reply_queue, request_size);
+    LOG(INFO) << "request_size: " << request_size << ", SSPModel: " << virtual_ns
+              << " ns/msg, Model<VectorStorage, SSPConsistency>: " << typed_ns << " ns/msg";
+  }
+}
+
+/*
+ * Random sparse batches over a large dense range. With dense_size * 4 bytes above the server RAM
+ * only MmapStorage can run, and its throughput drops as the hit rate of the page cache drops.
+ */
+void RunMmap() {
+  third_party::Range range(0, FLAGS_dense_size);
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<Key> dist(0, FLAGS_dense_size - 1);
+  std::vector<third_party::SArray<Key>> batches;
+  for (int i = 0; i < FLAGS_num_rounds; ++i) {
+    std::vector<Key> keys(FLAGS_min_batch_size);
+    for (auto& key : keys)
+      key = dist(gen);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    batches.push_back(third_party::SArray<Key>(keys));
+  }
+  for (const std::string type : {"Vector", "Mmap"}) {
+    std::unique_ptr<AbstractStorage> storage;
+    if (type == "Vector")
+      storage.reset(new VectorStorage<float>(range));
+    else
+      storage.reset(new MmapStorage<float>(range, FLAGS_storage_dir + "/storage_performance_example.bin"));
+    double add_ms = 0, get_ms = 0;
+    for (const auto& keys : batches) {
+      third_party::SArray<float> vals(keys.size(), 0.5);
+      add_ms += TimeMs([&]() { storage->SubAdd(keys, third_party::SArray<char>(vals)); });
+      get_ms += TimeMs([&]() { storage->SubGet(keys); });
+      storage->FinishIter();
+    }
+    LOG(INFO) << "storage: " << type << ", dense_size: " << FLAGS_dense_size << ", batch_size: "
+              << FLAGS_min_batch_size << ", add: " << add_ms / FLAGS_num_rounds << " ms, get: "
+              << get_ms / FLAGS_num_rounds << " ms";
+  }
+}
+
+template <typename Storage>
+void TimeDense(const std::string& type, Storage* storage, size_t bytes) {
+  third_party::SArray<Key> keys(FLAGS_dense_size);
+  std::iota(keys.begin(), keys.end(), 0);
+  third_party::SArray<float> vals(keys.size(), 0.5);
+  double add_ms = 0, get_ms = 0;
+  for (int i = 0; i < FLAGS_num_rounds; ++i) {
+    add_ms += TimeMs([&]() { storage->SubAdd(keys, third_party::SArray<char>(vals)); });
+    get_ms += TimeMs([&]() { storage->SubGet(keys); });
+  }
+  LOG(INFO) << "storage: " << type << ", dense_size: " << keys.size() << ", MB: " << bytes / 1e6
+            << ", add: " << add_ms / FLAGS_num_rounds << " ms, get: " << get_ms / FLAGS_num_rounds << " ms";
+}
+
+void RunQuantized() {
+  third_party::Range range(0, FLAGS_dense_size);
+  VectorStorage<float> vector_storage(range);
+  TimeDense("Vector", &vector_storage, range.size() * sizeof(float));
+  QuantizedStorage<float, Fp16> fp16(range);
+  TimeDense("Fp16", &fp16, fp16.Bytes());
+  QuantizedStorage<float, BF16> bf16(range);
+  TimeDense("BF16", &bf16, bf16.Bytes());
+  QuantizedStorage<float, Int8> int8(range);
+  TimeDense("Int8", &int8, int8.Bytes());
+}
+
+/*
+ * The ProgressTracker before the clock histogram, kept here as the baseline: a clock from a thread
+ * at the min clock scans the threads to see whether it was the only one there.
+ */
+class MapScanTracker {
+ public:
+  explicit MapScanTracker(const std::vector<uint32_t>& tids) {
+    for (auto tid : tids)
+      progresses_.insert({tid, 0});
+  }
+
+  int AdvanceAndGetChangedMinClock(int tid) {
+    int& progress = progresses_[tid];
+    bool unique_min = progress == min_clock_;
+    int min_count = 0;
+    for (auto it = progresses_.begin(); unique_min && it != progresses_.end(); ++it) {
+      min_count += (it->second == min_clock_);
+      unique_min = min_count <= 1;
+    }
+    progress += 1;
+    if (!unique_min)
+      return -1;
+    min_clock_ += 1;
+    return min_clock_;
+  }
+
+ private:
+  std::map<int, int> progresses_;
+  int min_clock_ = 0;
+};
+
+/*
+ * Every iteration, each of the workers (ids spread over nodes as by SimpleIdMapper) clocks once, in
+ * a random order or in the order of tids. Return the average ns per clock.
+ */
+template <typename Tracker>
+double TimeClockNs(Tracker* tracker, const std::vector<uint32_t>& tids, int num_iters, bool shuffle) {
+  std::mt19937 gen(0);
+  std::vector<uint32_t> order(tids);
+  int num_min_changes = 0;
+  double ms = TimeMs([&]() {
+    for (int iter = 0; iter < num_iters; ++iter) {
+      if (shuffle)
+        std::shuffle(order.begin(), order.end(), gen);
+      for (auto tid : order)
+        num_min_changes += (tracker->AdvanceAndGetChangedMinClock(tid) != -1);
+    }
+  });
+  CHECK_EQ(num_min_changes, num_iters);
+  return ms * 1e6 / (static_cast<double>(num_iters) * tids.size());
+}
+
+void RunProgress() {
+  std::stringstream ss(FLAGS_num_workers);
+  std::string num;
+  while (std::getline(ss, num, ',')) {
+    int num_workers = std::stoi(num);
+    std::vector<uint32_t> tids;
+    for (int i = 0; i < num_workers; ++i)
+      tids.push_back((i / 32) * 1000 + 100 + i % 32);  // 32 workers per node
+    // About 1M clocks per run
+    int num_iters = std::max(1, (1 << 20) / num_workers);
+    // In id order, every thread at the min clock finds the others there after itself: a full scan.
+    for (bool shuffle : {true, false}) {
+      MapScanTracker map_tracker(tids);
+      ProgressTracker tracker;
+      tracker.Init(tids);
+      double map_ns = TimeClockNs(&map_tracker, tids, num_iters, shuffle);
+      double ns = TimeClockNs(&tracker, tids, num_iters, shuffle);
+      LOG(INFO) << "num_workers: " << num_workers << ", order: " << (shuffle ? "random" : "by id")
+                << ", map scan: " << map_ns << " ns/clock, ProgressTracker: " << ns << " ns/clock";
+    }
+  }
+}
+
+/*
+ * The wake-up burst of num_workers Gets released together: batch_size random keys each from a hot
+ * set of dense_size keys on a Map storage, and the same full-model pull each on a Vector storage.
+ */
+void TimeBatch(const std::string& type, AbstractStorage* storage, const std::vector<Message>& msgs) {
+  double one_by_one_ms = 0, batch_ms = 0;
+  for (int i = 0; i < FLAGS_num_rounds; ++i) {
+    one_by_one_ms += TimeMs([&]() {
+      for (auto msg : msgs)
+        storage->Get(msg);
+    });
+    batch_ms += TimeMs([&]() {
+      std::vector<Message> released(msgs);
+      storage->GetBatch(released);
+    });
+  }
+  LOG(INFO) << "storage: " << type << ", requests: " << msgs.size() << ", one by one: " << one_by_one_ms / FLAGS_num_rounds
+            << " ms, GetBatch: " << batch_ms / FLAGS_num_rounds << " ms";
+}
+
+void RunBatch() {
+  third_party::SArray<Key> all_keys(FLAGS_dense_size);
+  std::iota(all_keys.begin(), all_keys.end(), 0);
+  third_party::SArray<float> vals(all_keys.size(), 0.5);
+  MapStorage<float> map_storage;
+  map_storage.SubAdd(all_keys, third_party::SArray<char>(vals));
+  VectorStorage<float> vector_storage(third_party::Range(0, FLAGS_dense_size));
+
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<Key> dist(0, FLAGS_dense_size - 1);
+  std::stringstream ss(FLAGS_num_workers);
+  std::string num;
+  while (std::getline(ss, num, ',')) {
+    std::vector<Message> sparse_msgs, dense_msgs;
+    for (int w = 0; w < std::stoi(num); ++w) {
+      std::vector<Key> keys(FLAGS_min_batch_size);
+      for (auto& key : keys)
+        key = dist(gen);
+      std::sort(keys.begin(), keys.end());
+      keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+      Message msg;
+      msg.meta.flag = Flag::kGet;
+      msg.meta.sender = w;
+      msg.AddData(third_party::SArray<Key>(keys));
+      sparse_msgs.push_back(msg);
+      msg.data.clear();
+      msg.meta.flag = Flag::kGetRange;
+      msg.AddData(third_party::SArray<Key>(std::vector<Key>({0, static_cast<Key>(FLAGS_dense_size - 1)})));
+      dense_msgs.push_back(msg);
+    }
+    TimeBatch("Map", &map_storage, sparse_msgs);
+    TimeBatch("Vector", &vector_storage, dense_msgs);
+  }
+}
+
+void Run() {
+  if (FLAGS_bench == "sparse") {
+    RunSparse();
+  } else if (FLAGS_bench == "dense") {
+    RunDense();
+  } else if (FLAGS_bench == "model") {
+    RunModel();
+  } else if (FLAGS_bench == "mmap") {
+    RunMmap();
+  } else if (FLAGS_bench == "quantized") {
+    RunQuantized();
+  } else if (FLAGS_bench == "progress") {
+    RunProgress();
+  } else if (FLAGS_bench == "batch") {
+    RunBatch();
+  } else {
+    CHECK(false) << "Unknown bench: " << FLAGS_bench;
+  }
+}
+
+}  // namespace flexps
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  flexps::Run();
+}
@@ -1,10 +1,9 @@
 #include <vector>
+#include "base/magic.hpp"
 #include "base/third_party/sarray.h"
 
 namespace flexps {
 
-using Key = uint32_t;
-
 /*
  * BatchDataSampler: Sample the data in batch
  * Can work on the whole datastore
@@ -1,8 +1,9 @@
 #include "boost/utility/string_ref.hpp"
+#include "base/magic.hpp"
 
 namespace flexps {
 
-using DataObj = std::pair<std::vector<std::pair<int, float>>, float>;
+using DataObj = std::pair<std::vector<std::pair<Key, float>>, float>;
 
 DataObj libsvm_parser(boost::string_ref record) {
 	DataObj this_obj;
@@ -13,11 +14,11 @@ DataObj libsvm_parser(boost::string_ref record) {
 	char* tok = strtok_r(record_ptr.get(), " \t:", &pos);
 
 	int i = -1;
-	int idx;
+	Key idx;
 	float val;
 	while (tok != NULL) {
 	  if (i == 0) {
-	      idx = std::atoi(tok) - 1;
+	      idx = std::strtoull(tok, NULL, 10) - 1;
 	      i = 1;
 	  } else if (i == 1) {
 	      val = std::atof(tok);
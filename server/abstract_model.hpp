@@ -4,6 +4,8 @@
 #include "base/message.hpp"
 #include "base/threadsafe_queue.hpp"
 
+#include "glog/logging.h"
+
 namespace flexps {
 
 class AbstractModel {
@@ -13,6 +15,16 @@ class AbstractModel {
   virtual void Get(Message& msg) = 0;
   virtual int GetProgress(int tid) = 0;
   virtual void ResetWorker(Message& msg) = 0;
+  // Checkpoint the storage now or every few clocks, see Model::Checkpoint.
+  virtual void Checkpoint(Message& msg) { CHECK(false) << "Checkpoint is not supported by this model"; }
+  // Fill the storage from a values file (kLoad) or from checkpoints (kRestore), see Model::Load.
+  virtual void Load(Message& msg) { CHECK(false) << "Load is not supported by this model"; }
+  // Register the key set of a worker, whose values are then pushed to it, see Subscriptions.
+  virtual void Subscribe(Message& msg) { CHECK(false) << "Subscribe is not supported by this model"; }
+  // Let the staleness vary within the bounds in msg.data[0], see KVEngine::AdaptStaleness.
+  virtual void AdaptStaleness(Message& msg) { CHECK(false) << "AdaptStaleness is not supported by this model"; }
+  // Let workers retire at a clock, see KVEngine::RetireWorkers.
+  virtual void RetireWorkers(Message& msg) { CHECK(false) << "RetireWorkers is not supported by this model"; }
   virtual ~AbstractModel() {}
 };
 
@@ -0,0 +1,138 @@
+#include "server/abstract_storage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+namespace flexps {
+
+namespace {
+
+bool SameKeys(const third_party::SArray<Key>& a, const third_party::SArray<Key>& b) {
+  return a.size() == b.size() &&
+         (a.data() == b.data() || std::memcmp(a.data(), b.data(), a.size() * sizeof(Key)) == 0);
+}
+
+}  // namespace
+
+std::vector<Message> AbstractStorage::GetBatch(std::vector<Message>& msgs) {
+  std::vector<Message> replies;
+  replies.reserve(msgs.size());
+  if (msgs.size() == 1) {
+    replies.push_back(Get(msgs[0]));
+    return replies;
+  }
+
+  std::vector<third_party::SArray<Key>> keys(msgs.size());
+  std::vector<third_party::SArray<char>> vals(msgs.size());
+  // 1. Find the distinct requests, source[i] is the first request with the flag and keys of request i.
+  std::vector<size_t> source(msgs.size());
+  std::unordered_map<uint64_t, std::vector<size_t>> firsts;
+  std::vector<size_t> distinct[3];  // kGet, kGetChunk, kGetRange
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    CHECK(msgs[i].data.size() == 1);
+    keys[i] = third_party::SArray<Key>(msgs[i].data[0]);
+    Flag flag = msgs[i].meta.flag;
+    uint64_t signature = static_cast<uint64_t>(flag) * 0x9E3779B97F4A7C15ULL ^ keys[i].size();
+    if (!keys[i].empty())
+      signature = signature * 31 + keys[i][0] * 17 + keys[i][keys[i].size() - 1];
+    auto& candidates = firsts[signature];
+    auto it = std::find_if(candidates.begin(), candidates.end(), [&](size_t j) {
+      return msgs[j].meta.flag == flag && SameKeys(keys[j], keys[i]);
+    });
+    if (it != candidates.end()) {
+      source[i] = *it;
+      continue;
+    }
+    source[i] = i;
+    candidates.push_back(i);
+    distinct[flag == Flag::kGetChunk ? 1 : (flag == Flag::kGetRange ? 2 : 0)].push_back(i);
+  }
+
+  // 2. Read the distinct requests, sorted kGet and kGetChunk ones as a union if worth it.
+  for (int g = 0; g < 3; ++g) {
+    Flag flag = g == 0 ? Flag::kGet : (g == 1 ? Flag::kGetChunk : Flag::kGetRange);
+    std::vector<size_t> sorted;
+    for (size_t i : distinct[g]) {
+      if (g < 2 && UnionGets() && std::is_sorted(keys[i].begin(), keys[i].end()))
+        sorted.push_back(i);
+      else
+        vals[i] = SubGetByFlag(flag, keys[i]);
+    }
+    if (sorted.size() == 1)
+      vals[sorted[0]] = SubGetByFlag(flag, keys[sorted[0]]);
+    else if (sorted.size() > 1)
+      UnionGet(flag, sorted, keys, &vals);
+  }
+
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    Message reply = CreateReply(msgs[i]);
+    reply.AddData<Key>(keys[i]);
+    reply.AddData<char>(vals[source[i]]);
+    replies.push_back(std::move(reply));
+  }
+  return replies;
+}
+
+third_party::SArray<char> AbstractStorage::SubGetByFlag(Flag flag, const third_party::SArray<Key>& typed_keys) {
+  if (flag == Flag::kGetChunk)
+    return SubGetChunk(typed_keys);
+  if (flag == Flag::kGetRange)
+    return SubGetRange(typed_keys);
+  return SubGet(typed_keys);
+}
+
+void AbstractStorage::UnionGet(Flag flag, const std::vector<size_t>& reqs,
+                               const std::vector<third_party::SArray<Key>>& keys,
+                               std::vector<third_party::SArray<char>>* vals) {
+  // Merge the sorted key arrays pairwise, log(reqs.size()) sequential passes.
+  std::vector<std::vector<Key>> runs;
+  for (size_t i : reqs)
+    runs.emplace_back(keys[i].begin(), keys[i].end());
+  while (runs.size() > 1) {
+    std::vector<std::vector<Key>> merged((runs.size() + 1) / 2);
+    for (size_t r = 0; r + 1 < runs.size(); r += 2) {
+      merged[r / 2].reserve(runs[r].size() + runs[r + 1].size());
+      std::set_union(runs[r].begin(), runs[r].end(), runs[r + 1].begin(), runs[r + 1].end(),
+                     std::back_inserter(merged[r / 2]));
+    }
+    if (runs.size() % 2 == 1)
+      merged.back().swap(runs.back());
+    runs.swap(merged);
+  }
+  std::vector<Key>& all_keys = runs[0];
+  all_keys.erase(std::unique(all_keys.begin(), all_keys.end()), all_keys.end());
+  if (all_keys.empty()) {
+    for (size_t i : reqs)
+      (*vals)[i] = SubGetByFlag(flag, keys[i]);
+    return;
+  }
+  third_party::SArray<Key> union_keys(all_keys);
+  third_party::SArray<char> union_vals = SubGetByFlag(flag, union_keys);
+  // The bytes of the values (a chunk for kGetChunk) of a key
+  size_t bytes = union_vals.size() / union_keys.size();
+  CHECK_EQ(bytes * union_keys.size(), union_vals.size());
+
+  // Both key arrays are sorted, so the positions are found by a merge and runs of keys that are
+  // consecutive in the union are copied at once.
+  for (size_t i : reqs) {
+    const auto& req_keys = keys[i];
+    third_party::SArray<char> req_vals(new char[req_keys.size() * bytes], req_keys.size() * bytes, true);
+    size_t pos = 0;
+    for (size_t j = 0; j < req_keys.size();) {
+      while (union_keys[pos] < req_keys[j])
+        pos += 1;
+      size_t len = 1;
+      while (j + len < req_keys.size() && pos + len < union_keys.size() &&
+             req_keys[j + len] == union_keys[pos + len])
+        len += 1;
+      std::memcpy(req_vals.data() + j * bytes, union_vals.data() + pos * bytes, len * bytes);
+      j += len;
+      pos += len - 1;
+    }
+    (*vals)[i] = req_vals;
+  }
+}
+
+}  // namespace flexps
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "base/key_ranges.hpp"
 #include "base/message.hpp"
 
 #include "glog/logging.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace flexps {
 
 /*
@@ -16,12 +21,38 @@ class AbstractStorage {
     auto typed_keys = third_party::SArray<Key>(msg.data[0]);
     if(msg.meta.flag == Flag::kAddChunk)
       SubAddChunk(typed_keys, msg.data[1]);
+    else if (msg.meta.flag == Flag::kAddRange)
+      SubAddRange(typed_keys, msg.data[1]);
     else
       SubAdd(typed_keys, msg.data[1]);
   }
   Message Get(Message& msg) {
     CHECK(msg.data.size() == 1);
     auto typed_keys = third_party::SArray<Key>(msg.data[0]);
+    Message reply = CreateReply(msg);
+    third_party::SArray<Key> reply_keys(typed_keys);
+    third_party::SArray<char> reply_vals;
+    if(msg.meta.flag == Flag::kGetChunk)
+      reply_vals = SubGetChunk(reply_keys);
+    else if (msg.meta.flag == Flag::kGetRange)
+      reply_vals = SubGetRange(reply_keys);
+    else
+      reply_vals = SubGet(reply_keys);
+    reply.AddData<Key>(reply_keys);
+    reply.AddData<char>(reply_vals);
+    return reply;
+  }
+
+  /*
+   * Serve the Get requests released together when the min clock advances, and return their replies
+   * in order. Requests for the same keys (e.g. full-model pulls) are read once and share the values.
+   * If UnionGets(), the other kGet (kGetChunk) requests with sorted keys are read as the union of
+   * their keys, whose values are scattered to the replies, so hot keys are looked up once.
+   */
+  std::vector<Message> GetBatch(std::vector<Message>& msgs);
+
+  // The reply to a Get request, without data.
+  static Message CreateReply(const Message& msg) {
     Message reply;
     reply.meta.recver = msg.meta.sender;
     reply.meta.sender = msg.meta.recver;
@@ -33,20 +64,16 @@ class AbstractStorage {
     case Flag::kGetChunk:
 	reply.meta.flag = Flag::kGetChunkReply;
 	break;
+    case Flag::kGetRange:
+	reply.meta.flag = Flag::kGetRangeReply;
+	break;
     default:
 	reply.meta.flag = msg.meta.flag;
 	break;
     }
     reply.meta.model_id = msg.meta.model_id;
     reply.meta.version = msg.meta.version;
-    third_party::SArray<Key> reply_keys(typed_keys);
-    third_party::SArray<char> reply_vals;
-    if(msg.meta.flag == Flag::kGetChunk)
-      reply_vals = SubGetChunk(reply_keys);
-    else
-      reply_vals = SubGet(reply_keys);
-    reply.AddData<Key>(reply_keys);
-    reply.AddData<char>(reply_vals);
+    reply.meta.key_width = msg.meta.key_width;
     return reply;
   }
   
@@ -56,8 +83,49 @@ class AbstractStorage {
       const third_party::SArray<char>& vals) = 0;
   virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) = 0;
   virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) = 0;
+  /*
+   * kAddRange/kGetRange carry the runs of consecutive keys instead of the keys, see
+   * base/key_ranges.hpp. By default the runs are expanded to keys, dense storages serve them directly.
+   */
+  virtual void SubAddRange(const third_party::SArray<Key>& ranges, const third_party::SArray<char>& vals) {
+    SubAdd(ExpandKeyRanges(ranges), vals);
+  }
+  virtual third_party::SArray<char> SubGetRange(const third_party::SArray<Key>& ranges) {
+    return SubGet(ExpandKeyRanges(ranges));
+  }
 
   virtual void FinishIter() = 0;
+
+  /*
+   * Whether a lookup costs more than merging the keys of a batch and copying the values out, so that
+   * GetBatch should read the union of the keys. Not for array or flat hash storages, whose lookups
+   * are about as cheap as the copy.
+   */
+  virtual bool UnionGets() const { return false; }
+
+  /*
+   * A zero delta of this storage, which the Adds of an iteration can be summed into and then added
+   * to this storage at once with FlushTo (see BSPConsistency). nullptr if Adds do not simply add up,
+   * e.g. optimizer steps or a custom Combine.
+   */
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const { return nullptr; }
+  // Add the values of this delta to target and reset them to zero.
+  virtual void FlushTo(AbstractStorage* target) { CHECK(false) << "FlushTo is not supported by this storage"; }
+
+  // Write the values changed since the last checkpoint to path, in the background (see server/checkpointer.hpp).
+  virtual void Checkpoint(const std::string& path) { CHECK(false) << "Checkpoint is not supported by this storage"; }
+  // Apply a checkpoint written by Checkpoint(), checkpoints are restored in the order they are taken.
+  virtual void Restore(const std::string& path) { CHECK(false) << "Restore is not supported by this storage"; }
+  // Copy the values of this storage's range out of a file holding the raw values of keys [0, n).
+  virtual void LoadRange(const std::string& path) { CHECK(false) << "LoadRange is not supported by this storage"; }
+
+  virtual ~AbstractStorage() {}
+
+ private:
+  third_party::SArray<char> SubGetByFlag(Flag flag, const third_party::SArray<Key>& typed_keys);
+  // Read the union of the keys of reqs at once and scatter the values to vals.
+  void UnionGet(Flag flag, const std::vector<size_t>& reqs, const std::vector<third_party::SArray<Key>>& keys,
+                std::vector<third_party::SArray<char>>* vals);
 };
 
 }  // namespace flexps
@@ -0,0 +1,113 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/abstract_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/map_storage.hpp"
+#include "server/vector_storage.hpp"
+
+#include <vector>
+
+namespace flexps {
+namespace {
+
+class TestAbstractStorage : public testing::Test {
+ public:
+  TestAbstractStorage() {}
+  ~TestAbstractStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+Message MakeGet(Flag flag, uint32_t sender, third_party::SArray<Key> keys) {
+  Message m;
+  m.meta.flag = flag;
+  m.meta.sender = sender;
+  m.meta.recver = 0;
+  m.meta.model_id = 0;
+  m.AddData(keys);
+  return m;
+}
+
+// GetBatch has to reply exactly as Get does request by request.
+void CheckBatch(AbstractStorage* s, std::vector<Message> msgs) {
+  std::vector<Message> copy(msgs);
+  auto replies = s->GetBatch(msgs);
+  ASSERT_EQ(replies.size(), copy.size());
+  for (size_t i = 0; i < copy.size(); ++i) {
+    Message expected = s->Get(copy[i]);
+    EXPECT_EQ(replies[i].meta.flag, expected.meta.flag);
+    EXPECT_EQ(replies[i].meta.recver, expected.meta.recver);
+    ASSERT_EQ(replies[i].data.size(), 2);
+    third_party::SArray<Key> keys(replies[i].data[0]);
+    third_party::SArray<Key> expected_keys(expected.data[0]);
+    ASSERT_EQ(keys.size(), expected_keys.size());
+    for (size_t j = 0; j < keys.size(); ++j)
+      EXPECT_EQ(keys[j], expected_keys[j]);
+    third_party::SArray<float> vals(replies[i].data[1]);
+    third_party::SArray<float> expected_vals(expected.data[1]);
+    ASSERT_EQ(vals.size(), expected_vals.size()) << i;
+    for (size_t j = 0; j < vals.size(); ++j)
+      EXPECT_EQ(vals[j], expected_vals[j]) << i << " " << j;
+  }
+}
+
+void CheckSparse(AbstractStorage* s) {
+  third_party::SArray<Key> keys({1, 3, 5, 7, 9, 11});
+  s->SubAdd(keys, third_party::SArray<char>(third_party::SArray<float>({1, 3, 5, 7, 9, 11})));
+  CheckBatch(s, {MakeGet(Flag::kGet, 1, {1, 3, 4}),
+                 MakeGet(Flag::kGet, 2, {3, 5, 7, 8}),
+                 MakeGet(Flag::kGet, 3, {1, 3, 4}),      // same keys as sender 1
+                 MakeGet(Flag::kGet, 4, {9, 9, 11}),     // duplicate keys
+                 MakeGet(Flag::kGet, 5, {11, 1, 7}),     // unsorted
+                 MakeGet(Flag::kGet, 6, {})});
+}
+
+TEST_F(TestAbstractStorage, GetBatchUnion) {
+  MapStorage<float> s;
+  EXPECT_TRUE(s.UnionGets());
+  CheckSparse(&s);
+}
+
+TEST_F(TestAbstractStorage, GetBatchNoUnion) {
+  HashStorage<float> s;
+  EXPECT_FALSE(s.UnionGets());
+  CheckSparse(&s);
+}
+
+TEST_F(TestAbstractStorage, GetBatchChunkAndRange) {
+  const uint32_t chunk_size = 2;
+  MapStorage<float> s(chunk_size);
+  third_party::SArray<Key> keys;
+  third_party::SArray<float> vals;
+  for (Key k = 0; k < 40; ++k) {
+    keys.push_back(k);
+    vals.push_back(k * 10);
+  }
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  CheckBatch(&s, {MakeGet(Flag::kGetChunk, 1, {0, 2, 3}),
+                  MakeGet(Flag::kGet, 2, {4, 5, 6}),
+                  MakeGet(Flag::kGetChunk, 3, {3, 4, 9}),
+                  MakeGet(Flag::kGetRange, 4, {2, 8, 12, 15}),
+                  MakeGet(Flag::kGetRange, 5, {2, 8, 12, 15}),
+                  MakeGet(Flag::kGet, 6, {5, 6, 7, 19})});
+}
+
+TEST_F(TestAbstractStorage, GetBatchShared) {
+  VectorStorage<float> s({0, 10});
+  std::vector<Message> msgs;
+  for (uint32_t sender = 0; sender < 4; ++sender)
+    msgs.push_back(MakeGet(Flag::kGetRange, sender, {0, 9}));
+  auto replies = s.GetBatch(msgs);
+  ASSERT_EQ(replies.size(), 4);
+  // One read, the values are shared by the replies.
+  for (auto& reply : replies) {
+    EXPECT_EQ(reply.meta.flag, Flag::kGetRangeReply);
+    EXPECT_EQ(reply.data[1].data(), replies[0].data[1].data());
+  }
+}
+
+}  // namespace
+}  // namespace flexps
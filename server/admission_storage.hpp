@@ -0,0 +1,273 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "server/abstract_storage.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace flexps {
+
+struct AdmissionConfig {
+  // A row is admitted on its admit_after-th Add, the Adds before are dropped. 0 or 1 admits at once.
+  uint32_t admit_after = 0;
+  // A row not added to for evict_after clocks is evicted, 0 never evicts.
+  uint32_t evict_after = 0;
+  // Counters per hash function and number of hash functions of the count-min sketch.
+  uint32_t sketch_width = 1 << 16;
+  uint32_t sketch_depth = 4;
+
+  bool Enabled() const { return admit_after > 1 || evict_after > 0; }
+};
+
+/*
+ * Approximate counts of keys in depth rows of width counters. A key has one counter per row and
+ * its count is the minimum of them, which overestimates only by the collisions in every row.
+ * Increment uses the conservative update (only the counters at the minimum grow), which keeps
+ * the overestimation of rare keys low.
+ */
+class CountMinSketch {
+ public:
+  CountMinSketch(uint32_t width, uint32_t depth) : depth_(depth) {
+    CHECK_GT(width, 0);
+    CHECK_GT(depth, 0);
+    uint32_t w = 1;
+    while (w < width)
+      w <<= 1;
+    mask_ = w - 1;
+    counters_.resize(static_cast<size_t>(w) * depth_, 0);
+  }
+
+  // Count key once more and return its new count.
+  uint32_t Increment(Key key) {
+    uint64_t hash = Hash(key);
+    uint32_t min = EstimateHash(hash);
+    if (min == UINT32_MAX)
+      return min;
+    for (uint32_t i = 0; i < depth_; ++i) {
+      uint32_t& c = counters_[Index(hash, i)];
+      if (c == min)
+        c += 1;
+    }
+    return min + 1;
+  }
+
+  uint32_t Estimate(Key key) const { return EstimateHash(Hash(key)); }
+
+  // Age the counts, so that keys which stop showing up have to earn their admission again.
+  void Halve() {
+    for (auto& c : counters_)
+      c >>= 1;
+  }
+
+ private:
+  uint32_t EstimateHash(uint64_t hash) const {
+    uint32_t min = UINT32_MAX;
+    for (uint32_t i = 0; i < depth_; ++i)
+      min = std::min(min, counters_[Index(hash, i)]);
+    return min;
+  }
+
+  static uint64_t Hash(Key key) {
+    // splitmix64
+    uint64_t x = static_cast<uint64_t>(key) + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+
+  // Double hashing: row i uses h1 + i * h2 with the two halves of the hash.
+  size_t Index(uint64_t hash, uint32_t i) const {
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    return static_cast<size_t>(i) * (mask_ + 1) + ((h1 + i * h2) & mask_);
+  }
+
+  uint32_t depth_;
+  uint32_t mask_;
+  std::vector<uint32_t> counters_;
+};
+
+struct AdmissionStats {
+  uint64_t admitted = 0;  // rows
+  uint64_t rejected = 0;  // Add entries dropped before their row was admitted
+  uint64_t evicted = 0;   // rows
+  size_t size = 0;        // rows held now
+};
+
+/*
+ * A frequency-based admission and eviction layer on top of a sparse storage (MapStorage,
+ * HashStorage, SortedStorage), so that its memory follows the active rows instead of every row
+ * ever added to, as with the long tail of features in CTR workloads.
+ *
+ * - Admission: the Adds to a row are counted in a CountMinSketch and dropped until the row's count
+ *   reaches admit_after. Then the row is inserted into the storage.
+ * - Eviction: the clock of the last Add of every admitted row is kept, and on FinishIter, which
+ *   every consistency calls when the min clock moves up, the rows not added to for evict_after
+ *   clocks are erased from the storage. Rows are scanned every evict_after / 4 clocks, so a row
+ *   goes after evict_after to 1.25 * evict_after idle clocks. The sketch is halved every
+ *   evict_after clocks to age the counts of rows which went quiet.
+ *
+ * A row is a chunk key, or key / chunk_size for SubAdd. Gets go straight to the storage, so rows
+ * not admitted or evicted read as the storage's initial value (see server/initializer.hpp).
+ * Storage needs `void Erase(const std::vector<Key>& row_keys)` taking sorted row keys.
+ */
+template <typename Storage>
+class AdmissionStorage : public AbstractStorage {
+ public:
+  AdmissionStorage(uint32_t table_id, std::unique_ptr<Storage>&& storage, const AdmissionConfig& config,
+                   uint32_t chunk_size = 1)
+      : table_id_(table_id),
+        storage_(std::move(storage)),
+        config_(config),
+        chunk_size_(chunk_size),
+        sketch_(config.sketch_width, config.sketch_depth) {
+    CHECK_GT(chunk_size_, 0);
+    scan_every_ = std::max<uint32_t>(config_.evict_after / 4, 1);
+  }
+
+  ~AdmissionStorage() {
+    if (config_.Enabled())
+      LOG(INFO) << "table " << table_id_ << " admission: size " << stats_.size << ", admitted " << stats_.admitted
+                << " rows, rejected " << stats_.rejected << " adds, evicted " << stats_.evicted << " rows";
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    AddImpl(typed_keys, vals, 1, [this](Key key) { return key / chunk_size_; },
+            [this](const third_party::SArray<Key>& k, const third_party::SArray<char>& v) {
+              storage_->Storage::SubAdd(k, v);
+            });
+  }
+
+  virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    AddImpl(typed_keys, vals, chunk_size_, [](Key key) { return key; },
+            [this](const third_party::SArray<Key>& k, const third_party::SArray<char>& v) {
+              storage_->Storage::SubAddChunk(k, v);
+            });
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    return storage_->Storage::SubGet(typed_keys);
+  }
+
+  virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) override {
+    return storage_->Storage::SubGetChunk(typed_keys);
+  }
+
+  virtual bool UnionGets() const override { return storage_->Storage::UnionGets(); }
+
+  virtual void FinishIter() override {
+    iter_ += 1;
+    if (config_.evict_after > 0 && iter_ % scan_every_ == 0)
+      Evict();
+    if (config_.evict_after > 0 && iter_ % config_.evict_after == 0)
+      sketch_.Halve();
+    storage_->Storage::FinishIter();
+  }
+
+  const AdmissionStats& GetStats() const { return stats_; }
+  Storage* GetStorage() { return storage_.get(); }
+
+ private:
+  /*
+   * Forward the entries of admitted rows to add. The request is forwarded as is when every row is
+   * admitted, otherwise the admitted entries are copied out. width is the number of values per key.
+   */
+  template <typename RowOf, typename Add>
+  void AddImpl(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals, uint32_t width,
+               RowOf row_of, Add add) {
+    if (typed_keys.empty())
+      return;
+    size_t val_bytes = vals.size() / (typed_keys.size() * width);
+    CHECK_EQ(vals.size(), typed_keys.size() * width * val_bytes);
+    std::vector<uint8_t> keep(typed_keys.size());
+    size_t num_kept = 0;
+    Key last_row = 0;
+    bool last_keep = false;
+    for (size_t i = 0; i < typed_keys.size(); ++i) {
+      Key row = row_of(typed_keys[i]);
+      // Entries of the same row are next to each other in a sorted request, count the row once.
+      if (i == 0 || row != last_row) {
+        last_row = row;
+        last_keep = Admit(row);
+      }
+      keep[i] = last_keep;
+      num_kept += last_keep;
+      stats_.rejected += !last_keep;
+    }
+    if (num_kept == typed_keys.size()) {
+      add(typed_keys, vals);
+      return;
+    }
+    if (num_kept == 0)
+      return;
+    third_party::SArray<Key> kept_keys(num_kept);
+    third_party::SArray<char> kept_vals(num_kept * width * val_bytes);
+    size_t n = 0;
+    for (size_t i = 0; i < typed_keys.size(); ++i) {
+      if (!keep[i])
+        continue;
+      kept_keys[n] = typed_keys[i];
+      std::copy(vals.data() + i * width * val_bytes, vals.data() + (i + 1) * width * val_bytes,
+                kept_vals.data() + n * width * val_bytes);
+      n += 1;
+    }
+    add(kept_keys, kept_vals);
+  }
+
+  // Whether the Add to row goes through, stamping the row with the current clock.
+  bool Admit(Key row) {
+    auto it = last_add_.find(row);
+    if (it != last_add_.end()) {
+      it->second = iter_;
+      return true;
+    }
+    if (config_.admit_after > 1 && sketch_.Increment(row) < config_.admit_after)
+      return false;
+    last_add_.emplace(row, iter_);
+    stats_.admitted += 1;
+    stats_.size = last_add_.size();
+    return true;
+  }
+
+  void Evict() {
+    std::vector<Key> rows;
+    for (auto it = last_add_.begin(); it != last_add_.end();) {
+      if (iter_ - it->second >= config_.evict_after) {
+        rows.push_back(it->first);
+        it = last_add_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (rows.empty())
+      return;
+    std::sort(rows.begin(), rows.end());
+    storage_->Storage::Erase(rows);
+    stats_.evicted += rows.size();
+    stats_.size = last_add_.size();
+    VLOG(1) << "table " << table_id_ << " evicted " << rows.size() << " rows at clock " << iter_ << ", "
+            << stats_.size << " rows left";
+  }
+
+  uint32_t table_id_;
+  std::unique_ptr<Storage> storage_;
+  AdmissionConfig config_;
+  uint32_t chunk_size_;
+  uint32_t scan_every_;
+  uint32_t iter_ = 0;
+
+  CountMinSketch sketch_;
+  // The clock of the last Add of every admitted row
+  std::unordered_map<Key, uint32_t> last_add_;
+  AdmissionStats stats_;
+};
+
+}  // namespace flexps
@@ -0,0 +1,121 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/admission_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/map_storage.hpp"
+#include "server/sorted_storage.hpp"
+
+namespace flexps {
+namespace {
+
+class TestAdmissionStorage : public testing::Test {
+ public:
+  TestAdmissionStorage() {}
+  ~TestAdmissionStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+template <typename Storage>
+void Add(AdmissionStorage<Storage>* s, third_party::SArray<Key> keys, third_party::SArray<float> vals) {
+  s->SubAdd(keys, third_party::SArray<char>(vals));
+}
+
+template <typename Storage>
+float Get(AdmissionStorage<Storage>* s, Key key) {
+  third_party::SArray<Key> keys({key});
+  return third_party::SArray<float>(s->SubGet(keys))[0];
+}
+
+TEST_F(TestAdmissionStorage, CountMinSketch) {
+  CountMinSketch sketch(1024, 4);
+  for (uint32_t i = 0; i < 100; ++ i) {
+    for (uint32_t k = 0; k <= i % 10; ++ k) {
+      sketch.Increment(i);
+    }
+  }
+  // Counts are never underestimated and rarely overestimated in a sketch this sparse.
+  int num_exact = 0;
+  for (uint32_t i = 0; i < 100; ++ i) {
+    EXPECT_GE(sketch.Estimate(i), i % 10 + 1);
+    num_exact += sketch.Estimate(i) == i % 10 + 1;
+  }
+  EXPECT_GT(num_exact, 95);
+  EXPECT_EQ(sketch.Estimate(12345), 0);
+
+  sketch.Halve();
+  EXPECT_EQ(sketch.Estimate(9), 5);
+}
+
+TEST_F(TestAdmissionStorage, Admit) {
+  AdmissionConfig config;
+  config.admit_after = 3;
+  AdmissionStorage<MapStorage<float>> s(0, std::unique_ptr<MapStorage<float>>(new MapStorage<float>()), config);
+
+  // Key 1 is added 3 times, key 2 once, the first two Adds to key 1 are dropped.
+  for (int i = 0; i < 3; ++ i) {
+    Add(&s, {1}, {1.0});
+  }
+  Add(&s, {1, 2}, {0.5, 0.5});
+  EXPECT_EQ(Get(&s, 1), 1.5);
+  EXPECT_EQ(Get(&s, 2), 0);
+  EXPECT_EQ(s.GetStorage()->Size(), 1);
+  EXPECT_EQ(s.GetStats().admitted, 1);
+  EXPECT_EQ(s.GetStats().rejected, 3);
+  EXPECT_EQ(s.GetStats().size, 1);
+}
+
+TEST_F(TestAdmissionStorage, Evict) {
+  AdmissionConfig config;
+  config.evict_after = 4;
+  AdmissionStorage<HashStorage<float>> s(0, std::unique_ptr<HashStorage<float>>(new HashStorage<float>()), config);
+
+  Add(&s, {1, 2, 3}, {1, 2, 3});
+  for (int iter = 0; iter < 8; ++ iter) {
+    // Key 2 stays active.
+    Add(&s, {2}, {1});
+    s.FinishIter();
+  }
+  EXPECT_EQ(Get(&s, 1), 0);
+  EXPECT_EQ(Get(&s, 2), 10);
+  EXPECT_EQ(Get(&s, 3), 0);
+  EXPECT_EQ(s.GetStorage()->Size(), 1);
+  EXPECT_EQ(s.GetStats().evicted, 2);
+  EXPECT_EQ(s.GetStats().size, 1);
+
+  // An evicted key comes back from its initial value.
+  Add(&s, {3}, {1});
+  EXPECT_EQ(Get(&s, 3), 1);
+  EXPECT_EQ(s.GetStats().admitted, 4);
+}
+
+TEST_F(TestAdmissionStorage, Chunk) {
+  AdmissionConfig config;
+  config.admit_after = 2;
+  config.evict_after = 1;
+  AdmissionStorage<SortedStorage<float>> s(0, std::unique_ptr<SortedStorage<float>>(new SortedStorage<float>(2)),
+                                           config, 2);
+
+  third_party::SArray<Key> keys({0, 1});
+  third_party::SArray<float> vals({1, 2, 3, 4});
+  s.SubAddChunk(keys, third_party::SArray<char>(vals));
+  s.SubAddChunk(keys, third_party::SArray<char>(vals));
+  third_party::SArray<float> ret(s.SubGetChunk(keys));
+  for (int i = 0; i < 4; ++ i) {
+    EXPECT_EQ(ret[i], vals[i]);
+  }
+
+  // Element keys 2 and 3 fall into row 1, which is admitted.
+  Add(&s, {2, 3}, {1, 1});
+  EXPECT_EQ(Get(&s, 2), 4);
+  EXPECT_EQ(s.GetStats().rejected, 2);
+  s.FinishIter();
+  EXPECT_EQ(s.GetStorage()->Size(), 0);
+  EXPECT_EQ(s.GetStats().evicted, 2);
+}
+
+}  // namespace
+}  // namespace flexps
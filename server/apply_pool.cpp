@@ -0,0 +1,66 @@
+#include "server/apply_pool.hpp"
+
+#include "glog/logging.h"
+
+namespace flexps {
+
+ApplyPool::ApplyPool(uint32_t num_threads) {
+  for (uint32_t i = 0; i < num_threads; ++i)
+    threads_.emplace_back([this, i] { Main(i + 1); });
+}
+
+ApplyPool::~ApplyPool() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    exit_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+void ApplyPool::ParallelFor(size_t n, const std::function<void(size_t, size_t)>& f) {
+  if (threads_.empty() || n < NumParts()) {
+    f(0, n);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    CHECK_EQ(num_running_, 0) << "ParallelFor is not reentrant";
+    task_ = &f;
+    n_ = n;
+    num_running_ = threads_.size();
+    generation_ += 1;
+  }
+  start_cv_.notify_all();
+  RunPart(0);
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait(lock, [this] { return num_running_ == 0; });
+  task_ = nullptr;
+}
+
+void ApplyPool::Main(uint32_t part) {
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      start_cv_.wait(lock, [this, seen] { return exit_ || generation_ != seen; });
+      if (exit_)
+        return;
+      seen = generation_;
+    }
+    RunPart(part);
+    std::lock_guard<std::mutex> lock(mu_);
+    if (--num_running_ == 0)
+      done_cv_.notify_one();
+  }
+}
+
+void ApplyPool::RunPart(uint32_t part) {
+  size_t begin = n_ * part / NumParts();
+  size_t end = n_ * (part + 1) / NumParts();
+  if (begin < end)
+    (*task_)(begin, end);
+}
+
+}  // namespace flexps
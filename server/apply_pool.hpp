@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * A fork-join pool that lets a server thread apply one large request with several cores.
+ *
+ * ParallelFor splits [0, n) into NumParts() contiguous parts, runs them on the pool threads and on
+ * the calling thread, and returns when all of them are done. The server thread still handles one
+ * message at a time, so the order of Adds and Gets the consistency models rely on is unchanged.
+ *
+ * It is owned by a ServerThread and used by the storages of its models (see VectorStorage), from
+ * the server thread only.
+ */
+class ApplyPool {
+ public:
+  // num_threads threads besides the calling one
+  explicit ApplyPool(uint32_t num_threads);
+  ~ApplyPool();
+  ApplyPool(const ApplyPool&) = delete;
+  ApplyPool& operator=(const ApplyPool&) = delete;
+
+  uint32_t NumParts() const { return threads_.size() + 1; }
+
+  // Call f(begin, end) on every part of [0, n), the calling thread takes part 0.
+  void ParallelFor(size_t n, const std::function<void(size_t, size_t)>& f);
+
+ private:
+  void Main(uint32_t part);
+  void RunPart(uint32_t part);
+
+  std::vector<std::thread> threads_;
+  std::mutex mu_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  // Bumped by each ParallelFor, the threads wait for a new one.
+  uint64_t generation_ = 0;
+  bool exit_ = false;
+  // The running ParallelFor
+  const std::function<void(size_t, size_t)>* task_ = nullptr;
+  size_t n_ = 0;
+  uint32_t num_running_ = 0;
+};
+
+}  // namespace flexps
@@ -0,0 +1,74 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/apply_pool.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace flexps {
+namespace {
+
+class TestApplyPool : public testing::Test {
+ public:
+  TestApplyPool() {}
+  ~TestApplyPool() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestApplyPool, Create) {
+  ApplyPool pool(0);
+  EXPECT_EQ(pool.NumParts(), 1);
+  ApplyPool pool1(3);
+  EXPECT_EQ(pool1.NumParts(), 4);
+}
+
+TEST_F(TestApplyPool, CoversEveryIndexOnce) {
+  ApplyPool pool(3);
+  std::vector<std::atomic<int>> hits(1000);
+  for (auto& h : hits)
+    h = 0;
+  std::atomic<int> num_parts(0);
+  pool.ParallelFor(hits.size(), [&](size_t begin, size_t end) {
+    num_parts += 1;
+    for (size_t i = begin; i < end; ++i)
+      hits[i] += 1;
+  });
+  EXPECT_EQ(num_parts, 4);
+  for (auto& h : hits)
+    EXPECT_EQ(h, 1);
+}
+
+TEST_F(TestApplyPool, Repeated) {
+  ApplyPool pool(2);
+  std::atomic<size_t> sum(0);
+  for (int k = 0; k < 100; ++k) {
+    pool.ParallelFor(100, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+        sum += i;
+    });
+  }
+  EXPECT_EQ(sum, 100 * 4950);
+}
+
+TEST_F(TestApplyPool, FewerThanParts) {
+  ApplyPool pool(3);
+  std::vector<int> hits(2, 0);
+  int num_calls = 0;
+  // Too small to split, runs on the calling thread.
+  pool.ParallelFor(hits.size(), [&](size_t begin, size_t end) {
+    num_calls += 1;
+    for (size_t i = begin; i < end; ++i)
+      hits[i] += 1;
+  });
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(hits[0], 1);
+  EXPECT_EQ(hits[1], 1);
+  pool.ParallelFor(0, [&](size_t begin, size_t end) { EXPECT_EQ(begin, end); });
+}
+
+}  // namespace
+}  // namespace flexps
@@ -41,7 +41,7 @@ TEST_F(TestASPModel, CheckGetAndAdd) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -58,7 +58,7 @@ TEST_F(TestASPModel, CheckGetAndAdd) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -71,7 +71,7 @@ TEST_F(TestASPModel, CheckGetAndAdd) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -90,7 +90,7 @@ TEST_F(TestASPModel, CheckGetAndAdd) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -108,7 +108,7 @@ TEST_F(TestASPModel, CheckGetAndAdd) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -127,7 +127,7 @@ TEST_F(TestASPModel, CheckGetAndAdd) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -11,8 +11,9 @@
 
 namespace flexps {
 
-
-/* 
+/*
+ * Deprecated: KVEngine builds Model<Storage, BSPConsistency> (server/model.hpp) instead.
+ *
  * TODO: The BSPModel is now problematic!!!
  * This is because the Get() request is only sent to the servers that have the keys, and thus
  * it is possible that a worker is fast so that a server may receive Clock() which is min_clock + 2.
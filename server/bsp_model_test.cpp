@@ -44,7 +44,7 @@ TEST_F(TestBSPModel, CheckGetAndAdd) {
   m0.meta.model_id = 0;
   m0.meta.sender = 2;
   m0.meta.recver = 0;
-  third_party::SArray<int> m0_keys({1});
+  third_party::SArray<Key> m0_keys({1});
   m0.AddData(m0_keys);
   model->Get(m0);
 
@@ -58,7 +58,7 @@ TEST_F(TestBSPModel, CheckGetAndAdd) {
   m1.meta.model_id = 0;
   m1.meta.sender = 2;
   m1.meta.recver = 0;
-  third_party::SArray<int> m1_keys({1});
+  third_party::SArray<Key> m1_keys({1});
   third_party::SArray<int> m1_vals({100});
   m1.AddData(m1_keys);
   m1.AddData(m1_vals);
@@ -82,14 +82,14 @@ TEST_F(TestBSPModel, CheckGetAndAdd) {
   cm1.meta.model_id = 0;
   cm1.meta.sender = 3;
   cm1.meta.recver = 0;
-  third_party::SArray<int> cm1_keys({1});
+  third_party::SArray<Key> cm1_keys({1});
   cm1.AddData(cm1_keys);
   model->Get(cm1);
 
   Message check_msg;
   EXPECT_EQ(reply_queue.Size(), 1);
   reply_queue.WaitAndPop(&check_msg);
-  auto rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  auto rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   auto rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -113,14 +113,14 @@ TEST_F(TestBSPModel, CheckGetAndAdd) {
   cm2.meta.model_id = 0;
   cm2.meta.sender = 3;
   cm2.meta.recver = 0;
-  third_party::SArray<int> cm2_keys({1});
+  third_party::SArray<Key> cm2_keys({1});
   cm2.AddData(cm2_keys);
   model->Get(cm2);
 
   Message check_msg2;
   EXPECT_EQ(reply_queue.Size(), 1);
   reply_queue.WaitAndPop(&check_msg2);
-  auto rep_keys2 = third_party::SArray<int>(check_msg2.data[0]);
+  auto rep_keys2 = third_party::SArray<Key>(check_msg2.data[0]);
   auto rep_vals2 = third_party::SArray<int>(check_msg2.data[1]);
   EXPECT_EQ(rep_keys2.size(), 1);
   EXPECT_EQ(rep_vals2.size(), 1);
@@ -0,0 +1,127 @@
+#include "server/checkpointer.hpp"
+
+#include "server/mapped_file.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace flexps {
+
+namespace {
+
+const uint64_t kCheckpointMagic = 0x74706b6370786c66ULL;  // "flxpckpt"
+
+struct CheckpointHeader {
+  uint64_t magic;
+  uint64_t bytes;
+  uint64_t block_bytes;
+  uint64_t num_blocks;
+};
+
+}  // namespace
+
+Checkpointer::Checkpointer(char* base, size_t bytes, size_t block_bytes)
+    : base_(base), bytes_(bytes), block_bytes_(block_bytes) {
+  CHECK_GT(block_bytes_, 0);
+  size_t num_blocks = (bytes_ + block_bytes_ - 1) / block_bytes_;
+  dirty_.resize(num_blocks, 0);
+  state_.reset(new std::atomic<uint8_t>[num_blocks]);
+  for (size_t i = 0; i < num_blocks; ++i)
+    state_[i].store(kIdle, std::memory_order_relaxed);
+}
+
+Checkpointer::~Checkpointer() { Wait(); }
+
+void Checkpointer::Start(const std::string& path) {
+  Wait();
+  std::vector<size_t> blocks;
+  for (size_t i = 0; i < dirty_.size(); ++i) {
+    if (dirty_[i]) {
+      blocks.push_back(i);
+      dirty_[i] = 0;
+      state_[i].store(kPending, std::memory_order_relaxed);
+    }
+  }
+  // Starting the thread publishes the states to it.
+  writer_ = std::thread([this, path, blocks]() { WriteBlocks(path, blocks); });
+}
+
+void Checkpointer::Wait() {
+  if (writer_.joinable())
+    writer_.join();
+}
+
+void Checkpointer::CopyOnWrite(size_t block) {
+  std::lock_guard<std::mutex> lk(mu_);
+  // The writer may have written the block since the state was read.
+  if (state_[block].load(std::memory_order_relaxed) != kPending)
+    return;
+  char* begin = base_ + block * block_bytes_;
+  copies_[block].assign(begin, begin + BlockSize(block));
+  state_[block].store(kCopied, std::memory_order_release);
+}
+
+void Checkpointer::WriteBlocks(const std::string& path, const std::vector<size_t>& blocks) {
+  FILE* file = fopen(path.c_str(), "wb");
+  CHECK(file) << "fopen " << path << ": " << strerror(errno);
+  CheckpointHeader header{kCheckpointMagic, bytes_, block_bytes_, blocks.size()};
+  CHECK_EQ(fwrite(&header, sizeof(header), 1, file), 1) << "fwrite " << path << ": " << strerror(errno);
+  std::vector<char> buffer;
+  for (size_t block : blocks) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      auto it = copies_.find(block);
+      if (it != copies_.end()) {
+        buffer.swap(it->second);
+        copies_.erase(it);
+      } else {
+        char* begin = base_ + block * block_bytes_;
+        buffer.assign(begin, begin + BlockSize(block));
+      }
+      state_[block].store(kIdle, std::memory_order_release);
+    }
+    uint64_t index = block;
+    CHECK_EQ(fwrite(&index, sizeof(index), 1, file), 1) << "fwrite " << path << ": " << strerror(errno);
+    CHECK_EQ(fwrite(buffer.data(), 1, buffer.size(), file), buffer.size())
+        << "fwrite " << path << ": " << strerror(errno);
+  }
+  CHECK_EQ(fclose(file), 0) << "fclose " << path << ": " << strerror(errno);
+}
+
+void Checkpointer::Restore(const std::string& path) {
+  // The region must not change under a running checkpoint.
+  Wait();
+  // The blocks are copied straight out of the mapped file.
+  MappedFile file(path);
+  const char* pos = file.data();
+  const char* end = file.data() + file.size();
+  CheckpointHeader header;
+  CHECK_GE(static_cast<size_t>(end - pos), sizeof(header)) << "Truncated checkpoint " << path;
+  memcpy(&header, pos, sizeof(header));
+  pos += sizeof(header);
+  CHECK_EQ(header.magic, kCheckpointMagic) << "Not a checkpoint: " << path;
+  CHECK_EQ(header.bytes, bytes_) << "Checkpoint " << path << " is of another range or value type";
+  CHECK_EQ(header.block_bytes, block_bytes_) << "Checkpoint " << path << " has another block size";
+  for (uint64_t i = 0; i < header.num_blocks; ++i) {
+    uint64_t block;
+    CHECK_GE(static_cast<size_t>(end - pos), sizeof(block)) << "Truncated checkpoint " << path;
+    memcpy(&block, pos, sizeof(block));
+    pos += sizeof(block);
+    CHECK_LT(block, dirty_.size()) << "Corrupted checkpoint " << path;
+    size_t size = BlockSize(block);
+    CHECK_GE(static_cast<size_t>(end - pos), size) << "Truncated checkpoint " << path;
+    memcpy(base_ + block * block_bytes_, pos, size);
+    pos += size;
+    dirty_[block] = 1;
+  }
+}
+
+size_t Checkpointer::NumDirtyBlocks() const { return std::count(dirty_.begin(), dirty_.end(), 1); }
+
+size_t Checkpointer::BlockSize(size_t block) const { return std::min(block_bytes_, bytes_ - block * block_bytes_); }
+
+}  // namespace flexps
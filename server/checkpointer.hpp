@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * Incremental, asynchronous checkpoints of a contiguous memory region owned by a dense storage.
+ *
+ * The region is split into blocks of block_bytes. The storage calls BeforeWrite() before it
+ * modifies a byte range, which marks the blocks dirty. Start() freezes the blocks dirtied since
+ * the previous checkpoint and writes them to a file from a background thread, so the server
+ * thread keeps serving Add/Get meanwhile: when it is about to modify a frozen block the writer has
+ * not reached yet, the block is copied first (copy-on-write) and the writer uses the copy.
+ *
+ * A checkpoint file holds only the blocks dirtied since the previous one. Restoring the files in
+ * the order they are taken, starting from the first checkpoint of a zero-initialized storage,
+ * rebuilds the region.
+ *
+ * BeforeWrite(), Start() and Restore() are called by the owning (server) thread only.
+ */
+class Checkpointer {
+ public:
+  static const size_t kDefaultBlockBytes = 64 << 10;
+
+  Checkpointer(char* base, size_t bytes, size_t block_bytes = kDefaultBlockBytes);
+  ~Checkpointer();
+  Checkpointer(const Checkpointer&) = delete;
+  Checkpointer& operator=(const Checkpointer&) = delete;
+
+  void BeforeWrite(size_t begin, size_t end) {
+    if (begin >= end)
+      return;
+    size_t last = (end - 1) / block_bytes_;
+    for (size_t block = begin / block_bytes_; block <= last; ++block) {
+      dirty_[block] = 1;
+      if (state_[block].load(std::memory_order_acquire) == kPending)
+        CopyOnWrite(block);
+    }
+  }
+
+  // Start writing the blocks dirtied since the last checkpoint to path, waits for the previous one first.
+  void Start(const std::string& path);
+  // Wait until the running checkpoint, if any, is on disk.
+  void Wait();
+  // Apply a checkpoint file to the region, the restored blocks are dirty for the next checkpoint.
+  void Restore(const std::string& path);
+
+  size_t NumDirtyBlocks() const;
+
+ private:
+  enum : uint8_t { kIdle, kPending, kCopied };
+
+  void CopyOnWrite(size_t block);
+  void WriteBlocks(const std::string& path, const std::vector<size_t>& blocks);
+  size_t BlockSize(size_t block) const;
+
+  char* const base_;  // not owned
+  const size_t bytes_;
+  const size_t block_bytes_;
+
+  // Blocks modified since the last Start()
+  std::vector<uint8_t> dirty_;
+  // kPending/kCopied for the blocks of the running checkpoint not written yet
+  std::unique_ptr<std::atomic<uint8_t>[]> state_;
+  // Protects copies_ and the transitions of state_ out of kPending
+  std::mutex mu_;
+  std::unordered_map<size_t, std::vector<char>> copies_;
+  std::thread writer_;
+};
+
+}  // namespace flexps
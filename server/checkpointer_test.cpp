@@ -0,0 +1,136 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/checkpointer.hpp"
+#include "server/vector_storage.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace flexps {
+namespace {
+
+class TestCheckpointer : public testing::Test {
+ public:
+  TestCheckpointer() {}
+  ~TestCheckpointer() {}
+
+ protected:
+  void SetUp() { prefix_ = "/tmp/flexps_checkpointer_test_" + std::to_string(getpid()); }
+  void TearDown() {
+    for (auto& path : paths_)
+      remove(path.c_str());
+  }
+
+  std::string Path(int i) {
+    paths_.push_back(prefix_ + "." + std::to_string(i));
+    return paths_.back();
+  }
+
+  std::string prefix_;
+  std::vector<std::string> paths_;
+};
+
+off_t FileSize(const std::string& path) {
+  struct stat st;
+  CHECK_EQ(stat(path.c_str(), &st), 0);
+  return st.st_size;
+}
+
+TEST_F(TestCheckpointer, Incremental) {
+  const size_t kBlock = 16;
+  std::vector<char> region(4 * kBlock, 0);
+  Checkpointer checkpointer(region.data(), region.size(), kBlock);
+
+  checkpointer.BeforeWrite(0, 3);
+  region[0] = 1;
+  region[2] = 2;
+  EXPECT_EQ(checkpointer.NumDirtyBlocks(), 1);
+  std::string path0 = Path(0);
+  checkpointer.Start(path0);
+  EXPECT_EQ(checkpointer.NumDirtyBlocks(), 0);
+
+  // Spans blocks 1 and 2
+  checkpointer.BeforeWrite(kBlock + 10, 2 * kBlock + 1);
+  region[kBlock + 10] = 3;
+  region[2 * kBlock] = 4;
+  std::string path1 = Path(1);
+  checkpointer.Start(path1);
+  std::string path2 = Path(2);
+  checkpointer.Start(path2);  // nothing changed
+  checkpointer.Wait();
+
+  EXPECT_LT(FileSize(path0), FileSize(path1));
+  EXPECT_LT(FileSize(path2), FileSize(path0));
+
+  std::vector<char> restored(region.size(), 0);
+  Checkpointer restorer(restored.data(), restored.size(), kBlock);
+  restorer.Restore(path0);
+  EXPECT_EQ(restored[0], 1);
+  EXPECT_EQ(restored[kBlock + 10], 0);
+  restorer.Restore(path1);
+  restorer.Restore(path2);
+  EXPECT_EQ(restored, region);
+  EXPECT_EQ(restorer.NumDirtyBlocks(), 3);
+}
+
+TEST_F(TestCheckpointer, WritesDuringCheckpoint) {
+  // The checkpoint holds the values at Start(), whether the writer or the copy-on-write gets a block first.
+  const size_t kBlock = 4096;
+  const size_t kNumBlocks = 256;
+  std::vector<int> region(kNumBlocks * kBlock / sizeof(int), 0);
+  char* base = reinterpret_cast<char*>(region.data());
+  Checkpointer checkpointer(base, region.size() * sizeof(int), kBlock);
+  for (size_t i = 0; i < region.size(); ++i) {
+    checkpointer.BeforeWrite(i * sizeof(int), (i + 1) * sizeof(int));
+    region[i] = i;
+  }
+  std::string path0 = Path(0);
+  checkpointer.Start(path0);
+  for (int round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < region.size(); ++i) {
+      checkpointer.BeforeWrite(i * sizeof(int), (i + 1) * sizeof(int));
+      region[i] += 1;
+    }
+  }
+  std::string path1 = Path(1);
+  checkpointer.Start(path1);
+  checkpointer.Wait();
+
+  std::vector<int> restored(region.size(), 0);
+  Checkpointer restorer(reinterpret_cast<char*>(restored.data()), restored.size() * sizeof(int), kBlock);
+  restorer.Restore(path0);
+  for (size_t i = 0; i < restored.size(); ++i)
+    ASSERT_EQ(restored[i], i);
+  restorer.Restore(path1);
+  EXPECT_EQ(restored, region);
+}
+
+TEST_F(TestCheckpointer, VectorStorage) {
+  VectorStorage<float> s({10, 100000});
+  third_party::SArray<Key> keys({10, 11, 50000, 99999});
+  third_party::SArray<float> vals({1, 2, 3, 4});
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  std::string path0 = Path(0);
+  s.Checkpoint(path0);
+  s.SubAdd(third_party::SArray<Key>({11}), third_party::SArray<char>(third_party::SArray<float>({5})));
+  std::string path1 = Path(1);
+  s.Checkpoint(path1);
+  s.WaitCheckpoint();
+
+  VectorStorage<float> restored({10, 100000});
+  restored.Restore(path0);
+  restored.Restore(path1);
+  third_party::SArray<float> ret(restored.SubGet(keys));
+  EXPECT_EQ(ret[0], 1);
+  EXPECT_EQ(ret[1], 7);
+  EXPECT_EQ(ret[2], 3);
+  EXPECT_EQ(ret[3], 4);
+}
+
+}  // namespace
+}  // namespace flexps
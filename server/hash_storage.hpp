@@ -0,0 +1,230 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "server/abstract_storage.hpp"
+#include "server/initializer.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * A flat open-addressing (linear probing) hash storage for sparse tables.
+ *
+ * Keys, occupancy flags and values live in contiguous arrays, so a lookup is a hash plus a short
+ * sequential probe instead of the tree walk and node allocation of std::map.
+ *
+ * Values are stored in rows of chunk_size_: the row of chunk key k holds the elements
+ * [k * chunk_size_, (k + 1) * chunk_size_), so SubAddChunk/SubGetChunk probe once per chunk and
+ * SubAdd/SubGet address element k at row k / chunk_size_, column k % chunk_size_. This keeps the
+ * same key semantics as MapStorage.
+ *
+ * A row is filled with init_ of its element keys when it is inserted; Gets of absent keys return
+ * init_(key) without inserting.
+ */
+template <typename Val, typename Init = Initializer<Val>>
+class HashStorage : public AbstractStorage {
+ public:
+  static const size_t kDefaultCapacity = 1024;
+
+  HashStorage(uint32_t chunk_size = 1, size_t init_capacity = kDefaultCapacity, Init init = Init())
+      : chunk_size_(chunk_size), init_(init) {
+    CHECK_GT(chunk_size_, 0);
+    size_t capacity = kMinCapacity;
+    while (capacity < init_capacity)
+      capacity <<= 1;
+    Rehash(capacity);
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size(), typed_vals.size());
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      Val* row = FindOrInsert(typed_keys[i] / chunk_size_);
+      row[typed_keys[i] % chunk_size_] += typed_vals[i];
+    }
+  }
+
+  virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_vals.size()/typed_keys.size(), chunk_size_);
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      Val* row = FindOrInsert(typed_keys[i]);
+      const Val* src = typed_vals.data() + i * chunk_size_;
+      for (size_t j = 0; j < chunk_size_; j++)
+        row[j] += src[j];
+    }
+  }
+
+  // Absent keys are read as init_(key) and are not inserted.
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size());
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      const Val* row = Find(typed_keys[i] / chunk_size_);
+      reply_vals[i] = row ? row[typed_keys[i] % chunk_size_] : init_(typed_keys[i]);
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size() * chunk_size_);
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      const Val* row = Find(typed_keys[i]);
+      Val* dst = reply_vals.data() + i * chunk_size_;
+      for (size_t j = 0; j < chunk_size_; j++)
+        dst[j] = row ? row[j] : init_(typed_keys[i] * chunk_size_ + j);
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual void FinishIter() override {}
+
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>(chunk_size_));
+  }
+
+  // Add the rows to target in key order, by SubAdd if chunk_size_ is 1 and SubAddChunk otherwise.
+  // The rows are dropped, the capacity is kept.
+  virtual void FlushTo(AbstractStorage* target) override {
+    if (size_ == 0)
+      return;
+    std::vector<size_t> slots;
+    slots.reserve(size_);
+    for (size_t pos = 0; pos < keys_.size(); pos++) {
+      if (used_[pos])
+        slots.push_back(pos);
+    }
+    std::sort(slots.begin(), slots.end(), [this](size_t a, size_t b) { return keys_[a] < keys_[b]; });
+    third_party::SArray<Key> row_keys(slots.size());
+    third_party::SArray<Val> vals(new Val[slots.size() * chunk_size_], slots.size() * chunk_size_, true);
+    for (size_t i = 0; i < slots.size(); i++) {
+      row_keys[i] = keys_[slots[i]];
+      std::copy(vals_.begin() + slots[i] * chunk_size_, vals_.begin() + (slots[i] + 1) * chunk_size_,
+                vals.begin() + i * chunk_size_);
+    }
+    if (chunk_size_ == 1)
+      target->SubAdd(row_keys, third_party::SArray<char>(vals));
+    else
+      target->SubAddChunk(row_keys, third_party::SArray<char>(vals));
+    std::fill(used_.begin(), used_.end(), 0);
+    size_ = 0;
+  }
+
+  // Number of rows (chunks) materialized in the table.
+  size_t Size() const { return size_; }
+  size_t Capacity() const { return keys_.size(); }
+
+  // Remove the rows (chunk keys) row_keys, absent ones are skipped. The capacity is kept.
+  void Erase(const std::vector<Key>& row_keys) {
+    for (Key row_key : row_keys)
+      EraseRow(row_key);
+  }
+
+ private:
+  static const size_t kMinCapacity = 16;
+
+  size_t Slot(Key key) const {
+    // Fibonacci hashing, the high bits of the product are the best mixed.
+    return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> shift_);
+  }
+
+  const Val* Find(Key key) const {
+    size_t mask = keys_.size() - 1;
+    for (size_t pos = Slot(key);; pos = (pos + 1) & mask) {
+      if (!used_[pos])
+        return nullptr;
+      if (keys_[pos] == key)
+        return vals_.data() + pos * chunk_size_;
+    }
+  }
+
+  // Find the row of key, inserting it with its initial values if absent.
+  Val* FindOrInsert(Key key) {
+    bool inserted;
+    Val* row = FindOrInsertRaw(key, &inserted);
+    if (inserted) {
+      for (size_t j = 0; j < chunk_size_; j++)
+        row[j] = init_(key * chunk_size_ + j);
+    }
+    return row;
+  }
+
+  // Find the row of key, inserting it without initializing the values if absent.
+  Val* FindOrInsertRaw(Key key, bool* inserted) {
+    // Keep the load factor under 0.7 so that probe sequences stay short.
+    if ((size_ + 1) * 10 > keys_.size() * 7)
+      Rehash(keys_.size() * 2);
+    size_t mask = keys_.size() - 1;
+    size_t pos = Slot(key);
+    while (used_[pos] && keys_[pos] != key)
+      pos = (pos + 1) & mask;
+    *inserted = !used_[pos];
+    if (*inserted) {
+      used_[pos] = 1;
+      keys_[pos] = key;
+      size_ += 1;
+    }
+    return vals_.data() + pos * chunk_size_;
+  }
+
+  /*
+   * Backward-shift deletion, no tombstones: the rows after the hole in its probe cluster move into
+   * the hole unless their home slot lies after it, so every probe sequence stays unbroken.
+   */
+  void EraseRow(Key key) {
+    size_t mask = keys_.size() - 1;
+    size_t pos = Slot(key);
+    while (used_[pos] && keys_[pos] != key)
+      pos = (pos + 1) & mask;
+    if (!used_[pos])
+      return;
+    size_t hole = pos;
+    for (size_t next = (hole + 1) & mask; used_[next]; next = (next + 1) & mask) {
+      size_t home = Slot(keys_[next]);
+      if (((next - home) & mask) >= ((next - hole) & mask)) {
+        keys_[hole] = keys_[next];
+        std::copy(vals_.begin() + next * chunk_size_, vals_.begin() + (next + 1) * chunk_size_,
+                  vals_.begin() + hole * chunk_size_);
+        hole = next;
+      }
+    }
+    used_[hole] = 0;
+    size_ -= 1;
+  }
+
+  void Rehash(size_t new_capacity) {
+    std::vector<Key> old_keys(new_capacity);
+    std::vector<uint8_t> old_used(new_capacity, 0);
+    std::vector<Val> old_vals(new_capacity * chunk_size_, Val());
+    old_keys.swap(keys_);
+    old_used.swap(used_);
+    old_vals.swap(vals_);
+    shift_ = 64;
+    for (size_t c = new_capacity; c > 1; c >>= 1)
+      shift_ -= 1;
+    size_ = 0;
+    for (size_t i = 0; i < old_keys.size(); i++) {
+      if (!old_used[i])
+        continue;
+      bool inserted;
+      Val* row = FindOrInsertRaw(old_keys[i], &inserted);
+      std::copy(old_vals.begin() + i * chunk_size_, old_vals.begin() + (i + 1) * chunk_size_, row);
+    }
+  }
+
+  std::vector<Key> keys_;
+  std::vector<uint8_t> used_;
+  std::vector<Val> vals_;
+  size_t size_ = 0;
+  uint32_t shift_ = 64;
+  uint32_t chunk_size_;
+  Init init_;
+};
+
+}  // namespace flexps
@@ -0,0 +1,195 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/hash_storage.hpp"
+
+namespace flexps {
+namespace {
+
+class TestHashStorage : public testing::Test {
+ public:
+  TestHashStorage() {}
+  ~TestHashStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestHashStorage, AddGetInt) {
+  HashStorage<int> s;
+
+  Message m;
+  third_party::SArray<Key> s_keys({13, 14, 15});
+  third_party::SArray<int> s_vals({1, 2, 3});
+  m.AddData(s_keys);
+  m.AddData(s_vals);
+  s.Add(m);
+
+  Message m2;
+  m2.AddData(s_keys);
+  Message rep = s.Get(m2);
+
+  EXPECT_EQ(rep.data.size(), 2);
+  auto rep_keys = third_party::SArray<Key>(rep.data[0]);
+  auto rep_vals = third_party::SArray<int>(rep.data[1]);
+  for (int index = 0; index < s_keys.size(); index++) {
+    EXPECT_EQ(rep_keys[index], s_keys[index]);
+    EXPECT_EQ(rep_vals[index], s_vals[index]);
+  }
+}
+
+TEST_F(TestHashStorage, SubAddSubGet) {
+  HashStorage<float> s;
+
+  third_party::SArray<Key> s_keys({13, 14, 15});
+  third_party::SArray<float> s_vals({0.1, 0.2, 0.3});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  for (int i = 0; i < s_keys.size(); ++ i) {
+    EXPECT_EQ(ret[i], s_vals[i] * 2);
+  }
+}
+
+TEST_F(TestHashStorage, GetAbsentKey) {
+  HashStorage<float> s;
+
+  third_party::SArray<Key> s_keys({7, 8});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 0);
+  EXPECT_EQ(ret[1], 0);
+  EXPECT_EQ(s.Size(), 0);
+}
+
+TEST_F(TestHashStorage, Grow) {
+  HashStorage<int> s(1, 16);
+
+  const int kNumKeys = 10000;
+  third_party::SArray<Key> s_keys(kNumKeys);
+  third_party::SArray<int> s_vals(kNumKeys);
+  for (int i = 0; i < kNumKeys; ++ i) {
+    s_keys[i] = i * 7919;
+    s_vals[i] = i;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  EXPECT_EQ(s.Size(), kNumKeys);
+  EXPECT_GE(s.Capacity(), kNumKeys);
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(s_keys));
+  for (int i = 0; i < kNumKeys; ++ i) {
+    EXPECT_EQ(ret[i], s_vals[i]);
+  }
+}
+
+TEST_F(TestHashStorage, SubAddChunkSubGetChunk) {
+  HashStorage<float> s(10);
+
+  third_party::SArray<Key> s_keys({1, 2});
+  third_party::SArray<float> s_vals(20);
+  for (int i = 0; i < 20; i++) {
+    s_vals[i] = i / 10.0;
+  }
+  s.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int i = 0; i < s_vals.size(); ++ i) {
+    EXPECT_EQ(ret[i], s_vals[i]);
+  }
+  // The element keys of chunk 2 are [20, 30)
+  third_party::SArray<Key> elem_keys({20, 25});
+  ret = third_party::SArray<float>(s.SubGet(elem_keys));
+  EXPECT_EQ(ret[0], s_vals[10]);
+  EXPECT_EQ(ret[1], s_vals[15]);
+}
+
+TEST_F(TestHashStorage, Initializer) {
+  InitializerConfig config;
+  config.type = InitType::Constant;
+  config.constant = 1.5;
+  HashStorage<float> s(1, 16, Initializer<float>(config));
+
+  // Absent keys are read as the initial value and are not inserted.
+  third_party::SArray<Key> s_keys({3, 7});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1.5);
+  EXPECT_EQ(ret[1], 1.5);
+  EXPECT_EQ(s.Size(), 0);
+
+  // The first Add starts from the initial value.
+  third_party::SArray<Key> add_keys({7});
+  third_party::SArray<float> add_vals({0.25});
+  s.SubAdd(add_keys, third_party::SArray<char>(add_vals));
+  ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1.5);
+  EXPECT_EQ(ret[1], 1.75);
+  EXPECT_EQ(s.Size(), 1);
+}
+
+TEST_F(TestHashStorage, InitializerChunk) {
+  InitializerConfig config;
+  config.type = InitType::Uniform;
+  config.seed = 3;
+  Initializer<float> init(config);
+  HashStorage<float> s(4, 16, init);
+
+  // A chunk reads init of its element keys before and after the first Add.
+  third_party::SArray<Key> s_keys({2});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int j = 0; j < 4; ++ j) {
+    EXPECT_EQ(ret[j], init(8 + j));
+  }
+  third_party::SArray<float> s_vals({1, 1, 1, 1});
+  s.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int j = 0; j < 4; ++ j) {
+    EXPECT_EQ(ret[j], init(8 + j) + 1);
+  }
+}
+
+TEST_F(TestHashStorage, Erase) {
+  HashStorage<int> s(1, 16);
+  const int kNumKeys = 1000;
+  third_party::SArray<Key> s_keys(kNumKeys);
+  third_party::SArray<int> s_vals(kNumKeys);
+  for (int i = 0; i < kNumKeys; ++ i) {
+    s_keys[i] = i * 7;
+    s_vals[i] = i + 1;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+
+  // Erase every other key and one absent key.
+  std::vector<Key> erased;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    erased.push_back(i * 7);
+  }
+  erased.push_back(kNumKeys * 7);
+  s.Erase(erased);
+  EXPECT_EQ(s.Size(), kNumKeys / 2);
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(s_keys));
+  for (int i = 0; i < kNumKeys; ++ i) {
+    EXPECT_EQ(ret[i], i % 2 ? s_vals[i] : 0);
+  }
+}
+
+TEST_F(TestHashStorage, FlushTo) {
+  HashStorage<int> delta(2);
+  HashStorage<int> target(2);
+  third_party::SArray<Key> s_keys({9, 3});
+  third_party::SArray<int> s_vals({1, 2, 3, 4});
+  delta.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  delta.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  target.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+
+  delta.FlushTo(&target);
+  EXPECT_EQ(delta.Size(), 0);
+  auto ret = third_party::SArray<int>(target.SubGetChunk(s_keys));
+  for (int i = 0; i < 4; ++ i) {
+    EXPECT_EQ(ret[i], 3 * s_vals[i]);
+  }
+  // Nothing is left to flush.
+  delta.FlushTo(&target);
+  ret = third_party::SArray<int>(target.SubGetChunk(s_keys));
+  EXPECT_EQ(ret[0], 3);
+}
+
+}  // namespace
+}  // namespace flexps
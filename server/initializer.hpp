@@ -0,0 +1,78 @@
+#pragma once
+
+#include "base/magic.hpp"
+
+#include "glog/logging.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace flexps {
+
+enum class InitType { Zero, Constant, Uniform, Normal };
+
+struct InitializerConfig {
+  InitType type = InitType::Zero;
+  double constant = 0;  // Constant
+  double low = 0;       // Uniform in [low, high)
+  double high = 1;
+  double mean = 0;      // Normal
+  double stddev = 1;
+  uint64_t seed = 0;    // Uniform and Normal
+};
+
+/*
+ * The value a key of a sparse storage (MapStorage, HashStorage, SortedStorage) has before its first
+ * write. The storages apply it when a key is first added to, and compute it on the fly for a Get of
+ * an absent key without inserting it, so read-only traffic does not grow the table.
+ *
+ * The random initializers derive the value from a hash of (seed, key), so a key reads the same value
+ * before and at its first write, on every server and in every run with the same seed.
+ *
+ * Any functor with `Val operator()(Key key) const` can be plugged into the storages instead.
+ */
+template <typename Val>
+class Initializer {
+ public:
+  explicit Initializer(const InitializerConfig& config = InitializerConfig()) : config_(config) {
+    if (config_.type == InitType::Uniform)
+      CHECK_LT(config_.low, config_.high);
+    if (config_.type == InitType::Normal)
+      CHECK_GE(config_.stddev, 0);
+  }
+
+  Val operator()(Key key) const {
+    switch (config_.type) {
+    case InitType::Zero:
+      return Val();
+    case InitType::Constant:
+      return static_cast<Val>(config_.constant);
+    case InitType::Uniform:
+      return static_cast<Val>(config_.low + (config_.high - config_.low) * Uniform(key, 0));
+    case InitType::Normal: {
+      // Box-Muller, 1 - u is in (0, 1] so that the log is finite.
+      double u1 = 1 - Uniform(key, 0);
+      double u2 = Uniform(key, 1);
+      const double kTwoPi = 6.283185307179586;
+      return static_cast<Val>(config_.mean + config_.stddev * std::sqrt(-2 * std::log(u1)) * std::cos(kTwoPi * u2));
+    }
+    }
+    return Val();
+  }
+
+  bool IsZero() const { return config_.type == InitType::Zero; }
+
+ private:
+  // A uniform double in [0, 1) from the stream-th hash of (seed, key), splitmix64.
+  double Uniform(Key key, uint64_t stream) const {
+    uint64_t x = config_.seed + static_cast<uint64_t>(key) * 2 + stream + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return (x >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  InitializerConfig config_;
+};
+
+}  // namespace flexps
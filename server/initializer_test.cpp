@@ -0,0 +1,84 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/initializer.hpp"
+
+#include <cmath>
+
+namespace flexps {
+namespace {
+
+class TestInitializer : public testing::Test {
+ public:
+  TestInitializer() {}
+  ~TestInitializer() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestInitializer, ZeroConstant) {
+  Initializer<float> zero;
+  EXPECT_TRUE(zero.IsZero());
+  EXPECT_EQ(zero(0), 0);
+  EXPECT_EQ(zero(12345), 0);
+
+  InitializerConfig config;
+  config.type = InitType::Constant;
+  config.constant = 0.5;
+  Initializer<float> constant(config);
+  EXPECT_FALSE(constant.IsZero());
+  EXPECT_EQ(constant(0), 0.5);
+  EXPECT_EQ(constant(12345), 0.5);
+}
+
+TEST_F(TestInitializer, Uniform) {
+  InitializerConfig config;
+  config.type = InitType::Uniform;
+  config.low = -0.1;
+  config.high = 0.1;
+  config.seed = 7;
+  Initializer<double> init(config);
+  Initializer<double> same(config);
+  config.seed = 8;
+  Initializer<double> other(config);
+
+  const int kNumKeys = 10000;
+  double sum = 0;
+  int num_diff = 0;
+  for (int i = 0; i < kNumKeys; ++ i) {
+    double val = init(i);
+    EXPECT_GE(val, -0.1);
+    EXPECT_LT(val, 0.1);
+    EXPECT_EQ(val, same(i));
+    num_diff += val != other(i);
+    sum += val;
+  }
+  EXPECT_NEAR(sum / kNumKeys, 0, 0.005);
+  EXPECT_GT(num_diff, kNumKeys * 0.99);
+}
+
+TEST_F(TestInitializer, Normal) {
+  InitializerConfig config;
+  config.type = InitType::Normal;
+  config.mean = 1;
+  config.stddev = 0.5;
+  Initializer<double> init(config);
+
+  const int kNumKeys = 100000;
+  double sum = 0, sum_sq = 0;
+  for (int i = 0; i < kNumKeys; ++ i) {
+    double val = init(i);
+    ASSERT_TRUE(std::isfinite(val));
+    EXPECT_EQ(val, init(i));
+    sum += val;
+    sum_sq += val * val;
+  }
+  double mean = sum / kNumKeys;
+  EXPECT_NEAR(mean, 1, 0.01);
+  EXPECT_NEAR(std::sqrt(sum_sq / kNumKeys - mean * mean), 0.5, 0.01);
+}
+
+}  // namespace
+}  // namespace flexps
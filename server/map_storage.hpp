@@ -2,23 +2,30 @@
 
 #include "base/message.hpp"
 #include "server/abstract_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/initializer.hpp"
 
 #include "glog/logging.h"
 
 #include <map>
+#include <vector>
 
 namespace flexps {
 
-template <typename Val>
+/*
+ * A key takes the value of init_ on its first Add. A Get of an absent key returns init_(key) and
+ * does not insert it.
+ */
+template <typename Val, typename Init = Initializer<Val>>
 class MapStorage : public AbstractStorage {
  public:
-  MapStorage(uint32_t chunk_size = 1): chunk_size_(chunk_size) {}
+  MapStorage(uint32_t chunk_size = 1, Init init = Init()) : chunk_size_(chunk_size), init_(init) {}
 
   virtual void SubAdd(const third_party::SArray<Key>& typed_keys, 
       const third_party::SArray<char>& vals) override {
     auto typed_vals = third_party::SArray<Val>(vals);
     for (size_t i = 0; i < typed_keys.size(); i++)
-      storage_[typed_keys[i]] += typed_vals[i];
+      FindOrInsert(typed_keys[i]) += typed_vals[i];
   }
 
   virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys, 
@@ -27,13 +34,13 @@ class MapStorage : public AbstractStorage {
     CHECK_EQ(typed_vals.size()/typed_keys.size(), chunk_size_);
     for (size_t i = 0; i < typed_keys.size(); i++)
       for (size_t j = 0; j < chunk_size_; j++)
-        storage_[typed_keys[i] * chunk_size_ + j] += typed_vals[i * chunk_size_ + j];
+        FindOrInsert(typed_keys[i] * chunk_size_ + j) += typed_vals[i * chunk_size_ + j];
   }
 
   virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
     third_party::SArray<Val> reply_vals(typed_keys.size());
     for (size_t i = 0; i < typed_keys.size(); i++)
-      reply_vals[i] = storage_[typed_keys[i]];
+      reply_vals[i] = Find(typed_keys[i]);
     return third_party::SArray<char>(reply_vals);
   }
 
@@ -41,16 +48,49 @@ class MapStorage : public AbstractStorage {
     third_party::SArray<Val> reply_vals(typed_keys.size() * chunk_size_);
     for (int i = 0; i < typed_keys.size(); i++) 
       for (int j = 0; j < chunk_size_; j++)
-        reply_vals[i * chunk_size_ + j] = storage_[typed_keys[i] * chunk_size_ + j];
+        reply_vals[i * chunk_size_ + j] = Find(typed_keys[i] * chunk_size_ + j);
     return third_party::SArray<char>(reply_vals);
   }
 
 
   virtual void FinishIter() override {}
 
+  // A tree walk per key
+  virtual bool UnionGets() const override { return true; }
+
+  // The delta is flushed by element keys, a chunked delta would materialize whole chunks here.
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    if (chunk_size_ != 1)
+      return nullptr;
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>());
+  }
+
+  // Number of keys materialized in the table.
+  size_t Size() const { return storage_.size(); }
+
+  // Remove the elements of the rows (chunk keys) row_keys, absent ones are skipped.
+  void Erase(const std::vector<Key>& row_keys) {
+    for (Key row_key : row_keys)
+      for (size_t j = 0; j < chunk_size_; j++)
+        storage_.erase(row_key * chunk_size_ + j);
+  }
+
  private:
+  Val& FindOrInsert(Key key) {
+    auto it = storage_.lower_bound(key);
+    if (it == storage_.end() || it->first != key)
+      it = storage_.emplace_hint(it, key, init_(key));
+    return it->second;
+  }
+
+  Val Find(Key key) const {
+    auto it = storage_.find(key);
+    return it == storage_.end() ? init_(key) : it->second;
+  }
+
   std::map<Key, Val> storage_;
   uint32_t chunk_size_;
+  Init init_;
 };
 
 }  // namespace flexps
@@ -90,5 +90,110 @@ TEST_F(TestMapStorage, SubAddChunkSubGetChunk) {
 }
 
 
+TEST_F(TestMapStorage, Initializer) {
+  InitializerConfig config;
+  config.type = InitType::Constant;
+  config.constant = 1.5;
+  MapStorage<float> s(1, Initializer<float>(config));
+
+  // Absent keys are read as the initial value and are not inserted.
+  third_party::SArray<Key> s_keys({3, 7});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1.5);
+  EXPECT_EQ(ret[1], 1.5);
+  EXPECT_EQ(s.Size(), 0);
+
+  // The first Add starts from the initial value.
+  third_party::SArray<Key> add_keys({7});
+  third_party::SArray<float> add_vals({0.25});
+  s.SubAdd(add_keys, third_party::SArray<char>(add_vals));
+  ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1.5);
+  EXPECT_EQ(ret[1], 1.75);
+  EXPECT_EQ(s.Size(), 1);
+}
+
+TEST_F(TestMapStorage, InitializerChunk) {
+  InitializerConfig config;
+  config.type = InitType::Uniform;
+  config.seed = 3;
+  Initializer<float> init(config);
+  MapStorage<float> s(4, init);
+
+  // A chunk reads init of its element keys before and after the first Add.
+  third_party::SArray<Key> s_keys({2});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int j = 0; j < 4; ++ j) {
+    EXPECT_EQ(ret[j], init(8 + j));
+  }
+  third_party::SArray<float> s_vals({1, 1, 1, 1});
+  s.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int j = 0; j < 4; ++ j) {
+    EXPECT_EQ(ret[j], init(8 + j) + 1);
+  }
+}
+
+TEST_F(TestMapStorage, Erase) {
+  MapStorage<int> s;
+  const int kNumKeys = 1000;
+  third_party::SArray<Key> s_keys(kNumKeys);
+  third_party::SArray<int> s_vals(kNumKeys);
+  for (int i = 0; i < kNumKeys; ++ i) {
+    s_keys[i] = i * 7;
+    s_vals[i] = i + 1;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+
+  // Erase every other key and one absent key.
+  std::vector<Key> erased;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    erased.push_back(i * 7);
+  }
+  erased.push_back(kNumKeys * 7);
+  s.Erase(erased);
+  EXPECT_EQ(s.Size(), kNumKeys / 2);
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(s_keys));
+  for (int i = 0; i < kNumKeys; ++ i) {
+    EXPECT_EQ(ret[i], i % 2 ? s_vals[i] : 0);
+  }
+}
+
+TEST_F(TestMapStorage, AddGetRange) {
+  MapStorage<float> s;
+
+  // Keys 12-15 and 18, as [first, last] runs.
+  third_party::SArray<Key> ranges({12, 15, 18, 18});
+  third_party::SArray<float> s_vals({0.5, 1.5, 2.5, 3.5, 4.5});
+  Message m;
+  m.meta.flag = Flag::kAddRange;
+  m.AddData(ranges);
+  m.AddData(s_vals);
+  s.Add(m);
+  s.Add(m);
+
+  Message m2;
+  m2.meta.flag = Flag::kGetRange;
+  m2.AddData(ranges);
+  Message rep = s.Get(m2);
+  EXPECT_EQ(rep.meta.flag, Flag::kGetRangeReply);
+  ASSERT_EQ(rep.data.size(), 2);
+  auto rep_ranges = third_party::SArray<Key>(rep.data[0]);
+  auto rep_vals = third_party::SArray<float>(rep.data[1]);
+  ASSERT_EQ(rep_ranges.size(), ranges.size());
+  ASSERT_EQ(rep_vals.size(), s_vals.size());
+  for (int i = 0; i < s_vals.size(); ++ i) {
+    EXPECT_EQ(rep_vals[i], 2 * s_vals[i]);
+  }
+
+  // The keyed path reads the same values.
+  third_party::SArray<Key> s_keys({12, 15, 16, 18});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1);
+  EXPECT_EQ(ret[1], 7);
+  EXPECT_EQ(ret[2], 0);
+  EXPECT_EQ(ret[3], 9);
+}
+
 }  // namespace
 }  // namespace flexps
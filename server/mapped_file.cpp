@@ -0,0 +1,44 @@
+#include "server/mapped_file.hpp"
+
+#include "glog/logging.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace flexps {
+
+MappedFile::MappedFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "open " << path << ": " << strerror(errno);
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "fstat " << path << ": " << strerror(errno);
+  size_ = st.st_size;
+  if (size_ > 0) {
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    CHECK(addr != MAP_FAILED) << "mmap " << path << ": " << strerror(errno);
+    data_ = static_cast<const char*>(addr);
+    madvise(addr, size_, MADV_SEQUENTIAL);
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_)
+    munmap(const_cast<char*>(data_), size_);
+}
+
+void MappedFile::WillNeed(size_t offset, size_t len) const {
+  if (len == 0)
+    return;
+  CHECK_LE(offset + len, size_);
+  static const size_t kPageSize = sysconf(_SC_PAGESIZE);
+  size_t start = offset / kPageSize * kPageSize;
+  madvise(const_cast<char*>(data_) + start, offset + len - start, MADV_WILLNEED);
+}
+
+}  // namespace flexps
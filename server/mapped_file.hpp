@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace flexps {
+
+/*
+ * A read-only memory mapping of a whole file, so that the bytes of a file are copied straight from
+ * the page cache without read() calls or parsing.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Start reading [offset, offset + len) ahead, sequentially.
+  void WillNeed(size_t offset, size_t len) const;
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace flexps
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "base/key_ranges.hpp"
+#include "base/message.hpp"
+#include "base/third_party/range.h"
+#include "server/abstract_storage.hpp"
+#include "server/checkpointer.hpp"
+#include "server/hash_storage.hpp"
+#include "server/mapped_file.hpp"
+#include "server/simd_kernels.hpp"
+
+#include "glog/logging.h"
+
+#include <fcntl.h>
+#include <linux/magic.h>
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * A dense storage like VectorStorage whose values live in a memory-mapped file instead of the heap,
+ * so that a server can hold a range larger than its RAM.
+ *
+ * The file is created sparse (ftruncate) and mapped MAP_SHARED: untouched keys take neither memory
+ * nor disk, and the kernel can write dirty pages back to the file and drop them under memory
+ * pressure instead of the process getting OOM-killed. The file is unlinked right after it is
+ * opened, so it goes away with the storage (or the process). On tmpfs the pages have nowhere to go
+ * but swap, so a warning is logged.
+ *
+ * Paging is steered with madvise from the observed access pattern:
+ * - the mapping starts as MADV_RANDOM, since sparse requests gain nothing from readahead;
+ * - a run of consecutive keys spanning at least a region is prefetched with MADV_WILLNEED;
+ * - regions (kRegionBytes) not accessed for kColdEpochs epochs are marked MADV_COLD (Linux >= 5.4)
+ *   so that they are reclaimed before the hot ones. An epoch ends on FinishIter, or after
+ *   kEpochRequests requests when the min clock stalls, e.g. on an ASP table with a slow worker.
+ *
+ * Checkpoint() works as in VectorStorage, the checkpoint files are separate from the backing file.
+ */
+template <typename Val>
+class MmapStorage : public AbstractStorage {
+ public:
+  static const size_t kRegionBytes = 2 << 20;
+  static const uint32_t kColdEpochs = 2;
+  static const uint32_t kEpochRequests = 1 << 12;
+
+  MmapStorage() = delete;
+  /*
+   * The storage is in charge of range [range.begin(), range.end()), backed by a file at path.
+   */
+  MmapStorage(third_party::Range range, const std::string& path, uint32_t chunk_size = 1)
+      : range_(range), chunk_size_(chunk_size) {
+    CHECK_LE(range_.begin(), range_.end());
+    bytes_ = std::max<size_t>(range_.size() * sizeof(Val), 1);
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    CHECK_GE(fd, 0) << "open " << path << ": " << strerror(errno);
+    struct statfs fs;
+    if (fstatfs(fd, &fs) == 0 && fs.f_type == TMPFS_MAGIC)
+      LOG(WARNING) << path << " is on tmpfs, the storage cannot hold more than RAM and swap";
+    CHECK_EQ(unlink(path.c_str()), 0) << "unlink " << path << ": " << strerror(errno);
+    CHECK_EQ(ftruncate(fd, bytes_), 0) << "ftruncate " << path << ": " << strerror(errno);
+    void* addr = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    CHECK(addr != MAP_FAILED) << "mmap " << path << ": " << strerror(errno);
+    close(fd);
+    data_ = static_cast<Val*>(addr);
+    madvise(data_, bytes_, MADV_RANDOM);
+    last_access_.resize((bytes_ + kRegionBytes - 1) / kRegionBytes, 0);
+    checkpointer_.reset(new Checkpointer(reinterpret_cast<char*>(data_), bytes_));
+  }
+
+  MmapStorage(const MmapStorage&) = delete;
+  MmapStorage& operator=(const MmapStorage&) = delete;
+
+  ~MmapStorage() {
+    // The writer of a running checkpoint reads the mapping.
+    checkpointer_.reset();
+    munmap(data_, bytes_);
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size(), typed_vals.size());
+    CheckKeysInRange(typed_keys, range_);
+    CountRequest();
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      AddTo(TouchForWrite(typed_keys[begin] - range_.begin(), len), typed_vals.data() + begin, len);
+    });
+  }
+
+  virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_vals.size()/typed_keys.size(), chunk_size_);
+    CheckKeysInRange(typed_keys, range_, chunk_size_);
+    CountRequest();
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      AddTo(TouchForWrite(typed_keys[begin] * chunk_size_ - range_.begin(), len * chunk_size_),
+            typed_vals.data() + begin * chunk_size_, len * chunk_size_);
+    });
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(new Val[typed_keys.size()], typed_keys.size(), true);
+    CheckKeysInRange(typed_keys, range_);
+    CountRequest();
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      CopyTo(reply_vals.data() + begin, Touch(typed_keys[begin] - range_.begin(), len), len);
+    });
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(new Val[typed_keys.size() * chunk_size_], typed_keys.size() * chunk_size_, true);
+    CheckKeysInRange(typed_keys, range_, chunk_size_);
+    CountRequest();
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      CopyTo(reply_vals.data() + begin * chunk_size_,
+             Touch(typed_keys[begin] * chunk_size_ - range_.begin(), len * chunk_size_), len * chunk_size_);
+    });
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual void SubAddRange(const third_party::SArray<Key>& ranges, const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(NumKeysInRanges(ranges), typed_vals.size());
+    CheckKeyRangesInRange(ranges, range_);
+    CountRequest();
+    ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+      AddTo(TouchForWrite(first - range_.begin(), len), typed_vals.data() + pos, len);
+    });
+  }
+
+  virtual third_party::SArray<char> SubGetRange(const third_party::SArray<Key>& ranges) override {
+    size_t num_keys = NumKeysInRanges(ranges);
+    third_party::SArray<Val> reply_vals(new Val[num_keys], num_keys, true);
+    CheckKeyRangesInRange(ranges, range_);
+    CountRequest();
+    ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+      CopyTo(reply_vals.data() + pos, Touch(first - range_.begin(), len), len);
+    });
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  // Hashed, a dense delta would take the RAM this storage is meant to save.
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>(chunk_size_));
+  }
+
+  virtual void FinishIter() override { FinishEpoch(); }
+
+  virtual void Checkpoint(const std::string& path) override { checkpointer_->Start(path); }
+  virtual void Restore(const std::string& path) override { checkpointer_->Restore(path); }
+
+  virtual void LoadRange(const std::string& path) override {
+    MappedFile file(path);
+    size_t offset = range_.begin() * sizeof(Val);
+    size_t bytes = range_.size() * sizeof(Val);
+    CHECK_GE(file.size(), offset + bytes) << path << " does not cover the range [" << range_.begin() << ", "
+                                          << range_.end() << ")";
+    file.WillNeed(offset, bytes);
+    if (bytes > 0)
+      memcpy(TouchForWrite(0, range_.size()), file.data() + offset, bytes);
+  }
+  // Wait until the running checkpoint is on disk.
+  void WaitCheckpoint() { checkpointer_->Wait(); }
+  uint32_t GetEpoch() const { return epoch_; }
+
+  Key GetBegin() { return range_.begin(); }
+  Key GetEnd() { return range_.end(); }
+  size_t Size() const { return range_.size(); }
+
+ private:
+  void FinishEpoch() {
+    epoch_ += 1;
+    num_requests_ = 0;
+#ifdef MADV_COLD
+    // Hint once, when a region has just become cold.
+    for (size_t r = 0; r < last_access_.size(); ++r) {
+      if (last_access_[r] + kColdEpochs == epoch_) {
+        size_t len = bytes_ - r * kRegionBytes;
+        if (len > kRegionBytes)
+          len = kRegionBytes;
+        madvise(reinterpret_cast<char*>(data_) + r * kRegionBytes, len, MADV_COLD);
+      }
+    }
+#endif
+  }
+
+  // Called once per request.
+  void CountRequest() {
+    if (++num_requests_ == kEpochRequests)
+      FinishEpoch();
+  }
+
+  // Record an access to the values [offset, offset + len) and return a pointer to them.
+  Val* Touch(size_t offset, size_t len) {
+    size_t first = offset * sizeof(Val) / kRegionBytes;
+    size_t last = ((offset + len) * sizeof(Val) - 1) / kRegionBytes;
+    for (size_t r = first; r <= last; ++r)
+      last_access_[r] = epoch_;
+    if (len * sizeof(Val) >= kRegionBytes) {
+      // A long run: read the whole span ahead instead of faulting page by page.
+      size_t start = PageOffset(offset);
+      madvise(reinterpret_cast<char*>(data_) + start, (offset + len) * sizeof(Val) - start, MADV_WILLNEED);
+    }
+    return data_ + offset;
+  }
+
+  Val* TouchForWrite(size_t offset, size_t len) {
+    checkpointer_->BeforeWrite(offset * sizeof(Val), (offset + len) * sizeof(Val));
+    return Touch(offset, len);
+  }
+
+  // The byte offset of the page holding the value at offset.
+  size_t PageOffset(size_t offset) const {
+    static const size_t kPageSize = sysconf(_SC_PAGESIZE);
+    return offset * sizeof(Val) / kPageSize * kPageSize;
+  }
+
+  third_party::Range range_;
+  uint32_t chunk_size_;
+  Val* data_ = nullptr;
+  size_t bytes_ = 0;
+  uint32_t epoch_ = 0;
+  uint32_t num_requests_ = 0;  // in the current epoch
+  // The last epoch in which each region is accessed
+  std::vector<uint32_t> last_access_;
+  std::unique_ptr<Checkpointer> checkpointer_;
+};
+
+}  // namespace flexps
@@ -0,0 +1,141 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/mmap_storage.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace flexps {
+namespace {
+
+class TestMmapStorage : public testing::Test {
+ public:
+  TestMmapStorage() {}
+  ~TestMmapStorage() {}
+
+ protected:
+  void SetUp() { path_ = "/tmp/flexps_mmap_storage_test_" + std::to_string(getpid()); }
+  void TearDown() {}
+
+  std::string path_;
+};
+
+TEST_F(TestMmapStorage, CreateRemovesFile) {
+  MmapStorage<float> s({10, 20}, path_);
+  EXPECT_EQ(s.Size(), 10);
+  EXPECT_NE(access(path_.c_str(), F_OK), 0);
+}
+
+TEST_F(TestMmapStorage, AddGet) {
+  MmapStorage<int> s({10, 20}, path_);
+
+  Message m;
+  third_party::SArray<Key> s_keys({13, 14, 15});
+  third_party::SArray<int> s_vals({1, 2, 3});
+  m.AddData(s_keys);
+  m.AddData(s_vals);
+  s.Add(m);
+  s.Add(m);
+
+  Message m2;
+  m2.AddData(third_party::SArray<Key>({12, 13, 14, 15}));
+  Message rep = s.Get(m2);
+  auto rep_vals = third_party::SArray<int>(rep.data[1]);
+  ASSERT_EQ(rep_vals.size(), 4);
+  EXPECT_EQ(rep_vals[0], 0);
+  EXPECT_EQ(rep_vals[1], 2);
+  EXPECT_EQ(rep_vals[2], 4);
+  EXPECT_EQ(rep_vals[3], 6);
+}
+
+TEST_F(TestMmapStorage, SubAddChunkSubGetChunk) {
+  MmapStorage<float> s({0, 40}, path_, 10);
+  third_party::SArray<Key> s_keys({1, 3});
+  third_party::SArray<float> s_vals(20);
+  for (int i = 0; i < 20; ++i)
+    s_vals[i] = i;
+  s.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<float> ret(s.SubGetChunk(s_keys));
+  ASSERT_EQ(ret.size(), 20);
+  for (int i = 0; i < 20; ++i)
+    EXPECT_EQ(ret[i], i);
+  third_party::SArray<float> elems(s.SubGet(third_party::SArray<Key>({9, 10, 39})));
+  EXPECT_EQ(elems[0], 0);
+  EXPECT_EQ(elems[1], 0);
+  EXPECT_EQ(elems[2], 19);
+}
+
+TEST_F(TestMmapStorage, LargeSparseRange) {
+  // 2G (32-bit keys) or 4G floats of address space, only the touched pages are materialized.
+  const Key kSize = Key(1) << (sizeof(Key) == 4 ? 31 : 32);
+  MmapStorage<float> s({0, kSize - 1}, path_);
+  third_party::SArray<Key> keys({0, 1, 2, kSize / 2, kSize - 2});
+  third_party::SArray<float> vals({1, 2, 3, 4, 5});
+  for (int iter = 0; iter < 5; ++iter) {
+    s.SubAdd(keys, third_party::SArray<char>(vals));
+    s.FinishIter();
+  }
+  third_party::SArray<float> ret(s.SubGet(keys));
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(ret[i], 5 * vals[i]);
+}
+
+TEST_F(TestMmapStorage, LongRuns) {
+  // Runs spanning several regions are prefetched, the values must be the same.
+  const Key kSize = 3 * MmapStorage<double>::kRegionBytes / sizeof(double);
+  MmapStorage<double> s({0, kSize}, path_);
+  third_party::SArray<Key> keys(kSize);
+  third_party::SArray<double> vals(kSize);
+  for (Key i = 0; i < kSize; ++i) {
+    keys[i] = i;
+    vals[i] = i;
+  }
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  s.FinishIter();
+  s.FinishIter();
+  s.FinishIter();
+  third_party::SArray<double> ret(s.SubGet(keys));
+  for (Key i = 0; i < kSize; i += 1000)
+    EXPECT_EQ(ret[i], i);
+}
+
+TEST_F(TestMmapStorage, EpochsWithoutIters) {
+  // Without FinishIter, e.g. while the min clock stalls, the epochs end every kEpochRequests requests.
+  MmapStorage<float> s({0, 100}, path_);
+  third_party::SArray<Key> keys({1, 50});
+  for (uint32_t i = 0; i < 3 * MmapStorage<float>::kEpochRequests; ++i)
+    s.SubAdd(keys, third_party::SArray<char>(third_party::SArray<float>({1, 2})));
+  EXPECT_EQ(s.GetEpoch(), 3);
+  s.FinishIter();
+  EXPECT_EQ(s.GetEpoch(), 4);
+  third_party::SArray<float> ret(s.SubGet(keys));
+  EXPECT_EQ(ret[0], 3 * MmapStorage<float>::kEpochRequests);
+  EXPECT_EQ(ret[1], 6 * MmapStorage<float>::kEpochRequests);
+}
+
+TEST_F(TestMmapStorage, LoadRange) {
+  std::string values_path = path_ + "_values";
+  std::vector<double> values(100);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = i * 0.5;
+  FILE* file = fopen(values_path.c_str(), "wb");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(fwrite(values.data(), sizeof(double), values.size(), file), values.size());
+  fclose(file);
+
+  MmapStorage<double> s({40, 100}, path_);
+  s.LoadRange(values_path);
+  third_party::SArray<Key> keys({40, 41, 99});
+  s.SubAdd(keys, third_party::SArray<char>(third_party::SArray<double>({1, 1, 1})));
+  third_party::SArray<double> ret(s.SubGet(keys));
+  EXPECT_EQ(ret[0], 21);
+  EXPECT_EQ(ret[1], 21.5);
+  EXPECT_EQ(ret[2], 50.5);
+  remove(values_path.c_str());
+}
+
+}  // namespace
+}  // namespace flexps
@@ -0,0 +1,653 @@
+#pragma once
+
+#include "server/abstract_model.hpp"
+
+#include "base/message.hpp"
+#include "base/threadsafe_queue.hpp"
+#include "server/abstract_storage.hpp"
+#include "server/pending_buffer.hpp"
+#include "server/progress_tracker.hpp"
+#include "server/staleness_controller.hpp"
+#include "server/subscriptions.hpp"
+
+#include "glog/logging.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * Model<Storage, Consistency> is the compile-time specialized counterpart of SSPModel/BSPModel/ASPModel,
+ * which are deprecated and no longer extended.
+ *
+ * The server thread still dispatches to the model through AbstractModel, but from there on the
+ * consistency logic and the concrete Storage are known at compile time: the storage is called
+ * with qualified (non-virtual) calls, so its loops are inlined and specialized for its Val type.
+ * The Gets released together go through AbstractStorage::GetBatch, one virtual call per batch.
+ *
+ * Consistency is one of SSPConsistency, BSPConsistency, BackupBSPConsistency and ASPConsistency below. They keep the
+ * same semantics as the corresponding models and act on the model through:
+ *   ProgressTracker& GetProgressTracker(),
+ *   void AddToStorage(Message& msg), void ReplyGet(Message& msg), void ReplyGets(std::vector<Message>& msgs),
+ *   void Push(std::vector<Message>& gets, int version), void FinishIter().
+ * Only SSPConsistency serves subscriptions (kSubscribe) and adapts its staleness (kAdaptStaleness).
+ * When a worker retires (kRetireWorkers), the model calls Retire(model, tid) on the consistency before
+ * it stops tracking the worker, and AdvanceMinClock(model, min_clock) if the min clock moves up.
+ * ResetWorker calls Reset(model) on the consistency, which drops what it kept of the previous task.
+ *
+ * With node clocks (see NodeClockAggregator), the Clocks come from the nodes and the workers report
+ * their own clocks as the version of their Adds and Gets, so the consistencies check the workers
+ * against the min clock of the nodes as they would against the min clock of the workers.
+ *
+ * The storage is checkpointed on a kCheckpoint message (see KVEngine::Checkpoint), either right
+ * away or each time the min clock reaches a multiple of a given interval. The checkpoints are
+ * written to <prefix>.0, <prefix>.1, ... and have to be restored in this order.
+ */
+template <typename Storage, typename Consistency>
+class Model : public AbstractModel {
+ public:
+  explicit Model(uint32_t model_id, std::unique_ptr<Storage>&& storage_ptr, int staleness,
+                 ThreadsafeQueue<Message>* reply_queue)
+      : model_id_(model_id), reply_queue_(reply_queue), storage_(std::move(storage_ptr)), consistency_(staleness) {}
+  // For the consistencies that take more than the staleness, e.g. BackupBSPConsistency
+  explicit Model(uint32_t model_id, std::unique_ptr<Storage>&& storage_ptr, Consistency&& consistency,
+                 ThreadsafeQueue<Message>* reply_queue)
+      : model_id_(model_id),
+        reply_queue_(reply_queue),
+        storage_(std::move(storage_ptr)),
+        consistency_(std::move(consistency)) {}
+
+  virtual void Clock(Message& msg) override {
+    consistency_.Clock(this, msg);
+    if (!retire_clocks_.empty()) {
+      auto it = retire_clocks_.find(msg.meta.sender);
+      if (it != retire_clocks_.end() && progress_tracker_.GetProgress(msg.meta.sender) >= it->second) {
+        retire_clocks_.erase(it);
+        Retire(msg.meta.sender);
+      }
+    }
+    MaybeCheckpoint();
+  }
+  virtual void Add(Message& msg) override {
+    if (node_clocks_)
+      progress_tracker_.ReportProgress(msg.meta.sender, msg.meta.version);
+    consistency_.Add(this, msg);
+  }
+  virtual void Get(Message& msg) override {
+    if (node_clocks_)
+      progress_tracker_.ReportProgress(msg.meta.sender, msg.meta.version);
+    consistency_.Get(this, msg);
+  }
+  virtual void Subscribe(Message& msg) override { consistency_.Subscribe(this, msg); }
+  virtual void AdaptStaleness(Message& msg) override { consistency_.AdaptStaleness(this, msg); }
+  virtual int GetProgress(int tid) override { return progress_tracker_.GetProgress(tid); }
+
+  // msg.data[0] holds the tids to track, and with node clocks msg.data[1] the worker tids.
+  virtual void ResetWorker(Message& msg) override {
+    CHECK_GE(msg.data.size(), 1);
+    CHECK_LE(msg.data.size(), 2);
+    third_party::SArray<uint32_t> tids;
+    tids = msg.data[0];
+    std::vector<uint32_t> tids_vec;
+    for (auto tid : tids)
+      tids_vec.push_back(tid);
+    this->progress_tracker_.Init(tids_vec);
+    node_clocks_ = msg.data.size() == 2;
+    if (node_clocks_) {
+      third_party::SArray<uint32_t> members(msg.data[1]);
+      this->progress_tracker_.SetMembers(std::vector<uint32_t>(members.begin(), members.end()));
+    }
+    retire_clocks_.clear();
+    consistency_.Reset(this);
+    Message reply_msg;
+    reply_msg.meta.model_id = model_id_;
+    reply_msg.meta.recver = msg.meta.sender;
+    reply_msg.meta.flag = Flag::kResetWorkerInModel;
+    reply_queue_->Push(reply_msg);
+  }
+
+  /*
+   * msg.data[0] is the path prefix of the checkpoint files and msg.data[1] holds one uint32_t, the
+   * interval in clocks: 0 checkpoints now, otherwise the checkpoints are taken from now on every
+   * interval clocks.
+   */
+  virtual void Checkpoint(Message& msg) override {
+    CHECK_EQ(msg.data.size(), 2);
+    std::string prefix(msg.data[0].data(), msg.data[0].size());
+    if (prefix != checkpoint_prefix_) {
+      checkpoint_prefix_ = prefix;
+      num_checkpoints_ = 0;
+    }
+    third_party::SArray<uint32_t> interval(msg.data[1]);
+    CHECK_EQ(interval.size(), 1);
+    checkpoint_interval_ = interval[0];
+    if (checkpoint_interval_ == 0) {
+      TakeCheckpoint();
+    } else {
+      next_checkpoint_clock_ = (progress_tracker_.GetMinClock() / checkpoint_interval_ + 1) * checkpoint_interval_;
+    }
+  }
+
+  /*
+   * msg.data[0] holds the tids of the workers retiring and msg.data[1] one int, the clock. A retiring
+   * worker leaves once its progress reaches the clock, at once if it has already. Its blocked Gets are
+   * still served, and if it was the last worker at the min clock, the min clock moves up and the
+   * requests waiting for it are released.
+   * A kRetireWorkers reply is sent back to msg.meta.sender.
+   */
+  virtual void RetireWorkers(Message& msg) override {
+    CHECK(!node_clocks_) << "Workers cannot retire from a table with node clocks";
+    CHECK_EQ(msg.data.size(), 2);
+    third_party::SArray<uint32_t> retiring(msg.data[0]);
+    third_party::SArray<int> clock(msg.data[1]);
+    CHECK_EQ(clock.size(), 1);
+    for (auto tid : retiring) {
+      if (progress_tracker_.GetProgress(tid) >= clock[0])
+        Retire(tid);
+      else
+        retire_clocks_[tid] = clock[0];
+    }
+    MaybeCheckpoint();
+    Message reply_msg;
+    reply_msg.meta.model_id = model_id_;
+    reply_msg.meta.recver = msg.meta.sender;
+    reply_msg.meta.flag = Flag::kRetireWorkers;
+    reply_queue_->Push(reply_msg);
+  }
+
+  /*
+   * Bulk load before the workers start, msg.data[0] is a path:
+   * - kLoad: a file of the raw values of keys [0, n), the storage copies its range out of it;
+   * - kRestore: the prefix of checkpoints, <prefix>.0, <prefix>.1, ... are restored in order. Later
+   *   checkpoints to the same prefix continue the numbering.
+   * A kLoad/kRestore reply is sent back to msg.meta.sender when done.
+   */
+  virtual void Load(Message& msg) override {
+    CHECK_EQ(msg.data.size(), 1);
+    std::string path(msg.data[0].data(), msg.data[0].size());
+    if (msg.meta.flag == Flag::kLoad) {
+      storage_->Storage::LoadRange(path);
+    } else {
+      CHECK(msg.meta.flag == Flag::kRestore);
+      uint32_t n = 0;
+      for (; access((path + "." + std::to_string(n)).c_str(), F_OK) == 0; ++n)
+        storage_->Storage::Restore(path + "." + std::to_string(n));
+      LOG_IF(WARNING, n == 0) << "No checkpoint found at " << path;
+      checkpoint_prefix_ = path;
+      num_checkpoints_ = n;
+    }
+    Message reply_msg;
+    reply_msg.meta.model_id = model_id_;
+    reply_msg.meta.recver = msg.meta.sender;
+    reply_msg.meta.flag = msg.meta.flag;
+    reply_queue_->Push(reply_msg);
+  }
+
+  ProgressTracker& GetProgressTracker() { return progress_tracker_; }
+  Storage* GetStorage() { return storage_.get(); }
+  Consistency& GetConsistency() { return consistency_; }
+
+  void AddToStorage(Message& msg) {
+    CHECK(msg.data.size() == 2);
+    third_party::SArray<Key> typed_keys(msg.data[0]);
+    if (msg.meta.flag == Flag::kAddChunk)
+      storage_->Storage::SubAddChunk(typed_keys, msg.data[1]);
+    else if (msg.meta.flag == Flag::kAddRange)
+      storage_->Storage::SubAddRange(typed_keys, msg.data[1]);
+    else
+      storage_->Storage::SubAdd(typed_keys, msg.data[1]);
+  }
+
+  void ReplyGet(Message& msg) {
+    CHECK(msg.data.size() == 1);
+    third_party::SArray<Key> typed_keys(msg.data[0]);
+    Message reply = AbstractStorage::CreateReply(msg);
+    reply.data.reserve(2);
+    reply.AddData<Key>(typed_keys);
+    if (msg.meta.flag == Flag::kGetChunk)
+      reply.AddData<char>(storage_->Storage::SubGetChunk(typed_keys));
+    else if (msg.meta.flag == Flag::kGetRange)
+      reply.AddData<char>(storage_->Storage::SubGetRange(typed_keys));
+    else
+      reply.AddData<char>(storage_->Storage::SubGet(typed_keys));
+    reply_queue_->Push(std::move(reply));
+  }
+
+  void ReplyGets(std::vector<Message>& msgs) {
+    if (msgs.size() == 1) {
+      ReplyGet(msgs[0]);
+      return;
+    }
+    for (auto& reply : storage_->GetBatch(msgs))
+      reply_queue_->Push(std::move(reply));
+  }
+
+  // Push the values of the subscriptions gets, valid up to clock version, see Subscriptions.
+  void Push(std::vector<Message>& gets, int version) {
+    for (auto& reply : storage_->GetBatch(gets))
+      reply_queue_->Push(Subscriptions::ToPush(std::move(reply), version));
+  }
+
+  void FinishIter() { storage_->Storage::FinishIter(); }
+
+ private:
+  void Retire(int tid) {
+    consistency_.Retire(this, tid);
+    int updated_min_clock = progress_tracker_.RemoveThread(tid);
+    if (updated_min_clock != -1)
+      consistency_.AdvanceMinClock(this, updated_min_clock);
+  }
+
+  void MaybeCheckpoint() {
+    if (checkpoint_interval_ > 0 && progress_tracker_.GetMinClock() >= next_checkpoint_clock_) {
+      TakeCheckpoint();
+      next_checkpoint_clock_ = (progress_tracker_.GetMinClock() / checkpoint_interval_ + 1) * checkpoint_interval_;
+    }
+  }
+
+  void TakeCheckpoint() {
+    std::string path = checkpoint_prefix_ + "." + std::to_string(num_checkpoints_++);
+    VLOG(1) << "Checkpoint model " << model_id_ << " at min clock " << progress_tracker_.GetMinClock() << " to "
+            << path;
+    storage_->Storage::Checkpoint(path);
+  }
+
+  uint32_t model_id_;
+
+  ThreadsafeQueue<Message>* reply_queue_;
+  std::unique_ptr<Storage> storage_;
+  ProgressTracker progress_tracker_;
+  Consistency consistency_;
+
+  std::string checkpoint_prefix_;
+  uint32_t checkpoint_interval_ = 0;
+  int next_checkpoint_clock_ = 0;
+  uint32_t num_checkpoints_ = 0;
+
+  // <tid, clock> of the workers to retire once they reach the clock
+  std::unordered_map<int, int> retire_clocks_;
+  bool node_clocks_ = false;
+};
+
+// Same semantics as SSPModel, plus Subscribe and AdaptStaleness.
+class SSPConsistency {
+ public:
+  explicit SSPConsistency(int staleness) : staleness_(staleness) {}
+
+  template <typename M>
+  void Clock(M* model, Message& msg) {
+    auto now = std::chrono::steady_clock::now();
+    if (staleness_controller_)
+      staleness_controller_->OnClock(msg.meta.sender, now);
+    int updated_min_clock = model->GetProgressTracker().AdvanceAndGetChangedMinClock(msg.meta.sender);
+    if (updated_min_clock != -1)  // min clock updated
+      AdvanceMinClock(model, updated_min_clock);
+  }
+
+  // The min clock moved up to min_clock, possibly by several clocks after a worker retired.
+  template <typename M>
+  void AdvanceMinClock(M* model, int min_clock) {
+    auto now = std::chrono::steady_clock::now();
+    if (staleness_controller_)
+      SetStaleness(model, staleness_controller_->OnMinClock(min_clock, now));
+    auto reqs_blocked_at_this_min_clock = buffer_.Pop(min_clock);
+    if (staleness_controller_)
+      staleness_controller_->OnBlocked(-static_cast<int>(reqs_blocked_at_this_min_clock.size()), now);
+    model->ReplyGets(reqs_blocked_at_this_min_clock);
+    if (!subscriptions_.Empty())
+      model->Push(subscriptions_.GetRequests(), min_clock + staleness_);
+    model->FinishIter();
+  }
+
+  template <typename M>
+  void Retire(M*, int tid) {
+    subscriptions_.Remove(tid);
+    if (staleness_controller_)
+      staleness_controller_->OnRetire(tid);
+  }
+
+  template <typename M>
+  void Add(M* model, Message& msg) {
+    // The add will always never be blocked
+    model->AddToStorage(msg);
+  }
+
+  template <typename M>
+  void Get(M* model, Message& msg) {
+    auto& progress_tracker = model->GetProgressTracker();
+    CHECK(progress_tracker.CheckThreadValid(msg.meta.sender));
+    int progress = progress_tracker.GetProgress(msg.meta.sender);
+    int min_clock = progress_tracker.GetMinClock();
+    if (progress > min_clock + staleness_) {
+      buffer_.Push(progress - staleness_, msg);
+      if (staleness_controller_)
+        staleness_controller_->OnBlocked(1, std::chrono::steady_clock::now());
+    } else {
+      model->ReplyGet(msg);
+    }
+  }
+
+  // The current values are pushed right away, later pushes follow the min clock.
+  template <typename M>
+  void Subscribe(M* model, Message& msg) {
+    // A worker retired by kRetireWorkers still unsubscribes when its table is destroyed, its
+    // subscription is already gone then.
+    if (msg.data.empty()) {
+      subscriptions_.Remove(msg.meta.sender);
+      return;
+    }
+    auto& progress_tracker = model->GetProgressTracker();
+    CHECK(progress_tracker.CheckThreadValid(msg.meta.sender));
+    std::vector<Message> get(1, subscriptions_.Add(msg));
+    model->Push(get, progress_tracker.GetMinClock() + staleness_);
+  }
+
+  /*
+   * msg.data[0] holds the bounds {min_staleness, max_staleness}. The staleness is clamped to them
+   * right away, and the Gets it releases are served at once.
+   */
+  template <typename M>
+  void AdaptStaleness(M* model, Message& msg) {
+    CHECK_EQ(msg.data.size(), 1);
+    third_party::SArray<int> bounds(msg.data[0]);
+    CHECK_EQ(bounds.size(), 2);
+    staleness_controller_.reset(new StalenessController(bounds[0], bounds[1], staleness_));
+    staleness_controller_->OnBlocked(buffer_.NumRequests(), std::chrono::steady_clock::now());
+    SetStaleness(model, staleness_controller_->GetStaleness());
+  }
+
+  // The clocks start over from 0, so the Gets still blocked cannot be kept. The workers of the new task
+  // subscribe again.
+  template <typename M>
+  void Reset(M*) {
+    buffer_.Reset();
+    subscriptions_.Clear();
+    if (staleness_controller_)
+      staleness_controller_->Reset();
+  }
+
+  int GetPendingSize(int progress) { return buffer_.Size(progress); }
+  int GetStaleness() const { return staleness_; }
+
+ private:
+  // Re-buffer the blocked Gets by the new staleness and serve the ones it releases. The Gets of
+  // retired workers are served at the next min clock advance.
+  template <typename M>
+  void SetStaleness(M* model, int staleness) {
+    if (staleness == staleness_)
+      return;
+    staleness_ = staleness;
+    auto& progress_tracker = model->GetProgressTracker();
+    int min_clock = progress_tracker.GetMinClock();
+    std::vector<Message> released;
+    for (auto& msg : buffer_.Drain()) {
+      if (!progress_tracker.CheckThreadValid(msg.meta.sender)) {
+        buffer_.Push(min_clock + 1, msg);
+        continue;
+      }
+      int clock = progress_tracker.GetProgress(msg.meta.sender) - staleness_;
+      if (clock <= min_clock)
+        released.push_back(std::move(msg));
+      else
+        buffer_.Push(clock, msg);
+    }
+    if (released.empty())
+      return;
+    staleness_controller_->OnBlocked(-static_cast<int>(released.size()), std::chrono::steady_clock::now());
+    model->ReplyGets(released);
+  }
+
+  int staleness_;
+  PendingBuffer buffer_;
+  Subscriptions subscriptions_;
+  std::unique_ptr<StalenessController> staleness_controller_;
+};
+
+/*
+ * Same semantics as BSPModel, the staleness is ignored.
+ *
+ * With num_backups > 0 (see BackupBSPConsistency), the barrier is passed once all but num_backups
+ * workers have clocked, as with the backup workers of synchronous SGD. The workers left behind are
+ * fast-forwarded to the new clock: the Adds they still send for the iterations passed without them
+ * are dropped, and their Clocks for those iterations are swallowed.
+ */
+class BSPConsistency {
+ public:
+  explicit BSPConsistency(int, int num_backups = 0) : num_backups_(num_backups) { CHECK_GE(num_backups_, 0); }
+
+  template <typename M>
+  void Clock(M* model, Message& msg) {
+    auto& progress_tracker = model->GetProgressTracker();
+    if (!late_clocks_.empty()) {
+      auto late = late_clocks_.find(msg.meta.sender);
+      if (late != late_clocks_.end()) {  // the Clock of an iteration passed without the worker
+        if (--late->second == 0)
+          late_clocks_.erase(late);
+        return;
+      }
+    }
+    int updated_min_clock = progress_tracker.AdvanceAndGetChangedMinClock(msg.meta.sender);
+    int progress = progress_tracker.GetProgress(msg.meta.sender);
+    CHECK_LE(progress, progress_tracker.GetMinClock() + 1);
+    if (updated_min_clock == -1 && num_backups_ > 0)
+      updated_min_clock = FastForwardLate(progress_tracker);
+    if (updated_min_clock != -1)  // min clock updated
+      AdvanceMinClock(model, updated_min_clock);
+  }
+
+  // The barrier: the Adds of the iteration are applied and the Gets of the next one served.
+  template <typename M>
+  void AdvanceMinClock(M* model, int min_clock) {
+    if (delta_ && num_pending_adds_ > 0)
+      delta_->FlushTo(model->GetStorage());
+    for (auto& add_req : add_buffer_) {
+      model->AddToStorage(add_req);
+    }
+    add_buffer_.clear();
+    num_pending_adds_ = 0;
+
+    model->ReplyGets(get_buffer_);
+    get_buffer_.clear();
+
+    model->FinishIter();
+
+    if (num_late_ > 0 || num_dropped_adds_ > 0)
+      LOG(INFO) << "BSP iteration " << min_clock - 1 << " passed with " << num_late_ << " late workers, "
+                << num_dropped_adds_ << " late Adds dropped since the last barrier";
+    last_iter_late_ = num_late_;
+    last_iter_dropped_adds_ = num_dropped_adds_;
+    total_late_ += num_late_;
+    total_dropped_adds_ += num_dropped_adds_;
+    num_late_ = 0;
+    num_dropped_adds_ = 0;
+  }
+
+  // The Adds already sent by a retiring worker are still applied at the barrier.
+  template <typename M>
+  void Retire(M*, int tid) {
+    late_clocks_.erase(tid);
+  }
+
+  template <typename M>
+  void Add(M* model, Message& msg) {
+    auto& progress_tracker = model->GetProgressTracker();
+    CHECK(progress_tracker.CheckThreadValid(msg.meta.sender));
+    int progress = progress_tracker.GetProgress(msg.meta.sender);
+    // With node clocks it is the node of a late worker that is fast-forwarded, the worker itself is
+    // behind the min clock.
+    if ((!late_clocks_.empty() && late_clocks_.find(msg.meta.sender) != late_clocks_.end()) ||
+        (num_backups_ > 0 && progress < progress_tracker.GetMinClock())) {
+      num_dropped_adds_ += 1;
+      return;
+    }
+    if (progress == progress_tracker.GetMinClock()) {
+      if (!delta_created_) {
+        delta_ = model->GetStorage()->CreateDelta();
+        delta_created_ = true;
+      }
+      if (delta_)
+        delta_->Add(msg);
+      else
+        add_buffer_.push_back(msg);
+      num_pending_adds_ += 1;
+    } else {
+      CHECK(false) << "progress error in BSPConsistency::Add";
+    }
+  }
+
+  template <typename M>
+  void Get(M* model, Message& msg) {
+    auto& progress_tracker = model->GetProgressTracker();
+    CHECK(progress_tracker.CheckThreadValid(msg.meta.sender));
+    int progress = progress_tracker.GetProgress(msg.meta.sender);
+    if (progress == progress_tracker.GetMinClock() + 1) {
+      get_buffer_.push_back(msg);
+    } else if (progress == progress_tracker.GetMinClock() ||
+               (num_backups_ > 0 && progress < progress_tracker.GetMinClock())) {  // late, see Add
+      model->ReplyGet(msg);
+    } else {
+      CHECK(false) << "progress error in BSPConsistency::Get { get progress: " << progress
+                   << ", min clock: " << progress_tracker.GetMinClock() << " }";
+    }
+  }
+
+  template <typename M>
+  void Subscribe(M*, Message&) {
+    CHECK(false) << "Subscribe is only served under SSP";
+  }
+  template <typename M>
+  void AdaptStaleness(M*, Message&) {
+    CHECK(false) << "AdaptStaleness is only supported under SSP";
+  }
+
+  // The Gets and Adds of an unfinished iteration are dropped, and the workers of the new task start
+  // on time. The counters are per task.
+  template <typename M>
+  void Reset(M* model) {
+    // With as many backups as workers, no worker would ever be waited for and BSP would be ASP.
+    CHECK(num_backups_ == 0 || num_backups_ < model->GetProgressTracker().GetNumThreads())
+        << "BackupBSP needs fewer backups than workers (nodes with node clocks)";
+    get_buffer_.clear();
+    add_buffer_.clear();
+    delta_.reset();
+    delta_created_ = false;
+    num_pending_adds_ = 0;
+    late_clocks_.clear();
+    num_late_ = 0;
+    num_dropped_adds_ = 0;
+    total_late_ = 0;
+    total_dropped_adds_ = 0;
+    last_iter_late_ = 0;
+    last_iter_dropped_adds_ = 0;
+  }
+
+  int GetGetPendingSize() { return get_buffer_.size(); }
+  int GetAddPendingSize() { return num_pending_adds_; }
+  // Since the last ResetWorker
+  int GetNumLate() const { return total_late_ + num_late_; }
+  int GetNumDroppedAdds() const { return total_dropped_adds_ + num_dropped_adds_; }
+  // At the last barrier: the workers fast-forwarded in that iteration and the late Adds dropped since
+  // the barrier before it
+  int GetLastIterNumLate() const { return last_iter_late_; }
+  int GetLastIterNumDroppedAdds() const { return last_iter_dropped_adds_; }
+
+ private:
+  // If all but num_backups_ workers have clocked, fast-forward the others and return the min clock,
+  // return -1 otherwise.
+  int FastForwardLate(ProgressTracker& progress_tracker) {
+    int num_late = progress_tracker.GetNumThreadsAtMinClock();
+    if (num_late > num_backups_)
+      return -1;
+    int updated_min_clock = -1;
+    for (int tid : progress_tracker.GetThreadsAtMinClock()) {
+      late_clocks_[tid] += 1;
+      updated_min_clock = progress_tracker.AdvanceAndGetChangedMinClock(tid);
+    }
+    num_late_ += num_late;
+    return updated_min_clock;
+  }
+
+  std::vector<Message> get_buffer_;
+  /*
+   * The Adds of the iteration are summed into delta_ as they arrive, so the server holds one delta
+   * instead of every worker's message and the barrier applies it in one pass. Storages without a
+   * delta (see AbstractStorage::CreateDelta) keep the messages in add_buffer_.
+   */
+  std::unique_ptr<AbstractStorage> delta_;
+  bool delta_created_ = false;
+  std::vector<Message> add_buffer_;
+  int num_pending_adds_ = 0;
+
+  int num_backups_;
+  // <tid, number of Clocks owed> of the fast-forwarded workers
+  std::unordered_map<int, int> late_clocks_;
+  // In the current iteration
+  int num_late_ = 0;
+  int num_dropped_adds_ = 0;
+  int total_late_ = 0;
+  int total_dropped_adds_ = 0;
+  int last_iter_late_ = 0;
+  int last_iter_dropped_adds_ = 0;
+};
+
+// BSPConsistency with num_backups > 0 backup workers, the model is given the consistency itself (the
+// staleness is ignored).
+class BackupBSPConsistency : public BSPConsistency {
+ public:
+  BackupBSPConsistency(int staleness, int num_backups) : BSPConsistency(staleness, num_backups) {
+    CHECK_GT(num_backups, 0);
+  }
+};
+
+// Same semantics as ASPModel, the staleness is ignored. The min clock gates nothing, but it still
+// finishes the iterations of the storage, which ages the rows of an AdmissionStorage for one.
+class ASPConsistency {
+ public:
+  explicit ASPConsistency(int) {}
+
+  template <typename M>
+  void Clock(M* model, Message& msg) {
+    int updated_min_clock = model->GetProgressTracker().AdvanceAndGetChangedMinClock(msg.meta.sender);
+    if (updated_min_clock != -1)
+      AdvanceMinClock(model, updated_min_clock);
+  }
+
+  template <typename M>
+  void AdvanceMinClock(M* model, int) {
+    model->FinishIter();
+  }
+  template <typename M>
+  void Retire(M*, int) {}
+  template <typename M>
+  void Reset(M*) {}
+
+  template <typename M>
+  void Add(M* model, Message& msg) {
+    CHECK(model->GetProgressTracker().CheckThreadValid(msg.meta.sender));
+    model->AddToStorage(msg);
+  }
+
+  template <typename M>
+  void Get(M* model, Message& msg) {
+    CHECK(model->GetProgressTracker().CheckThreadValid(msg.meta.sender));
+    model->ReplyGet(msg);
+  }
+
+  template <typename M>
+  void Subscribe(M*, Message&) {
+    CHECK(false) << "Subscribe is only served under SSP";
+  }
+  template <typename M>
+  void AdaptStaleness(M*, Message&) {
+    CHECK(false) << "AdaptStaleness is only supported under SSP";
+  }
+};
+
+}  // namespace flexps
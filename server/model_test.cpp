@@ -0,0 +1,734 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "base/threadsafe_queue.hpp"
+#include "server/admission_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/map_storage.hpp"
+#include "server/model.hpp"
+#include "server/vector_storage.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+namespace flexps {
+namespace {
+
+class TestModel : public testing::Test {
+ public:
+  TestModel() {}
+  ~TestModel() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+Message MakeMsg(Flag flag, uint32_t sender, const third_party::SArray<Key>& keys,
+                const third_party::SArray<int>& vals = {}) {
+  Message m;
+  m.meta.flag = flag;
+  m.meta.model_id = 0;
+  m.meta.sender = sender;
+  m.meta.recver = 0;
+  if (flag == Flag::kClock)
+    return m;
+  m.AddData(keys);
+  if (flag == Flag::kAdd || flag == Flag::kAddChunk)
+    m.AddData(vals);
+  return m;
+}
+
+template <typename M>
+void ResetWorkers(M* model, ThreadsafeQueue<Message>* reply_queue) {
+  Message reset_msg;
+  third_party::SArray<uint32_t> tids({2, 3});
+  reset_msg.AddData(tids);
+  model->ResetWorker(reset_msg);
+  Message reset_reply_msg;
+  reply_queue->WaitAndPop(&reset_reply_msg);
+  EXPECT_EQ(reset_reply_msg.meta.flag, Flag::kResetWorkerInModel);
+}
+
+void CheckReply(ThreadsafeQueue<Message>* reply_queue, uint32_t recver, Key key, int val) {
+  Message check_msg;
+  reply_queue->WaitAndPop(&check_msg);
+  ASSERT_EQ(check_msg.data.size(), 2);
+  auto rep_keys = third_party::SArray<Key>(check_msg.data[0]);
+  auto rep_vals = third_party::SArray<int>(check_msg.data[1]);
+  ASSERT_EQ(rep_keys.size(), 1);
+  ASSERT_EQ(rep_vals.size(), 1);
+  EXPECT_EQ(rep_keys[0], key);
+  EXPECT_EQ(rep_vals[0], val);
+  EXPECT_EQ(check_msg.meta.flag, Flag::kGetReply);
+  EXPECT_EQ(check_msg.meta.sender, 0);
+  EXPECT_EQ(check_msg.meta.recver, recver);
+}
+
+TEST_F(TestModel, SSPGetAndAdd) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<MapStorage<int>, SSPConsistency> model(0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), 1,
+                                               &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  auto m1 = MakeMsg(Flag::kAdd, 2, {0}, {1});
+  auto m2 = MakeMsg(Flag::kAdd, 3, {1}, {2});
+  auto m3 = MakeMsg(Flag::kGet, 2, {0});
+  auto m4 = MakeMsg(Flag::kGet, 3, {1});
+  model.Add(m1);
+  model.Add(m2);
+  model.Get(m3);
+  model.Get(m4);
+
+  EXPECT_EQ(reply_queue.Size(), 2);
+  CheckReply(&reply_queue, 2, 0, 1);
+  CheckReply(&reply_queue, 3, 1, 2);
+}
+
+TEST_F(TestModel, SSPStaleness) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, SSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 1, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  // Worker 2 runs 2 clocks ahead of worker 3, its Get is blocked until worker 3 clocks.
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  auto c2 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  model.Clock(c2);
+  auto m1 = MakeMsg(Flag::kAdd, 2, {5}, {7});
+  model.Add(m1);
+  auto m2 = MakeMsg(Flag::kGet, 2, {5});
+  model.Get(m2);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  EXPECT_EQ(model.GetConsistency().GetPendingSize(1), 1);
+
+  auto c3 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c3);
+  EXPECT_EQ(reply_queue.Size(), 1);
+  CheckReply(&reply_queue, 2, 5, 7);
+  EXPECT_EQ(model.GetProgress(2), 2);
+  EXPECT_EQ(model.GetProgress(3), 1);
+}
+
+TEST_F(TestModel, SSPResetWorker) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, SSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 0, &reply_queue);
+
+  // The first task reaches clock 3 and leaves a Get of worker 2 blocked at clock 4.
+  ResetWorkers(&model, &reply_queue);
+  for (int i = 0; i < 3; ++i) {
+    for (uint32_t tid : {2, 3}) {
+      auto c = MakeMsg(Flag::kClock, tid, {});
+      model.Clock(c);
+    }
+  }
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  auto g1 = MakeMsg(Flag::kGet, 2, {1});
+  model.Get(g1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+
+  // The second task starts over from clock 0, the Get left by the first one is dropped.
+  ResetWorkers(&model, &reply_queue);
+  EXPECT_EQ(model.GetConsistency().GetPendingSize(4), 0);
+  auto c2 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c2);
+  auto g2 = MakeMsg(Flag::kGet, 2, {5});
+  model.Get(g2);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  EXPECT_EQ(model.GetConsistency().GetPendingSize(1), 1);
+  auto c3 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c3);
+  ASSERT_EQ(reply_queue.Size(), 1);
+  CheckReply(&reply_queue, 2, 5, 0);
+}
+
+TEST_F(TestModel, SSPSubscribe) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, SSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 2, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  // Both workers subscribe to the whole table, worker 2 twice: its second subscription replaces the first.
+  auto s1 = MakeMsg(Flag::kSubscribe, 2, {3});
+  auto s2 = MakeMsg(Flag::kSubscribe, 2, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  auto s3 = MakeMsg(Flag::kSubscribe, 3, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  model.Subscribe(s1);
+  model.Subscribe(s2);
+  model.Subscribe(s3);
+  EXPECT_EQ(reply_queue.Size(), 3);
+  Message push;
+  for (int i = 0; i < 3; ++i)
+    reply_queue.WaitAndPop(&push);
+
+  auto m1 = MakeMsg(Flag::kAdd, 3, {4}, {7});
+  model.Add(m1);
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  auto c2 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  model.Clock(c2);
+  ASSERT_EQ(reply_queue.Size(), 2);
+  for (int recver : {2, 3}) {
+    reply_queue.WaitAndPop(&push);
+    EXPECT_EQ(push.meta.flag, Flag::kPush);
+    EXPECT_EQ(push.meta.recver, recver);
+    EXPECT_EQ(push.meta.version, 3);
+    ASSERT_EQ(push.data.size(), 1);
+    third_party::SArray<int> vals(push.data[0]);
+    ASSERT_EQ(vals.size(), 10);
+    EXPECT_EQ(vals[4], 7);
+    EXPECT_EQ(vals[5], 0);
+  }
+
+  // The subscriptions end with the task.
+  ResetWorkers(&model, &reply_queue);
+  auto c3 = MakeMsg(Flag::kClock, 2, {});
+  auto c4 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c3);
+  model.Clock(c4);
+  EXPECT_EQ(reply_queue.Size(), 0);
+}
+
+TEST_F(TestModel, SSPAdaptStaleness) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, SSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 3, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  // The staleness is clamped to the bounds.
+  Message adapt;
+  adapt.meta.flag = Flag::kAdaptStaleness;
+  adapt.AddData(third_party::SArray<int>({0, 1}));
+  model.AdaptStaleness(adapt);
+  EXPECT_EQ(model.GetConsistency().GetStaleness(), 1);
+
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  auto c2 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  model.Clock(c2);
+  auto g1 = MakeMsg(Flag::kGet, 2, {5});
+  model.Get(g1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  EXPECT_EQ(model.GetConsistency().GetPendingSize(1), 1);
+  auto c3 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c3);
+  ASSERT_EQ(reply_queue.Size(), 1);
+  CheckReply(&reply_queue, 2, 5, 0);
+
+  // Raising the staleness serves the Gets it releases at once.
+  auto c4 = MakeMsg(Flag::kClock, 2, {});
+  auto c5 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c4);
+  model.Clock(c5);
+  auto g2 = MakeMsg(Flag::kGet, 2, {5});
+  model.Get(g2);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  EXPECT_EQ(model.GetConsistency().GetPendingSize(3), 1);
+  Message raise;
+  raise.meta.flag = Flag::kAdaptStaleness;
+  raise.AddData(third_party::SArray<int>({3, 4}));
+  model.AdaptStaleness(raise);
+  EXPECT_EQ(model.GetConsistency().GetStaleness(), 3);
+  ASSERT_EQ(reply_queue.Size(), 1);
+  CheckReply(&reply_queue, 2, 5, 0);
+  EXPECT_EQ(model.GetConsistency().GetPendingSize(3), 0);
+}
+
+// The kRetireWorkers reply follows the replies released by the retirement.
+void RetireWorkers(AbstractModel* model, const third_party::SArray<uint32_t>& retiring, int clock) {
+  Message msg;
+  msg.AddData(retiring);
+  msg.AddData(third_party::SArray<int>({clock}));
+  model->RetireWorkers(msg);
+}
+
+void CheckRetireWorkersReply(ThreadsafeQueue<Message>* reply_queue) {
+  Message reply;
+  reply_queue->WaitAndPop(&reply);
+  EXPECT_EQ(reply.meta.flag, Flag::kRetireWorkers);
+}
+
+TEST_F(TestModel, SSPRetireWorkers) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, SSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 0, &reply_queue);
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>({2, 3, 4}));
+  model.ResetWorker(reset_msg);
+  Message reset_reply_msg;
+  reply_queue.WaitAndPop(&reset_reply_msg);
+
+  // Worker 3 stalls, worker 2 is blocked at clock 2
+  for (int i = 0; i < 2; ++i) {
+    for (uint32_t tid : {2, 4}) {
+      auto c = MakeMsg(Flag::kClock, tid, {});
+      model.Clock(c);
+    }
+  }
+  auto g1 = MakeMsg(Flag::kGet, 2, {5});
+  model.Get(g1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+
+  // Worker 3 is retired at once: the min clock moves to 2
+  RetireWorkers(&model, {3}, 0);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 2);
+  CheckReply(&reply_queue, 2, 5, 0);
+  CheckRetireWorkersReply(&reply_queue);
+
+  // Worker 4 retires once it reaches clock 3, and worker 2 runs alone from then on
+  RetireWorkers(&model, {4}, 3);
+  CheckRetireWorkersReply(&reply_queue);
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  auto g2 = MakeMsg(Flag::kGet, 2, {5});
+  model.Get(g2);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  auto c2 = MakeMsg(Flag::kClock, 4, {});
+  model.Clock(c2);
+  EXPECT_FALSE(model.GetProgressTracker().CheckThreadValid(4));
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 3);
+  CheckReply(&reply_queue, 2, 5, 0);
+  auto c3 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c3);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 4);
+}
+
+TEST_F(TestModel, SSPUnsubscribeRetired) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, SSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 0, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+  auto s1 = MakeMsg(Flag::kSubscribe, 2, {1});
+  auto s2 = MakeMsg(Flag::kSubscribe, 3, {1});
+  model.Subscribe(s1);
+  model.Subscribe(s2);
+  Message push;
+  for (int i = 0; i < 2; ++i)
+    reply_queue.WaitAndPop(&push);
+
+  // Worker 3 is retired, then its table is destroyed and unsubscribes.
+  RetireWorkers(&model, {3}, 0);
+  CheckRetireWorkersReply(&reply_queue);
+  Message unsubscribe;
+  unsubscribe.meta.flag = Flag::kSubscribe;
+  unsubscribe.meta.sender = 3;
+  model.Subscribe(unsubscribe);
+  EXPECT_EQ(reply_queue.Size(), 0);
+
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  ASSERT_EQ(reply_queue.Size(), 1);
+  reply_queue.WaitAndPop(&push);
+  EXPECT_EQ(push.meta.flag, Flag::kPush);
+  EXPECT_EQ(push.meta.recver, 2);
+}
+
+TEST_F(TestModel, BSPRetire) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<MapStorage<int>, BSPConsistency> model(0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), 0,
+                                               &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  // Worker 3 is lost before the barrier of iteration 0, retiring it completes the barrier.
+  auto a1 = MakeMsg(Flag::kAdd, 2, {0}, {1});
+  model.Add(a1);
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  auto g1 = MakeMsg(Flag::kGet, 2, {0});
+  model.Get(g1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  RetireWorkers(&model, {3}, 0);
+  EXPECT_EQ(reply_queue.Size(), 2);
+  CheckReply(&reply_queue, 2, 0, 1);
+  CheckRetireWorkersReply(&reply_queue);
+}
+
+TEST_F(TestModel, BSP) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<MapStorage<int>, BSPConsistency> model(0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), 0,
+                                               &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  // Adds are buffered until the end of the iteration.
+  auto m1 = MakeMsg(Flag::kAdd, 2, {0}, {1});
+  model.Add(m1);
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  EXPECT_EQ(model.GetConsistency().GetAddPendingSize(), 1);
+
+  // Worker 2 is one iteration ahead, its Get waits for worker 3.
+  auto m2 = MakeMsg(Flag::kGet, 2, {0});
+  model.Get(m2);
+  EXPECT_EQ(model.GetConsistency().GetGetPendingSize(), 1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+
+  auto c2 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c2);
+  EXPECT_EQ(model.GetConsistency().GetAddPendingSize(), 0);
+  EXPECT_EQ(model.GetConsistency().GetGetPendingSize(), 0);
+  CheckReply(&reply_queue, 2, 0, 1);
+}
+
+TEST_F(TestModel, BackupBSP) {
+  ThreadsafeQueue<Message> reply_queue;
+  // One backup worker: the barrier passes once one of the two workers has clocked.
+  Model<MapStorage<int>, BackupBSPConsistency> model(
+      0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), BackupBSPConsistency(0, 1), &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  auto a1 = MakeMsg(Flag::kAdd, 2, {0}, {1});
+  model.Add(a1);
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 1);
+  EXPECT_EQ(model.GetProgressTracker().GetProgress(3), 1);
+  EXPECT_EQ(model.GetConsistency().GetLastIterNumLate(), 1);
+  EXPECT_EQ(model.GetConsistency().GetLastIterNumDroppedAdds(), 0);
+  auto g1 = MakeMsg(Flag::kGet, 2, {0});
+  model.Get(g1);
+  CheckReply(&reply_queue, 2, 0, 1);
+
+  // The late Add of worker 3 is dropped and its Clock of iteration 0 swallowed.
+  auto a2 = MakeMsg(Flag::kAdd, 3, {0}, {5});
+  model.Add(a2);
+  auto c2 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c2);
+  EXPECT_EQ(model.GetProgressTracker().GetProgress(3), 1);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 1);
+  auto g2 = MakeMsg(Flag::kGet, 3, {0});
+  model.Get(g2);
+  CheckReply(&reply_queue, 3, 0, 1);
+
+  // Iteration 1: worker 3 is first and worker 2 is left behind.
+  auto a3 = MakeMsg(Flag::kAdd, 3, {0}, {2});
+  model.Add(a3);
+  auto c3 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c3);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 2);
+  EXPECT_EQ(model.GetConsistency().GetLastIterNumLate(), 1);
+  EXPECT_EQ(model.GetConsistency().GetLastIterNumDroppedAdds(), 1);
+  auto a4 = MakeMsg(Flag::kAdd, 2, {0}, {10});
+  model.Add(a4);
+  auto c4 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c4);
+  EXPECT_EQ(model.GetProgressTracker().GetProgress(2), 2);
+  EXPECT_EQ(model.GetConsistency().GetAddPendingSize(), 0);
+  third_party::SArray<int> vals(model.GetStorage()->SubGet(third_party::SArray<Key>({0})));
+  EXPECT_EQ(vals[0], 3);
+  EXPECT_EQ(model.GetConsistency().GetNumLate(), 2);
+  EXPECT_EQ(model.GetConsistency().GetNumDroppedAdds(), 2);
+
+  // Iteration 2: the Add sent by worker 3 before the barrier is kept though worker 3 is late.
+  auto a5 = MakeMsg(Flag::kAdd, 2, {0}, {1});
+  model.Add(a5);
+  auto a6 = MakeMsg(Flag::kAdd, 3, {0}, {1});
+  model.Add(a6);
+  auto c5 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c5);
+  vals = third_party::SArray<int>(model.GetStorage()->SubGet(third_party::SArray<Key>({0})));
+  EXPECT_EQ(vals[0], 5);
+  EXPECT_EQ(model.GetConsistency().GetNumLate(), 3);
+  EXPECT_EQ(model.GetConsistency().GetNumDroppedAdds(), 2);
+
+  // Worker 3 is still late when the task ends, it starts the next one on time.
+  ResetWorkers(&model, &reply_queue);
+  EXPECT_EQ(model.GetConsistency().GetNumLate(), 0);
+  EXPECT_EQ(model.GetConsistency().GetNumDroppedAdds(), 0);
+  EXPECT_EQ(model.GetConsistency().GetLastIterNumLate(), 0);
+  auto a7 = MakeMsg(Flag::kAdd, 3, {0}, {1});
+  model.Add(a7);
+  auto c6 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c6);
+  EXPECT_EQ(model.GetProgressTracker().GetProgress(3), 1);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 1);
+  vals = third_party::SArray<int>(model.GetStorage()->SubGet(third_party::SArray<Key>({0})));
+  EXPECT_EQ(vals[0], 6);
+  EXPECT_EQ(model.GetConsistency().GetNumLate(), 1);
+  EXPECT_EQ(model.GetConsistency().GetNumDroppedAdds(), 0);
+}
+
+// Workers 2, 3 on node 20 and worker 4 on node 1020, the servers track the nodes.
+template <typename M>
+void ResetNodes(M* model, ThreadsafeQueue<Message>* reply_queue) {
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>({20, 1020}));
+  reset_msg.AddData(third_party::SArray<uint32_t>({2, 3, 4}));
+  model->ResetWorker(reset_msg);
+  Message reset_reply_msg;
+  reply_queue->WaitAndPop(&reset_reply_msg);
+  EXPECT_EQ(reset_reply_msg.meta.flag, Flag::kResetWorkerInModel);
+}
+
+TEST_F(TestModel, SSPNodeClocks) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<MapStorage<int>, SSPConsistency> model(0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), 1,
+                                               &reply_queue);
+  ResetNodes(&model, &reply_queue);
+
+  // Worker 2 is at clock 2 while node 20 is at 0, its Get waits as if worker 2 were tracked.
+  auto g1 = MakeMsg(Flag::kGet, 2, {0});
+  g1.meta.version = 2;
+  model.Get(g1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  auto g2 = MakeMsg(Flag::kGet, 3, {0});
+  g2.meta.version = 1;
+  model.Get(g2);
+  CheckReply(&reply_queue, 3, 0, 0);
+
+  auto a1 = MakeMsg(Flag::kAdd, 4, {0}, {1});
+  a1.meta.version = 0;
+  model.Add(a1);
+  auto c1 = MakeMsg(Flag::kClock, 1020, {});
+  model.Clock(c1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  auto c2 = MakeMsg(Flag::kClock, 20, {});
+  model.Clock(c2);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 1);
+  CheckReply(&reply_queue, 2, 0, 1);
+}
+
+TEST_F(TestModel, BackupBSPNodeClocks) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<MapStorage<int>, BackupBSPConsistency> model(
+      0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), BackupBSPConsistency(0, 1), &reply_queue);
+  ResetNodes(&model, &reply_queue);
+
+  // Node 1020 clocks first, node 20 is fast-forwarded and its workers are late.
+  auto a1 = MakeMsg(Flag::kAdd, 4, {0}, {1});
+  a1.meta.version = 0;
+  model.Add(a1);
+  auto c1 = MakeMsg(Flag::kClock, 1020, {});
+  model.Clock(c1);
+  EXPECT_EQ(model.GetProgressTracker().GetMinClock(), 1);
+  auto a2 = MakeMsg(Flag::kAdd, 2, {0}, {5});
+  a2.meta.version = 0;
+  model.Add(a2);
+  auto g1 = MakeMsg(Flag::kGet, 3, {0});
+  g1.meta.version = 0;
+  model.Get(g1);
+  CheckReply(&reply_queue, 3, 0, 1);
+  auto c2 = MakeMsg(Flag::kClock, 20, {});
+  model.Clock(c2);
+  EXPECT_EQ(model.GetProgressTracker().GetProgress(20), 1);
+  EXPECT_EQ(model.GetConsistency().GetNumDroppedAdds(), 1);
+
+  // Both nodes are at clock 1, worker 2 adds again on time.
+  auto a3 = MakeMsg(Flag::kAdd, 2, {0}, {2});
+  a3.meta.version = 1;
+  model.Add(a3);
+  EXPECT_EQ(model.GetConsistency().GetAddPendingSize(), 1);
+}
+
+// The Adds of both workers are summed into the delta and applied at the end of the iteration.
+template <typename Storage>
+void CheckBSPDelta(std::unique_ptr<Storage>&& storage) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<Storage, BSPConsistency> model(0, std::move(storage), 0, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  auto m1 = MakeMsg(Flag::kAdd, 2, {1, 4}, {1, 2});
+  auto m2 = MakeMsg(Flag::kAddChunk, 3, {0, 2}, {10, 20, 30, 40});  // keys 0, 1 and 4, 5
+  auto m3 = MakeMsg(Flag::kAdd, 3, {4}, {100});
+  model.Add(m1);
+  model.Add(m2);
+  model.Add(m3);
+  EXPECT_EQ(model.GetConsistency().GetAddPendingSize(), 3);
+  third_party::SArray<int> vals(model.GetStorage()->SubGet(third_party::SArray<Key>({4})));
+  EXPECT_EQ(vals[0], 0);
+
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  auto c2 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c1);
+  model.Clock(c2);
+  EXPECT_EQ(model.GetConsistency().GetAddPendingSize(), 0);
+  vals = third_party::SArray<int>(model.GetStorage()->SubGet(third_party::SArray<Key>({0, 1, 4, 5})));
+  EXPECT_EQ(vals[0], 10);
+  EXPECT_EQ(vals[1], 21);
+  EXPECT_EQ(vals[2], 132);
+  EXPECT_EQ(vals[3], 40);
+
+  // The delta starts from zero again.
+  auto m4 = MakeMsg(Flag::kAdd, 2, {5}, {1});
+  model.Add(m4);
+  auto c3 = MakeMsg(Flag::kClock, 2, {});
+  auto c4 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c3);
+  model.Clock(c4);
+  vals = third_party::SArray<int>(model.GetStorage()->SubGet(third_party::SArray<Key>({4, 5})));
+  EXPECT_EQ(vals[0], 132);
+  EXPECT_EQ(vals[1], 41);
+}
+
+TEST_F(TestModel, BSPDelta) {
+  EXPECT_TRUE(VectorStorage<int>({0, 10}).CreateDelta() != nullptr);
+  CheckBSPDelta(std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10}, 2)));
+  CheckBSPDelta(std::unique_ptr<HashStorage<int>>(new HashStorage<int>(2)));
+  // No delta for a chunked MapStorage, the Adds are kept as messages.
+  EXPECT_TRUE(MapStorage<int>(2).CreateDelta() == nullptr);
+  CheckBSPDelta(std::unique_ptr<MapStorage<int>>(new MapStorage<int>(2)));
+}
+
+TEST_F(TestModel, BSPSparseDelta) {
+  ThreadsafeQueue<Message> reply_queue;
+  // 64 checkpoint blocks
+  const Key kNumKeys = Checkpointer::kDefaultBlockBytes / sizeof(int) * 64;
+  Model<VectorStorage<int>, BSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, kNumKeys})), 0, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  // Only the blocks the Adds touch are flushed at the barrier.
+  auto m1 = MakeMsg(Flag::kAdd, 2, {3, 5000}, {1, 2});
+  auto m2 = MakeMsg(Flag::kAdd, 3, {kNumKeys - 1}, {3});
+  model.Add(m1);
+  model.Add(m2);
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  auto c2 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c1);
+  model.Clock(c2);
+  EXPECT_EQ(model.GetStorage()->NumDirtyBlocks(), 2);
+  third_party::SArray<int> vals(model.GetStorage()->SubGet(third_party::SArray<Key>({3, 4, 5000, kNumKeys - 1})));
+  EXPECT_EQ(vals[0], 1);
+  EXPECT_EQ(vals[1], 0);
+  EXPECT_EQ(vals[2], 2);
+  EXPECT_EQ(vals[3], 3);
+}
+
+TEST_F(TestModel, ASP) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<MapStorage<int>, ASPConsistency> model(0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), 0,
+                                               &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  auto c2 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  model.Clock(c2);
+  auto m1 = MakeMsg(Flag::kAdd, 2, {3}, {4});
+  model.Add(m1);
+  auto m2 = MakeMsg(Flag::kGet, 2, {3});
+  model.Get(m2);
+  CheckReply(&reply_queue, 2, 3, 4);
+}
+
+TEST_F(TestModel, ASPEviction) {
+  // ASP does not wait on the min clock, but its advance still evicts the idle rows.
+  ThreadsafeQueue<Message> reply_queue;
+  AdmissionConfig config;
+  config.evict_after = 1;
+  using Storage = AdmissionStorage<MapStorage<int>>;
+  Model<Storage, ASPConsistency> model(
+      0, std::unique_ptr<Storage>(new Storage(0, std::unique_ptr<MapStorage<int>>(new MapStorage<int>()), config)), 0,
+      &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  auto m1 = MakeMsg(Flag::kAdd, 2, {3}, {4});
+  model.Add(m1);
+  EXPECT_EQ(model.GetStorage()->GetStats().size, 1);
+  auto c1 = MakeMsg(Flag::kClock, 2, {});
+  model.Clock(c1);
+  EXPECT_EQ(model.GetStorage()->GetStats().evicted, 0);
+  auto c2 = MakeMsg(Flag::kClock, 3, {});
+  model.Clock(c2);
+  EXPECT_EQ(model.GetStorage()->GetStats().evicted, 1);
+  EXPECT_EQ(model.GetStorage()->GetStats().size, 0);
+  auto m2 = MakeMsg(Flag::kGet, 2, {3});
+  model.Get(m2);
+  CheckReply(&reply_queue, 2, 3, 0);
+}
+
+TEST_F(TestModel, Chunk) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, ASPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10}, 5)), 0, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  auto m1 = MakeMsg(Flag::kAddChunk, 2, {1}, {1, 2, 3, 4, 5});
+  model.Add(m1);
+  auto m2 = MakeMsg(Flag::kGetChunk, 2, {1});
+  model.Get(m2);
+
+  Message check_msg;
+  reply_queue.WaitAndPop(&check_msg);
+  EXPECT_EQ(check_msg.meta.flag, Flag::kGetChunkReply);
+  auto rep_vals = third_party::SArray<int>(check_msg.data[1]);
+  ASSERT_EQ(rep_vals.size(), 5);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(rep_vals[i], i + 1);
+}
+
+TEST_F(TestModel, CheckpointEveryClocks) {
+  ThreadsafeQueue<Message> reply_queue;
+  Model<VectorStorage<int>, SSPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 0, &reply_queue);
+  ResetWorkers(&model, &reply_queue);
+
+  std::string prefix = "/tmp/flexps_model_test_" + std::to_string(getpid());
+  Message checkpoint_msg;
+  checkpoint_msg.meta.flag = Flag::kCheckpoint;
+  third_party::SArray<char> prefix_arr;
+  prefix_arr.CopyFrom(prefix.data(), prefix.size());
+  checkpoint_msg.AddData(prefix_arr);
+  checkpoint_msg.AddData(third_party::SArray<uint32_t>({2}));
+  model.Checkpoint(checkpoint_msg);
+
+  // Min clock 1: no checkpoint, min clock 2: checkpoint .0 with both adds
+  for (int clock = 0; clock < 2; ++clock) {
+    auto m = MakeMsg(Flag::kAdd, 2, {clock}, {clock + 1});
+    model.Add(m);
+    auto c2 = MakeMsg(Flag::kClock, 2, {});
+    auto c3 = MakeMsg(Flag::kClock, 3, {});
+    model.Clock(c2);
+    model.Clock(c3);
+  }
+  model.GetStorage()->WaitCheckpoint();
+  EXPECT_NE(access((prefix + ".0").c_str(), F_OK), -1);
+  EXPECT_EQ(access((prefix + ".1").c_str(), F_OK), -1);
+
+  VectorStorage<int> restored({0, 10});
+  restored.Restore(prefix + ".0");
+  third_party::SArray<int> vals(restored.SubGet(third_party::SArray<Key>({0, 1})));
+  EXPECT_EQ(vals[0], 1);
+  EXPECT_EQ(vals[1], 2);
+  remove((prefix + ".0").c_str());
+}
+
+TEST_F(TestModel, RestoreCheckpoints) {
+  ThreadsafeQueue<Message> reply_queue;
+  std::string prefix = "/tmp/flexps_model_restore_test_" + std::to_string(getpid());
+  {
+    VectorStorage<int> s({0, 10});
+    s.SubAdd(third_party::SArray<Key>({1, 2}), third_party::SArray<char>(third_party::SArray<int>({1, 2})));
+    s.Checkpoint(prefix + ".0");
+    s.SubAdd(third_party::SArray<Key>({2, 9}), third_party::SArray<char>(third_party::SArray<int>({3, 4})));
+    s.Checkpoint(prefix + ".1");
+  }
+
+  Model<VectorStorage<int>, ASPConsistency> model(
+      0, std::unique_ptr<VectorStorage<int>>(new VectorStorage<int>({0, 10})), 0, &reply_queue);
+  Message restore_msg;
+  restore_msg.meta.flag = Flag::kRestore;
+  restore_msg.meta.sender = 5;
+  third_party::SArray<char> prefix_arr;
+  prefix_arr.CopyFrom(prefix.data(), prefix.size());
+  restore_msg.AddData(prefix_arr);
+  model.Load(restore_msg);
+  Message reply;
+  reply_queue.WaitAndPop(&reply);
+  EXPECT_EQ(reply.meta.flag, Flag::kRestore);
+  EXPECT_EQ(reply.meta.recver, 5);
+
+  third_party::SArray<int> vals(model.GetStorage()->SubGet(third_party::SArray<Key>({1, 2, 9})));
+  EXPECT_EQ(vals[0], 1);
+  EXPECT_EQ(vals[1], 5);
+  EXPECT_EQ(vals[2], 4);
+  remove((prefix + ".0").c_str());
+  remove((prefix + ".1").c_str());
+}
+
+}  // namespace
+}  // namespace flexps
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "base/key_ranges.hpp"
+#include "base/message.hpp"
+#include "base/third_party/range.h"
+#include "server/abstract_storage.hpp"
+#include "server/optimizers.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * A storage which applies an optimizer inside SubAdd: workers push raw gradients and the server
+ * keeps the per-key optimizer state next to the weight. SubGet returns the weights only.
+ *
+ * Keys have the same semantics as VectorStorage/MapStorage: element key k for SubAdd/SubGet and
+ * elements [k * chunk_size_, (k + 1) * chunk_size_) for the chunk key k of SubAddChunk/SubGetChunk.
+ *
+ * The slot lookup is provided by Derived (VectorOptimizerStorage or MapOptimizerStorage):
+ *   Val* Slot(Key key) returns the slot of key, creating it if needed,
+ *   const Val* FindSlot(Key key) const returns nullptr for a key never updated,
+ *   void CheckKeys(const third_party::SArray<Key>& keys, uint32_t chunk_size) const.
+ */
+template <typename Val, typename Optimizer, typename Derived>
+class OptimizerStorage : public AbstractStorage {
+ public:
+  OptimizerStorage(const OptimizerConfig& config, uint32_t chunk_size) : optimizer_(config), chunk_size_(chunk_size) {
+    CHECK_GT(chunk_size_, 0);
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size(), typed_vals.size());
+    derived()->CheckKeys(typed_keys, 1);
+    for (size_t i = 0; i < typed_keys.size(); i++)
+      optimizer_.Update(derived()->Slot(typed_keys[i]), typed_vals[i]);
+  }
+
+  virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_vals.size()/typed_keys.size(), chunk_size_);
+    derived()->CheckKeys(typed_keys, chunk_size_);
+    for (size_t i = 0; i < typed_keys.size(); i++)
+      for (size_t j = 0; j < chunk_size_; j++)
+        optimizer_.Update(derived()->Slot(typed_keys[i] * chunk_size_ + j), typed_vals[i * chunk_size_ + j]);
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size());
+    derived()->CheckKeys(typed_keys, 1);
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      const Val* slot = derived()->FindSlot(typed_keys[i]);
+      reply_vals[i] = slot ? slot[0] : Val();
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size() * chunk_size_);
+    derived()->CheckKeys(typed_keys, chunk_size_);
+    for (size_t i = 0; i < typed_keys.size(); i++)
+      for (size_t j = 0; j < chunk_size_; j++) {
+        const Val* slot = derived()->FindSlot(typed_keys[i] * chunk_size_ + j);
+        reply_vals[i * chunk_size_ + j] = slot ? slot[0] : Val();
+      }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual void FinishIter() override {}
+
+ protected:
+  static const uint32_t kWidth = Optimizer::kWidth;
+
+ private:
+  Derived* derived() { return static_cast<Derived*>(this); }
+
+  Optimizer optimizer_;
+  uint32_t chunk_size_;
+};
+
+/*
+ * Dense optimizer storage in charge of [range.begin(), range.end()), the slots of all the keys
+ * are interleaved in one array: [w_0, state_0..., w_1, state_1..., ...].
+ */
+template <typename Val, typename Optimizer>
+class VectorOptimizerStorage
+    : public OptimizerStorage<Val, Optimizer, VectorOptimizerStorage<Val, Optimizer>> {
+  using Base = OptimizerStorage<Val, Optimizer, VectorOptimizerStorage<Val, Optimizer>>;
+  friend Base;
+
+ public:
+  VectorOptimizerStorage(third_party::Range range, const OptimizerConfig& config, uint32_t chunk_size = 1)
+      : Base(config, chunk_size), range_(range), slots_(range.size() * Base::kWidth, Val()) {
+    CHECK_LE(range_.begin(), range_.end());
+  }
+
+  size_t Size() const { return range_.size(); }
+
+ private:
+  void CheckKeys(const third_party::SArray<Key>& typed_keys, uint32_t chunk_size) const {
+    CheckKeysInRange(typed_keys, range_, chunk_size);
+  }
+
+  Val* Slot(Key key) { return slots_.data() + (key - range_.begin()) * Base::kWidth; }
+  const Val* FindSlot(Key key) const { return slots_.data() + (key - range_.begin()) * Base::kWidth; }
+
+  third_party::Range range_;
+  std::vector<Val> slots_;
+};
+
+/*
+ * Sparse optimizer storage, every map node holds the whole slot of its key.
+ */
+template <typename Val, typename Optimizer>
+class MapOptimizerStorage
+    : public OptimizerStorage<Val, Optimizer, MapOptimizerStorage<Val, Optimizer>> {
+  using Base = OptimizerStorage<Val, Optimizer, MapOptimizerStorage<Val, Optimizer>>;
+  friend Base;
+
+ public:
+  MapOptimizerStorage(const OptimizerConfig& config, uint32_t chunk_size = 1) : Base(config, chunk_size) {}
+
+  size_t Size() const { return slots_.size(); }
+
+  virtual bool UnionGets() const override { return true; }
+
+ private:
+  void CheckKeys(const third_party::SArray<Key>& typed_keys, uint32_t chunk_size) const {}
+
+  // std::map value-initializes new slots, i.e. the weight and the state start at 0.
+  Val* Slot(Key key) { return slots_[key].data(); }
+  const Val* FindSlot(Key key) const {
+    auto it = slots_.find(key);
+    return it == slots_.end() ? nullptr : it->second.data();
+  }
+
+  std::map<Key, std::array<Val, Base::kWidth>> slots_;
+};
+
+}  // namespace flexps
@@ -0,0 +1,147 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/optimizer_storage.hpp"
+
+#include <cmath>
+
+namespace flexps {
+namespace {
+
+class TestOptimizerStorage : public testing::Test {
+ public:
+  TestOptimizerStorage() {}
+  ~TestOptimizerStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+// Push grads twice on keys and compare the weights with a reference slot updated by hand.
+template <typename Optimizer>
+void CheckAgainstReference(AbstractStorage* s, const OptimizerConfig& config) {
+  third_party::SArray<Key> keys({3, 4, 7});
+  third_party::SArray<float> grads({0.5, -1.0, 2.0});
+  s->SubAdd(keys, third_party::SArray<char>(grads));
+  s->SubAdd(keys, third_party::SArray<char>(grads));
+
+  Optimizer optimizer(config);
+  third_party::SArray<float> ret(s->SubGet(keys));
+  ASSERT_EQ(ret.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float slot[Optimizer::kWidth] = {};
+    optimizer.Update(slot, grads[i]);
+    optimizer.Update(slot, grads[i]);
+    EXPECT_FLOAT_EQ(ret[i], slot[0]);
+  }
+}
+
+TEST_F(TestOptimizerStorage, SGD) {
+  OptimizerConfig config;
+  config.learning_rate = 0.5;
+  VectorOptimizerStorage<float, SGD<float>> s({0, 10}, config);
+  third_party::SArray<Key> keys({1, 2});
+  third_party::SArray<float> grads({1.0, -2.0});
+  s.SubAdd(keys, third_party::SArray<char>(grads));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  EXPECT_FLOAT_EQ(ret[0], -0.5);
+  EXPECT_FLOAT_EQ(ret[1], 1.0);
+}
+
+TEST_F(TestOptimizerStorage, AdaGrad) {
+  OptimizerConfig config;
+  config.learning_rate = 1.0;
+  config.epsilon = 0.;
+  MapOptimizerStorage<float, AdaGrad<float>> s(config);
+  third_party::SArray<Key> keys({5});
+  third_party::SArray<float> grads({3.0});
+  s.SubAdd(keys, third_party::SArray<char>(grads));
+  s.SubAdd(keys, third_party::SArray<char>(grads));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  // -3 / sqrt(9) - 3 / sqrt(18)
+  EXPECT_FLOAT_EQ(ret[0], -1.0 - 3.0 / std::sqrt(18.0));
+}
+
+TEST_F(TestOptimizerStorage, AdamFirstStep) {
+  OptimizerConfig config;
+  config.learning_rate = 0.01;
+  VectorOptimizerStorage<float, Adam<float>> s({0, 10}, config);
+  third_party::SArray<Key> keys({0, 9});
+  third_party::SArray<float> grads({4.0, -0.1});
+  s.SubAdd(keys, third_party::SArray<char>(grads));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  // After the bias correction the first step is lr * sign(grad).
+  EXPECT_NEAR(ret[0], -0.01, 1e-6);
+  EXPECT_NEAR(ret[1], 0.01, 1e-6);
+}
+
+TEST_F(TestOptimizerStorage, FTRLL1) {
+  OptimizerConfig config;
+  config.l1 = 1.0;
+  MapOptimizerStorage<float, FTRL<float>> s(config);
+  third_party::SArray<Key> keys({1, 2});
+  third_party::SArray<float> grads({0.5, 2.0});
+  s.SubAdd(keys, third_party::SArray<char>(grads));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  // |z| <= l1 keeps the weight at 0.
+  EXPECT_EQ(ret[0], 0.);
+  EXPECT_LT(ret[1], 0.);
+}
+
+TEST_F(TestOptimizerStorage, AgainstReference) {
+  OptimizerConfig config;
+  config.l1 = 0.1;
+  config.l2 = 0.1;
+  {
+    VectorOptimizerStorage<float, AdaGrad<float>> s({0, 10}, config);
+    CheckAgainstReference<AdaGrad<float>>(&s, config);
+  }
+  {
+    MapOptimizerStorage<float, Adam<float>> s(config);
+    CheckAgainstReference<Adam<float>>(&s, config);
+  }
+  {
+    VectorOptimizerStorage<float, FTRL<float>> s({0, 10}, config);
+    CheckAgainstReference<FTRL<float>>(&s, config);
+  }
+}
+
+TEST_F(TestOptimizerStorage, Chunk) {
+  OptimizerConfig config;
+  config.learning_rate = 0.5;
+  VectorOptimizerStorage<float, SGD<float>> vs({0, 20}, config, 10);
+  MapOptimizerStorage<float, SGD<float>> ms(config, 10);
+  third_party::SArray<Key> keys({1});
+  third_party::SArray<float> grads(10);
+  for (int i = 0; i < 10; ++i)
+    grads[i] = i;
+  vs.SubAddChunk(keys, third_party::SArray<char>(grads));
+  ms.SubAddChunk(keys, third_party::SArray<char>(grads));
+
+  third_party::SArray<float> vret(vs.SubGetChunk(keys));
+  third_party::SArray<float> mret(ms.SubGetChunk(keys));
+  ASSERT_EQ(vret.size(), 10);
+  ASSERT_EQ(mret.size(), 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_FLOAT_EQ(vret[i], -0.5 * i);
+    EXPECT_FLOAT_EQ(mret[i], -0.5 * i);
+  }
+  // Element keys 10..19 are the elements of chunk 1.
+  third_party::SArray<Key> elem_keys({10, 19});
+  third_party::SArray<float> ret(vs.SubGet(elem_keys));
+  EXPECT_FLOAT_EQ(ret[0], 0.);
+  EXPECT_FLOAT_EQ(ret[1], -4.5);
+}
+
+TEST_F(TestOptimizerStorage, MapGetAbsent) {
+  OptimizerConfig config;
+  MapOptimizerStorage<float, Adam<float>> s(config);
+  third_party::SArray<Key> keys({100});
+  third_party::SArray<float> ret(s.SubGet(keys));
+  EXPECT_EQ(ret[0], 0.);
+  EXPECT_EQ(s.Size(), 0);
+}
+
+}  // namespace
+}  // namespace flexps
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace flexps {
+
+enum class OptimizerType { None, SGD, AdaGrad, Adam, FTRL };
+
+/*
+ * Hyper-parameters of the server-side optimizers, only the ones of the chosen type are used.
+ * With OptimizerType::None the table keeps the plain `storage[k] += val` semantics.
+ */
+struct OptimizerConfig {
+  OptimizerType type = OptimizerType::None;
+  float learning_rate = 0.1;  // also the alpha of FTRL
+  float epsilon = 1e-8;       // AdaGrad, Adam
+  float beta1 = 0.9;          // Adam
+  float beta2 = 0.999;        // Adam
+  float beta = 1.0;           // FTRL
+  float l1 = 0.;              // FTRL
+  float l2 = 0.;              // FTRL
+};
+
+/*
+ * An optimizer updates one parameter given its gradient. Every parameter owns a slot of kWidth
+ * values: slot[0] is the weight and the rest is the optimizer state, so a storage can keep the
+ * slots interleaved in one array and an update touches a single cache line.
+ */
+template <typename Val>
+struct SGD {
+  static_assert(std::is_floating_point<Val>::value, "Optimizers need a floating point Val");
+  static const uint32_t kWidth = 1;
+
+  explicit SGD(const OptimizerConfig& config) : lr(config.learning_rate) {}
+
+  void Update(Val* slot, Val grad) const { slot[0] -= lr * grad; }
+
+  Val lr;
+};
+
+// slot: [w, sum of squared gradients]
+template <typename Val>
+struct AdaGrad {
+  static_assert(std::is_floating_point<Val>::value, "Optimizers need a floating point Val");
+  static const uint32_t kWidth = 2;
+
+  explicit AdaGrad(const OptimizerConfig& config) : lr(config.learning_rate), epsilon(config.epsilon) {}
+
+  void Update(Val* slot, Val grad) const {
+    slot[1] += grad * grad;
+    slot[0] -= lr * grad / (std::sqrt(slot[1]) + epsilon);
+  }
+
+  Val lr;
+  Val epsilon;
+};
+
+/*
+ * slot: [w, m, v, t]. The step count t is kept per parameter so that the bias correction stays
+ * right for sparse tables in which a key is not updated every iteration.
+ */
+template <typename Val>
+struct Adam {
+  static_assert(std::is_floating_point<Val>::value, "Optimizers need a floating point Val");
+  static const uint32_t kWidth = 4;
+
+  explicit Adam(const OptimizerConfig& config)
+      : lr(config.learning_rate), epsilon(config.epsilon), beta1(config.beta1), beta2(config.beta2) {}
+
+  void Update(Val* slot, Val grad) const {
+    slot[3] += 1;
+    slot[1] = beta1 * slot[1] + (1 - beta1) * grad;
+    slot[2] = beta2 * slot[2] + (1 - beta2) * grad * grad;
+    Val m_hat = slot[1] / (1 - std::pow(beta1, slot[3]));
+    Val v_hat = slot[2] / (1 - std::pow(beta2, slot[3]));
+    slot[0] -= lr * m_hat / (std::sqrt(v_hat) + epsilon);
+  }
+
+  Val lr;
+  Val epsilon;
+  Val beta1;
+  Val beta2;
+};
+
+/*
+ * FTRL-Proximal, slot: [w, z, n]. The weight is recomputed from z and n on every update so that
+ * a Get is a plain read of slot[0].
+ */
+template <typename Val>
+struct FTRL {
+  static_assert(std::is_floating_point<Val>::value, "Optimizers need a floating point Val");
+  static const uint32_t kWidth = 3;
+
+  explicit FTRL(const OptimizerConfig& config)
+      : alpha(config.learning_rate), beta(config.beta), l1(config.l1), l2(config.l2) {}
+
+  void Update(Val* slot, Val grad) const {
+    Val n = slot[2] + grad * grad;
+    Val sigma = (std::sqrt(n) - std::sqrt(slot[2])) / alpha;
+    slot[1] += grad - sigma * slot[0];
+    slot[2] = n;
+    Val z = slot[1];
+    if (std::abs(z) <= l1)
+      slot[0] = 0;
+    else
+      slot[0] = -(z - (z > 0 ? l1 : -l1)) / ((beta + std::sqrt(n)) / alpha + l2);
+  }
+
+  Val alpha;
+  Val beta;
+  Val l1;
+  Val l2;
+};
+
+}  // namespace flexps
@@ -1,22 +1,72 @@
 #include "server/pending_buffer.hpp"
 
+#include "glog/logging.h"
+
 namespace flexps {
 
+const size_t PendingBuffer::kInitRingSize;
+
 std::vector<Message> PendingBuffer::Pop(const int clock, const int tid) {
   std::vector<Message> poped_msg;
-  if (buffer_.find(clock) != buffer_.end()) {
-    poped_msg = std::move(buffer_[clock]);
-    buffer_.erase(clock);
+  for (; base_ <= clock; ++base_) {
+    auto& slot = ring_[base_ % ring_.size()];
+    if (poped_msg.empty()) {
+      poped_msg.swap(slot);
+    } else {
+      for (auto& msg : slot)
+        poped_msg.push_back(std::move(msg));
+      slot.clear();
+    }
   }
   return poped_msg;
 }
 
+std::vector<Message> PendingBuffer::Drain() {
+  std::vector<Message> drained;
+  for (size_t i = 0; i < ring_.size(); ++i) {
+    auto& slot = ring_[(base_ + i) % ring_.size()];
+    for (auto& msg : slot)
+      drained.push_back(std::move(msg));
+    slot.clear();
+  }
+  return drained;
+}
+
+void PendingBuffer::Reset() {
+  ring_ = std::vector<std::vector<Message>>(kInitRingSize);
+  base_ = 0;
+}
+
 void PendingBuffer::Push(const int clock, Message& msg, const int tid) {
-  // Todo(Ruoyu Wu): check the clock passed in is less than the minimum clock in the buffer
-  buffer_[clock].push_back(std::move(msg)); 
+  CHECK_GE(clock, base_) << "Requests of a popped clock would never be popped";
+  if (static_cast<size_t>(clock - base_) >= ring_.size())
+    Grow(clock - base_ + 1);
+  ring_[clock % ring_.size()].push_back(std::move(msg));
 }
 
-int PendingBuffer::Size(const int progress) { return buffer_[progress].size(); }
+int PendingBuffer::Size(const int progress) {
+  if (progress < base_ || static_cast<size_t>(progress - base_) >= ring_.size())
+    return 0;
+  return ring_[progress % ring_.size()].size();
+}
 
-}  // namespace flexps
+int PendingBuffer::NumRequests() const {
+  size_t num = 0;
+  for (auto& slot : ring_)
+    num += slot.size();
+  return num;
+}
 
+void PendingBuffer::Grow(size_t min_size) {
+  size_t size = ring_.size();
+  while (size < min_size)
+    size *= 2;
+  std::vector<std::vector<Message>> ring(size);
+  for (size_t i = 0; i < ring_.size(); ++i) {
+    int clock = base_ + i;
+    ring[clock % size].swap(ring_[clock % ring_.size()]);
+  }
+  ring_.swap(ring);
+}
+
+}  // namespace flexps
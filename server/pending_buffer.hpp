@@ -3,19 +3,40 @@
 #include "base/message.hpp"
 #include "server/abstract_pending_buffer.hpp"
 
-#include <unordered_map>
+#include <vector>
 
 namespace flexps {
 
+/*
+ * The Get requests waiting for the min clock, indexed by the clock they wait for.
+ *
+ * The clocks waited for lie in a window just above the min clock, so the requests are kept in a ring
+ * of per-clock vectors: ring_[clock % ring_.size()] holds the requests of clock, for the clocks in
+ * [base_, base_ + ring_.size()). The ring grows when a request waits for a clock beyond it.
+ */
 class PendingBuffer : public AbstractPendingBuffer {
  public:
+  PendingBuffer() : ring_(kInitRingSize) {}
+
+  // Pop the requests of clock and of every clock before it, in clock order.
   virtual std::vector<Message> Pop(const int clock, const int tid = -1) override;
   virtual void Push(const int clock, Message& message, const int tid = -1) override;
   virtual int Size(const int progress) override;
+  // The number of requests of all clocks
+  int NumRequests() const;
+  // Remove every request, in clock order. Unlike Pop, the clocks from base_ on may still be pushed to.
+  std::vector<Message> Drain();
+  // Drop every request and start over from clock 0, for a new task (see AbstractModel::ResetWorker).
+  void Reset();
 
  private:
-  // TODO(Ruoyu Wu): each vec of buffer_ should be pop one by one, now it is not guaranteed
-  std::unordered_map<int, std::vector<Message>> buffer_;
+  static const size_t kInitRingSize = 8;
+
+  void Grow(size_t min_size);
+
+  std::vector<std::vector<Message>> ring_;
+  // The lowest clock not popped yet
+  int base_ = 0;
 };
 
 }  // namespace flexps
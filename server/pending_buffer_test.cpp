@@ -57,5 +57,86 @@ TEST_F(TestPendingBuffer, PushAndPop) {
   EXPECT_EQ(messages_1.size(), 1);
 }
 
+
+Message MakeGet(uint32_t sender) {
+  Message m;
+  m.meta.flag = Flag::kGet;
+  m.meta.sender = sender;
+  m.AddData(third_party::SArray<Key>({0}));
+  return m;
+}
+
+TEST_F(TestPendingBuffer, Grow) {
+  PendingBuffer pending_buffer;
+  // Far beyond the initial ring, with clocks in between.
+  for (int clock = 1; clock <= 100; clock += 3) {
+    Message m = MakeGet(clock);
+    pending_buffer.Push(clock, m);
+  }
+  EXPECT_EQ(pending_buffer.Size(1), 1);
+  EXPECT_EQ(pending_buffer.Size(2), 0);
+  EXPECT_EQ(pending_buffer.Size(100), 1);
+  EXPECT_EQ(pending_buffer.Size(1000), 0);
+  for (int clock = 0; clock <= 100; ++clock) {
+    auto msgs = pending_buffer.Pop(clock);
+    if (clock % 3 == 1) {
+      ASSERT_EQ(msgs.size(), 1);
+      EXPECT_EQ(msgs[0].meta.sender, clock);
+    } else {
+      EXPECT_EQ(msgs.size(), 0);
+    }
+  }
+}
+
+TEST_F(TestPendingBuffer, PopEarlierClocks) {
+  PendingBuffer pending_buffer;
+  Message m1 = MakeGet(1), m2 = MakeGet(2), m3 = MakeGet(3);
+  pending_buffer.Push(2, m2);
+  pending_buffer.Push(1, m1);
+  pending_buffer.Push(3, m3);
+  // Pop(2) releases clocks 1 and 2, in clock order.
+  auto msgs = pending_buffer.Pop(2);
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[0].meta.sender, 1);
+  EXPECT_EQ(msgs[1].meta.sender, 2);
+  EXPECT_EQ(pending_buffer.Size(1), 0);
+  EXPECT_EQ(pending_buffer.Size(3), 1);
+  EXPECT_EQ(pending_buffer.Pop(2).size(), 0);
+  EXPECT_EQ(pending_buffer.Pop(3).size(), 1);
+}
+
+TEST_F(TestPendingBuffer, Drain) {
+  PendingBuffer pending_buffer;
+  Message m1 = MakeGet(1), m2 = MakeGet(2), m3 = MakeGet(3);
+  pending_buffer.Push(1, m1);
+  EXPECT_EQ(pending_buffer.Pop(1).size(), 1);
+  pending_buffer.Push(4, m3);
+  pending_buffer.Push(2, m2);
+  auto msgs = pending_buffer.Drain();
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[0].meta.sender, 2);
+  EXPECT_EQ(msgs[1].meta.sender, 3);
+  EXPECT_EQ(pending_buffer.Size(4), 0);
+  // The clocks after the popped ones can still be pushed to.
+  pending_buffer.Push(2, msgs[0]);
+  EXPECT_EQ(pending_buffer.Pop(2).size(), 1);
+}
+
+TEST_F(TestPendingBuffer, Reset) {
+  PendingBuffer pending_buffer;
+  Message m1 = MakeGet(1), m2 = MakeGet(2), m3 = MakeGet(3);
+  pending_buffer.Push(3, m1);
+  EXPECT_EQ(pending_buffer.Pop(3).size(), 1);
+  pending_buffer.Push(20, m2);
+  pending_buffer.Reset();
+  EXPECT_EQ(pending_buffer.Size(20), 0);
+  // The clocks popped before the reset can be pushed to again.
+  pending_buffer.Push(1, m3);
+  EXPECT_EQ(pending_buffer.Size(1), 1);
+  auto msgs = pending_buffer.Pop(1);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].meta.sender, 3);
+}
+
 }  // namespace
 }  // namespace flexps
\ No newline at end of file
@@ -5,54 +5,107 @@
 namespace flexps {
 
 void ProgressTracker::Init(const std::vector<uint32_t>& tids) {
+  index_.clear();
+  tids_.clear();
   progresses_.clear();
   for (auto tid : tids) {
-    progresses_.insert({tid, 0});
+    if (index_.insert({tid, progresses_.size()}).second) {
+      tids_.push_back(tid);
+      progresses_.push_back(0);
+    }
   }
   min_clock_ = 0;
+  num_at_clock_.assign(1, progresses_.size());
+  members_.clear();
+}
+
+void ProgressTracker::SetMembers(const std::vector<uint32_t>& tids) {
+  members_.clear();
+  for (auto tid : tids)
+    members_[tid] = min_clock_;
+}
+
+void ProgressTracker::ReportProgress(int tid, int clock) {
+  auto it = members_.find(tid);
+  CHECK(it != members_.end()) << "Unknown member " << tid;
+  it->second = clock;
 }
 
 int ProgressTracker::AdvanceAndGetChangedMinClock(int tid) {
-  CHECK(CheckThreadValid(tid));
-  if (IsUniqueMin(tid)) {
+  int& progress = progresses_[IndexOf(tid)];
+  size_t slot = progress - min_clock_;
+  progress += 1;
+  num_at_clock_[slot] -= 1;
+  if (slot + 1 == num_at_clock_.size())
+    num_at_clock_.push_back(0);
+  num_at_clock_[slot + 1] += 1;
+  // The last thread at the min clock has left it, and it is at min_clock_ + 1 now.
+  if (num_at_clock_.front() == 0) {
+    num_at_clock_.pop_front();
     min_clock_ += 1;
-    progresses_[tid] += 1;
     return min_clock_;
-  } else {
-    progresses_[tid] += 1;
+  }
+  return -1;
+}
+
+int ProgressTracker::RemoveThread(int tid) {
+  int index = IndexOf(tid);
+  num_at_clock_[progresses_[index] - min_clock_] -= 1;
+  // Move the last thread into the index
+  index_[tids_.back()] = index;
+  tids_[index] = tids_.back();
+  progresses_[index] = progresses_.back();
+  tids_.pop_back();
+  progresses_.pop_back();
+  index_.erase(tid);
+  if (progresses_.empty()) {
+    num_at_clock_.assign(1, 0);
     return -1;
   }
+  if (num_at_clock_.front() != 0)
+    return -1;
+  while (num_at_clock_.front() == 0) {
+    num_at_clock_.pop_front();
+    min_clock_ += 1;
+  }
+  return min_clock_;
 }
 
 int ProgressTracker::GetNumThreads() const { return progresses_.size(); }
 
+std::vector<int> ProgressTracker::GetThreadsAtMinClock() const {
+  std::vector<int> tids;
+  tids.reserve(num_at_clock_.front());
+  for (size_t i = 0; i < progresses_.size(); ++i) {
+    if (progresses_[i] == min_clock_)
+      tids.push_back(tids_[i]);
+  }
+  return tids;
+}
+
 int ProgressTracker::GetProgress(int tid) const {
-  CHECK(CheckThreadValid(tid));
-  auto it = progresses_.find(tid);
-  return it->second;
+  auto it = index_.find(tid);
+  if (it != index_.end())
+    return progresses_[it->second];
+  auto member = members_.find(tid);
+  CHECK(member != members_.end()) << "Unknown thread " << tid;
+  return member->second;
 }
 
 int ProgressTracker::GetMinClock() const { return min_clock_; }
 
 bool ProgressTracker::IsUniqueMin(int tid) const {
-  CHECK(CheckThreadValid(tid));
-  auto it = progresses_.find(tid);
-  if (it->second != min_clock_) {
-    return false;
-  }
-  int min_count = 0;
-  for (auto it : progresses_) {
-    if (it.second == min_clock_)
-      min_count += 1;
-    if (min_count > 1)
-      return false;
-  }
-  return true;
+  return progresses_[IndexOf(tid)] == min_clock_ && num_at_clock_.front() == 1;
 }
 
 bool ProgressTracker::CheckThreadValid(int tid) const {
-  auto it = progresses_.find(tid);
-  return it != progresses_.end();
+  return index_.find(tid) != index_.end() || members_.find(tid) != members_.end();
+}
+
+int ProgressTracker::IndexOf(int tid) const {
+  auto it = index_.find(tid);
+  CHECK(it != index_.end()) << "Unknown thread " << tid;
+  return it->second;
 }
 
 }  // namespace flexps
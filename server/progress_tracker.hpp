@@ -1,28 +1,63 @@
 #pragma once
 
-#include <map>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 
 namespace flexps {
 
+/*
+ * The clocks of the worker threads of a model.
+ *
+ * The threads get dense indices at Init, so a clock is one hash lookup plus a vector access. Next
+ * to the clocks, num_at_clock_[c - min_clock_] counts the threads at clock c, which makes advancing
+ * and checking the min clock O(1) instead of a scan over every thread.
+ *
+ * Threads may leave after Init (see KVEngine::RetireWorkers), and the min clock may move up by several
+ * clocks when the thread alone at it leaves.
+ *
+ * With node clocks (see NodeClockAggregator), the threads tracked are the nodes, one clock each,
+ * and the worker threads of the nodes are members: they are valid threads whose progress is the
+ * clock they report with their requests.
+ */
 class ProgressTracker {
  public:
   void Init(const std::vector<uint32_t>& tids);
+  // Let the tids report their progress, after Init.
+  void SetMembers(const std::vector<uint32_t>& tids);
+  void ReportProgress(int tid, int clock);
   /*
    * Advance the progress.
    * Return -1 if min_clock_ does not change,
    * return min_clock_ otherwise.
    */
   int AdvanceAndGetChangedMinClock(int tid);
+  /*
+   * Stop tracking tid.
+   * Return -1 if min_clock_ does not change,
+   * return min_clock_ otherwise.
+   */
+  int RemoveThread(int tid);
   int GetProgress(int tid) const;
   int GetMinClock() const;
   int GetNumThreads() const;
+  int GetNumThreadsAtMinClock() const { return num_at_clock_.front(); }
+  std::vector<int> GetThreadsAtMinClock() const;
   bool IsUniqueMin(int tid) const;
   bool CheckThreadValid(int tid) const;
 
  private:
-  std::map<int, int> progresses_;
+  // The dense index of tid, which must be valid.
+  int IndexOf(int tid) const;
+
+  std::unordered_map<int, int> index_;
+  // By dense index
+  std::vector<int> tids_;
+  std::vector<int> progresses_;
+  std::deque<int> num_at_clock_;
   int min_clock_;
+  // <tid, reported progress> of the members
+  std::unordered_map<int, int> members_;
 };
 
 }  // namespace flexps
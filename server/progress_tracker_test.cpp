@@ -46,5 +46,109 @@ TEST_F(TestProgressTracker, Advance) {
   EXPECT_EQ(tracker.GetProgress(7), 3);
 }
 
+
+TEST_F(TestProgressTracker, IsUniqueMin) {
+  ProgressTracker tracker;
+  tracker.Init({2, 7, 9});
+  EXPECT_FALSE(tracker.IsUniqueMin(2));
+  tracker.AdvanceAndGetChangedMinClock(2);  // [1,0,0]
+  EXPECT_FALSE(tracker.IsUniqueMin(2));
+  EXPECT_FALSE(tracker.IsUniqueMin(7));
+  tracker.AdvanceAndGetChangedMinClock(7);  // [1,1,0]
+  EXPECT_TRUE(tracker.IsUniqueMin(9));
+  EXPECT_FALSE(tracker.IsUniqueMin(7));
+}
+
+TEST_F(TestProgressTracker, RunAhead) {
+  ProgressTracker tracker;
+  tracker.Init({2, 7, 9});
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(9), -1);  // [0,0,5]
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(2), -1);    // [1,0,5]
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(7), 1);     // [1,1,5]
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(2), -1);    // [2,1,5]
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(7), 2);     // [2,2,5]
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(7), -1);    // [2,3,5]
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(2), 3);     // [3,3,5]
+  EXPECT_EQ(tracker.GetMinClock(), 3);
+  EXPECT_EQ(tracker.GetProgress(9), 5);
+}
+
+TEST_F(TestProgressTracker, ManyThreads) {
+  const int kNumThreads = 1000;
+  std::vector<uint32_t> tids;
+  for (int i = 0; i < kNumThreads; ++i)
+    tids.push_back((i / 10) * 1000 + 100 + i % 10);
+  ProgressTracker tracker;
+  tracker.Init(tids);
+  EXPECT_EQ(tracker.GetNumThreads(), kNumThreads);
+  for (int clock = 1; clock <= 3; ++clock) {
+    // In reverse, the min clock moves with the last thread only.
+    for (int i = kNumThreads - 1; i > 0; --i)
+      EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(tids[i]), -1);
+    EXPECT_TRUE(tracker.IsUniqueMin(tids[0]));
+    EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(tids[0]), clock);
+  }
+  for (auto tid : tids)
+    EXPECT_EQ(tracker.GetProgress(tid), 3);
+}
+
+TEST_F(TestProgressTracker, ReInit) {
+  ProgressTracker tracker;
+  tracker.Init({2, 7});
+  tracker.AdvanceAndGetChangedMinClock(2);
+  tracker.AdvanceAndGetChangedMinClock(7);
+  tracker.Init({3});
+  EXPECT_EQ(tracker.GetMinClock(), 0);
+  EXPECT_FALSE(tracker.CheckThreadValid(2));
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(3), 1);
+}
+
+TEST_F(TestProgressTracker, RemoveThread) {
+  ProgressTracker tracker;
+  tracker.Init({2, 5, 7, 9});
+  for (int i = 0; i < 4; ++i)
+    tracker.AdvanceAndGetChangedMinClock(9);  // [0,0,0,4]
+  tracker.AdvanceAndGetChangedMinClock(7);    // [0,0,1,4]
+  tracker.AdvanceAndGetChangedMinClock(5);    // [0,1,1,4]
+  tracker.AdvanceAndGetChangedMinClock(5);    // [0,2,1,4]
+
+  // The straggler leaves, the min clock moves to the next slowest
+  EXPECT_EQ(tracker.RemoveThread(2), 1);  // [-,2,1,4]
+  EXPECT_FALSE(tracker.CheckThreadValid(2));
+  EXPECT_EQ(tracker.GetNumThreads(), 3);
+  EXPECT_EQ(tracker.RemoveThread(9), -1);  // [-,2,1,-]
+  EXPECT_EQ(tracker.GetProgress(5), 2);
+  EXPECT_TRUE(tracker.IsUniqueMin(7));
+  // Over several clocks at once
+  tracker.AdvanceAndGetChangedMinClock(5);  // [-,3,1,-]
+  EXPECT_EQ(tracker.RemoveThread(7), 3);    // [-,3,-,-]
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(5), 4);
+
+  // The last thread leaves
+  EXPECT_EQ(tracker.RemoveThread(5), -1);
+  EXPECT_EQ(tracker.GetNumThreads(), 0);
+}
+
+TEST_F(TestProgressTracker, Members) {
+  ProgressTracker tracker;
+  // Nodes 20 and 1020, their workers report their own clocks
+  tracker.Init({20, 1020});
+  tracker.SetMembers({1100, 1101, 2100});
+  EXPECT_TRUE(tracker.CheckThreadValid(1101));
+  EXPECT_FALSE(tracker.CheckThreadValid(1102));
+  EXPECT_EQ(tracker.GetNumThreads(), 2);
+  EXPECT_EQ(tracker.GetProgress(1100), 0);
+  tracker.ReportProgress(1100, 2);
+  EXPECT_EQ(tracker.GetProgress(1100), 2);
+  EXPECT_EQ(tracker.GetProgress(1101), 0);
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(20), -1);
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(1020), 1);
+  EXPECT_EQ(tracker.GetProgress(20), 1);
+
+  tracker.Init({20});
+  EXPECT_FALSE(tracker.CheckThreadValid(1100));
+}
+
 }  // namespace
 }  // namespace flexps
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace flexps {
+
+/*
+ * Codecs of QuantizedStorage, which stores every value as a Code and decodes it to float.
+ *
+ * A codec provides
+ *   using Code;
+ *   static const uint32_t kBlockSize;  // the number of values sharing one float scale, 1 for none
+ *   static const int kMaxCode;         // scaled codecs only, the largest |code|
+ *   static Code Encode(float val, float scale, uint32_t rand);
+ *   static float DecodeOne(Code code, float scale);
+ *   static void Decode(const Code* codes, float scale, float* dst, size_t n);
+ *
+ * Encode rounds stochastically with the 32 random bits rand: val is rounded to one of its two
+ * neighbouring codes with probabilities proportional to the distance to the other one, so the
+ * rounding is unbiased and many small Adds accumulate in expectation instead of being rounded
+ * away. Decode uses F16C/AVX2 when the translation unit is compiled for them.
+ */
+
+inline uint32_t FloatToBits(float val) {
+  uint32_t bits;
+  memcpy(&bits, &val, sizeof(bits));
+  return bits;
+}
+
+inline float BitsToFloat(uint32_t bits) {
+  float val;
+  memcpy(&val, &bits, sizeof(val));
+  return val;
+}
+
+// A uniform float in [0, 1) from 32 random bits.
+inline float UniformFloat(uint32_t rand) { return (rand >> 8) * (1.0f / 16777216.0f); }
+
+// The random bits of the stochastic rounding, xorshift32.
+class XorShift32 {
+ public:
+  explicit XorShift32(uint32_t seed = 2463534242u) : state_(seed ? seed : 2463534242u) {}
+  uint32_t operator()() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return state_;
+  }
+
+ private:
+  uint32_t state_;
+};
+
+// IEEE half precision, rounded toward zero. Magnitudes beyond the largest half saturate to it.
+inline uint16_t FloatToHalfTruncate(float val) {
+  uint32_t bits = FloatToBits(val);
+  uint16_t sign = (bits >> 16) & 0x8000;
+  uint32_t abs = bits & 0x7fffffff;
+  if (abs > 0x7f800000)
+    return sign | 0x7e00;  // NaN
+  if (abs >= 0x477fe000)
+    return sign | 0x7bff;  // >= 65504
+  int exp = static_cast<int>(abs >> 23) - 127;
+  if (exp >= -14)
+    return sign | ((exp + 15) << 10) | ((abs >> 13) & 0x3ff);
+  if (exp < -24)
+    return sign;
+  // Subnormal, m * 2^-24
+  return sign | (((abs & 0x7fffff) | 0x800000) >> (-1 - exp));
+}
+
+inline float HalfToFloat(uint16_t half) {
+  uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  uint32_t exp = (half >> 10) & 0x1f;
+  uint32_t mant = half & 0x3ff;
+  if (exp == 0) {
+    float val = mant * (1.0f / 16777216.0f);
+    return sign ? -val : val;
+  }
+  if (exp == 31)
+    return BitsToFloat(sign | 0x7f800000 | (mant << 13));
+  return BitsToFloat(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+// IEEE half precision: 2 bytes, 11 significant bits, magnitudes up to 65504.
+struct Fp16 {
+  using Code = uint16_t;
+  static const uint32_t kBlockSize = 1;
+
+  static Code Encode(float val, float, uint32_t rand) {
+    Code low = FloatToHalfTruncate(val);
+    if ((low & 0x7fff) >= 0x7bff)
+      return low;  // saturated or NaN
+    // low + 1 is the next half away from zero, as the bit patterns are ordered by magnitude.
+    float low_abs = std::fabs(HalfToFloat(low));
+    float high_abs = std::fabs(HalfToFloat(low + 1));
+    float p = (std::fabs(val) - low_abs) / (high_abs - low_abs);
+    return UniformFloat(rand) < p ? low + 1 : low;
+  }
+
+  static float DecodeOne(Code code, float) { return HalfToFloat(code); }
+
+  static void Decode(const Code* codes, float, float* dst, size_t n) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+      _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i))));
+#endif
+    for (; i < n; ++i)
+      dst[i] = HalfToFloat(codes[i]);
+  }
+};
+
+// bfloat16, the upper half of a float: 2 bytes, 8 significant bits, the range of float.
+struct BF16 {
+  using Code = uint16_t;
+  static const uint32_t kBlockSize = 1;
+
+  static Code Encode(float val, float, uint32_t rand) {
+    uint32_t bits = FloatToBits(val);
+    if ((bits & 0x7fffffff) > 0x7f800000)
+      return (bits >> 16) | 0x40;  // keep NaN a NaN
+    // The low 16 bits carry into the magnitude with probability low / 2^16.
+    bits += rand & 0xffff;
+    return bits >> 16;
+  }
+
+  static float DecodeOne(Code code, float) { return BitsToFloat(static_cast<uint32_t>(code) << 16); }
+
+  static void Decode(const Code* codes, float, float* dst, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+      __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i)));
+      _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16)));
+    }
+#endif
+    for (; i < n; ++i)
+      dst[i] = DecodeOne(codes[i], 1.0f);
+  }
+};
+
+// int8 with one float scale per block of kBlockSize values: value = code * scale.
+struct Int8 {
+  using Code = int8_t;
+  static const uint32_t kBlockSize = 64;
+  static const int kMaxCode = 127;
+
+  static Code Encode(float val, float scale, uint32_t rand) {
+    if (scale == 0)
+      return 0;
+    float x = val / scale;
+    float low = std::floor(x);
+    float code = low + (UniformFloat(rand) < x - low);
+    code = code > kMaxCode ? kMaxCode : code;
+    code = code < -kMaxCode ? -kMaxCode : code;
+    return static_cast<Code>(code);
+  }
+
+  static float DecodeOne(Code code, float scale) { return code * scale; }
+
+  static void Decode(const Code* codes, float scale, float* dst, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256 scales = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+      __m256i wide = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(codes + i)));
+      _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scales));
+    }
+#endif
+    for (; i < n; ++i)
+      dst[i] = codes[i] * scale;
+  }
+};
+
+}  // namespace flexps
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "base/key_ranges.hpp"
+#include "base/message.hpp"
+#include "base/third_party/range.h"
+#include "server/abstract_storage.hpp"
+#include "server/quantization.hpp"
+#include "server/simd_kernels.hpp"
+#include "server/vector_storage.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * A dense storage like VectorStorage that keeps the values quantized by Codec (Fp16, BF16 or Int8,
+ * see server/quantization.hpp) to fit 2x (fp16/bf16) or almost 4x (int8) more parameters per
+ * server and to read less memory per Get. Val is the type on the wire, float or double.
+ *
+ * An Add decodes the stored values to float, adds and encodes them back with stochastic rounding,
+ * so updates smaller than the precision of the code still add up in expectation. For Int8, each
+ * block of Int8::kBlockSize values shares a scale of absmax / kMaxCode: an Add that outgrows the
+ * scale, or shrinks the block under a quarter of it, rescales and re-encodes the whole block.
+ * A Get decodes whole runs with the SIMD kernels of the codec.
+ */
+template <typename Val, typename Codec>
+class QuantizedStorage : public AbstractStorage {
+  static_assert(std::is_floating_point<Val>::value, "QuantizedStorage needs a floating point Val");
+  using Code = typename Codec::Code;
+  static const uint32_t kBlockSize = Codec::kBlockSize;
+  static const bool kScaled = kBlockSize > 1;
+  using Scaled = std::integral_constant<bool, kScaled>;
+  // Values decoded at a time when Val is not float
+  static const size_t kBufferSize = 256;
+
+ public:
+  QuantizedStorage() = delete;
+  /*
+   * The storage is in charge of range [range.begin(), range.end()).
+   */
+  QuantizedStorage(third_party::Range range, uint32_t chunk_size = 1)
+      : range_(range),
+        codes_(range.size(), Code()),
+        scales_(kScaled ? (range.size() + kBlockSize - 1) / kBlockSize : 0, 0.0f),
+        chunk_size_(chunk_size),
+        rand_(static_cast<uint32_t>(range.begin()) * 2654435761u + 1) {
+    CHECK_LE(range_.begin(), range_.end());
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size(), typed_vals.size());
+    CheckKeysInRange(typed_keys, range_);
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      AddRun(typed_keys[begin] - range_.begin(), typed_vals.data() + begin, len, Scaled());
+    });
+  }
+
+  virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_vals.size()/typed_keys.size(), chunk_size_);
+    CheckKeysInRange(typed_keys, range_, chunk_size_);
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      AddRun(typed_keys[begin] * chunk_size_ - range_.begin(), typed_vals.data() + begin * chunk_size_,
+             len * chunk_size_, Scaled());
+    });
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(new Val[typed_keys.size()], typed_keys.size(), true);
+    CheckKeysInRange(typed_keys, range_);
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      GetRun(reply_vals.data() + begin, typed_keys[begin] - range_.begin(), len, std::is_same<Val, float>());
+    });
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(new Val[typed_keys.size() * chunk_size_], typed_keys.size() * chunk_size_, true);
+    CheckKeysInRange(typed_keys, range_, chunk_size_);
+    ForEachRun(typed_keys.data(), typed_keys.size(), [&](size_t begin, size_t len) {
+      GetRun(reply_vals.data() + begin * chunk_size_, typed_keys[begin] * chunk_size_ - range_.begin(),
+             len * chunk_size_, std::is_same<Val, float>());
+    });
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual void SubAddRange(const third_party::SArray<Key>& ranges, const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(NumKeysInRanges(ranges), typed_vals.size());
+    CheckKeyRangesInRange(ranges, range_);
+    ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+      AddRun(first - range_.begin(), typed_vals.data() + pos, len, Scaled());
+    });
+  }
+
+  virtual third_party::SArray<char> SubGetRange(const third_party::SArray<Key>& ranges) override {
+    size_t num_keys = NumKeysInRanges(ranges);
+    third_party::SArray<Val> reply_vals(new Val[num_keys], num_keys, true);
+    CheckKeyRangesInRange(ranges, range_);
+    ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+      GetRun(reply_vals.data() + pos, first - range_.begin(), len, std::is_same<Val, float>());
+    });
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual void FinishIter() override {}
+
+  // In full precision, the summed Adds are rounded once instead of once per Add.
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return std::unique_ptr<AbstractStorage>(new VectorStorage<Val>(range_, chunk_size_));
+  }
+
+  Key GetBegin() { return range_.begin(); }
+  Key GetEnd() { return range_.end(); }
+  size_t Size() const { return range_.size(); }
+  // The memory taken by the values
+  size_t Bytes() const { return codes_.size() * sizeof(Code) + scales_.size() * sizeof(float); }
+
+ private:
+  // Add vals[0, len) to the values at [offset, offset + len) of the range.
+  void AddRun(size_t offset, const Val* vals, size_t len, std::false_type) {
+    for (size_t i = 0; i < len; ++i) {
+      float val = Codec::DecodeOne(codes_[offset + i], 1.0f) + static_cast<float>(vals[i]);
+      codes_[offset + i] = Codec::Encode(val, 1.0f, rand_());
+    }
+  }
+
+  // One block at a time
+  void AddRun(size_t offset, const Val* vals, size_t len, std::true_type) {
+    for (size_t end = offset + len; offset < end;) {
+      size_t block = offset / kBlockSize;
+      size_t block_begin = block * kBlockSize;
+      size_t block_end = std::min<size_t>(block_begin + kBlockSize, codes_.size());
+      size_t seg_end = std::min(end, block_end);
+      AddToBlock(block, block_begin, block_end, offset, seg_end, vals);
+      vals += seg_end - offset;
+      offset = seg_end;
+    }
+  }
+
+  // Add vals to the values at [begin, end) of the block spanning [block_begin, block_end).
+  void AddToBlock(size_t block, size_t block_begin, size_t block_end, size_t begin, size_t end, const Val* vals) {
+    float decoded[kBlockSize];
+    float scale = scales_[block];
+    Codec::Decode(codes_.data() + block_begin, scale, decoded, block_end - block_begin);
+    float absmax = 0;
+    for (size_t i = begin; i < end; ++i)
+      decoded[i - block_begin] += static_cast<float>(vals[i - begin]);
+    for (size_t i = 0; i < block_end - block_begin; ++i)
+      absmax = std::max(absmax, std::fabs(decoded[i]));
+    float limit = scale * Codec::kMaxCode;
+    if (absmax > limit || absmax < limit / 4) {
+      // Rescale, every value of the block is re-encoded.
+      scales_[block] = absmax / Codec::kMaxCode;
+      begin = block_begin;
+      end = block_end;
+    }
+    for (size_t i = begin; i < end; ++i)
+      codes_[i] = Codec::Encode(decoded[i - block_begin], scales_[block], rand_());
+  }
+
+  // Decode the values at [offset, offset + len) of the range to dst.
+  void Decode(size_t offset, size_t len, float* dst) const {
+    if (!kScaled) {
+      Codec::Decode(codes_.data() + offset, 1.0f, dst, len);
+      return;
+    }
+    for (size_t end = offset + len; offset < end;) {
+      size_t block = offset / kBlockSize;
+      size_t seg_end = std::min(end, (block + 1) * kBlockSize);
+      Codec::Decode(codes_.data() + offset, scales_[block], dst, seg_end - offset);
+      dst += seg_end - offset;
+      offset = seg_end;
+    }
+  }
+
+  void GetRun(Val* dst, size_t offset, size_t len, std::true_type) const { Decode(offset, len, dst); }
+
+  // Val is double, decode through a float buffer.
+  void GetRun(Val* dst, size_t offset, size_t len, std::false_type) const {
+    float buffer[kBufferSize];
+    for (size_t i = 0; i < len; i += kBufferSize) {
+      size_t n = len - i < kBufferSize ? len - i : kBufferSize;
+      Decode(offset + i, n, buffer);
+      for (size_t j = 0; j < n; ++j)
+        dst[i + j] = buffer[j];
+    }
+  }
+
+  third_party::Range range_;
+  std::vector<Code> codes_;
+  // One per block of kBlockSize codes, empty if the codec has no scale
+  std::vector<float> scales_;
+  uint32_t chunk_size_;
+  XorShift32 rand_;
+};
+
+}  // namespace flexps
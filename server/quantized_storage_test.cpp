@@ -0,0 +1,140 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/quantized_storage.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace flexps {
+namespace {
+
+class TestQuantizedStorage : public testing::Test {
+ public:
+  TestQuantizedStorage() {}
+  ~TestQuantizedStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+// Relative error bounds of a single encode with stochastic rounding
+template <typename Codec> float Tolerance();
+template <> float Tolerance<Fp16>() { return 1.0f / 1024; }
+template <> float Tolerance<BF16>() { return 1.0f / 128; }
+template <> float Tolerance<Int8>() { return 1.0f / 127; }
+
+template <typename Val, typename Codec>
+void CheckAddGet() {
+  QuantizedStorage<Val, Codec> s({10, 1010});
+  third_party::SArray<Key> keys(1000);
+  third_party::SArray<Val> vals(1000);
+  Val absmax = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = 10 + i;
+    vals[i] = std::sin(i * 0.1) * (i % 7 + 1);
+    absmax = std::max<Val>(absmax, std::fabs(vals[i]));
+  }
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  third_party::SArray<Val> ret(s.SubGet(keys));
+  ASSERT_EQ(ret.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    // Int8 errors are relative to the block scale, the others to the value itself
+    Val bound = (Codec::kBlockSize > 1 ? absmax : std::fabs(vals[i])) * Tolerance<Codec>();
+    EXPECT_NEAR(ret[i], vals[i], bound) << "key " << keys[i];
+  }
+}
+
+TEST_F(TestQuantizedStorage, AddGet) {
+  CheckAddGet<float, Fp16>();
+  CheckAddGet<float, BF16>();
+  CheckAddGet<float, Int8>();
+  CheckAddGet<double, Fp16>();
+  CheckAddGet<double, BF16>();
+  CheckAddGet<double, Int8>();
+}
+
+TEST_F(TestQuantizedStorage, HalfConversions) {
+  // Normal, largest, smallest normal and smallest subnormal halves
+  for (float val : {0.f, 1.f, -2.5f, 65504.f, 6.103515625e-05f, 5.960464477539063e-08f})
+    EXPECT_EQ(HalfToFloat(FloatToHalfTruncate(val)), val);
+  EXPECT_EQ(HalfToFloat(FloatToHalfTruncate(1e6f)), 65504.f);
+  EXPECT_EQ(HalfToFloat(FloatToHalfTruncate(1.0009f)), 1.f);
+  EXPECT_EQ(HalfToFloat(FloatToHalfTruncate(-1.0009f)), -1.f);
+  // Every half survives the round trip, and SIMD and scalar decodes agree.
+  std::vector<uint16_t> codes;
+  for (uint32_t h = 0; h < 0x10000; ++h)
+    if ((h & 0x7c00) != 0x7c00)
+      codes.push_back(h);
+  std::vector<float> decoded(codes.size());
+  Fp16::Decode(codes.data(), 1.0f, decoded.data(), codes.size());
+  for (size_t i = 0; i < codes.size(); ++i) {
+    ASSERT_EQ(decoded[i], HalfToFloat(codes[i]));
+    ASSERT_EQ(FloatToHalfTruncate(decoded[i]), codes[i]);
+  }
+}
+
+template <typename Codec>
+float MeanAfterSmallAdds() {
+  // 1 + 1e-4 rounds to 1 in bf16 and fp16: with round-to-nearest the values would never move.
+  const Key kNumKeys = 1000;
+  QuantizedStorage<float, Codec> s({0, kNumKeys});
+  third_party::SArray<Key> keys(kNumKeys);
+  for (Key i = 0; i < kNumKeys; ++i)
+    keys[i] = i;
+  s.SubAdd(keys, third_party::SArray<char>(third_party::SArray<float>(kNumKeys, 1)));
+  third_party::SArray<float> small(kNumKeys, 1e-4);
+  for (int i = 0; i < 1000; ++i)
+    s.SubAdd(keys, third_party::SArray<char>(small));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  double sum = 0;
+  for (float val : ret)
+    sum += val;
+  return sum / kNumKeys;
+}
+
+TEST_F(TestQuantizedStorage, StochasticRounding) {
+  EXPECT_NEAR(MeanAfterSmallAdds<BF16>(), 1.1, 0.01);
+  EXPECT_NEAR(MeanAfterSmallAdds<Fp16>(), 1.1, 0.01);
+}
+
+TEST_F(TestQuantizedStorage, Int8Rescale) {
+  QuantizedStorage<float, Int8> s({0, 128});
+  third_party::SArray<Key> keys({0, 1, 63, 64});
+  s.SubAdd(keys, third_party::SArray<char>(third_party::SArray<float>({1, -1, 0.5, 3})));
+  // Grows the scale of the first block only
+  s.SubAdd(third_party::SArray<Key>({2}), third_party::SArray<char>(third_party::SArray<float>({100})));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  EXPECT_NEAR(ret[0], 1, 100.0 / 127);
+  EXPECT_NEAR(ret[1], -1, 100.0 / 127);
+  EXPECT_NEAR(ret[2], 0.5, 100.0 / 127);
+  EXPECT_NEAR(ret[3], 3, 3.0 / 127);
+  EXPECT_NEAR(third_party::SArray<float>(s.SubGet(third_party::SArray<Key>({2})))[0], 100, 100.0 / 127);
+}
+
+TEST_F(TestQuantizedStorage, Chunk) {
+  QuantizedStorage<float, Int8> s({0, 200}, 10);
+  third_party::SArray<Key> keys({5, 6, 19});
+  third_party::SArray<float> vals(30);
+  for (int i = 0; i < 30; ++i)
+    vals[i] = i;
+  s.SubAddChunk(keys, third_party::SArray<char>(vals));
+  third_party::SArray<float> ret(s.SubGetChunk(keys));
+  ASSERT_EQ(ret.size(), 30);
+  for (int i = 0; i < 30; ++i)
+    EXPECT_NEAR(ret[i], i, 30.0 / 127);
+}
+
+TEST_F(TestQuantizedStorage, Bytes) {
+  const Key kSize = 1 << 16;
+  QuantizedStorage<float, Fp16> fp16({0, kSize});
+  QuantizedStorage<float, BF16> bf16({0, kSize});
+  QuantizedStorage<float, Int8> int8({0, kSize});
+  EXPECT_EQ(fp16.Bytes(), kSize * 2);
+  EXPECT_EQ(bf16.Bytes(), kSize * 2);
+  EXPECT_EQ(int8.Bytes(), kSize + kSize / Int8::kBlockSize * 4);
+}
+
+}  // namespace
+}  // namespace flexps
@@ -54,6 +54,7 @@ void ServerThread::Main() {
       break;
     }
     case Flag::kAddChunk:
+    case Flag::kAddRange:
     case Flag::kAdd: {
 #ifdef USE_TIMER
       auto start_time = std::chrono::steady_clock::now();
@@ -66,6 +67,7 @@ void ServerThread::Main() {
       break;
     }
     case Flag::kGetChunk:
+    case Flag::kGetRange:
     case Flag::kGet: {
 #ifdef USE_TIMER
       auto start_time = std::chrono::steady_clock::now();
@@ -82,6 +84,27 @@ void ServerThread::Main() {
 
       break;
     }
+    case Flag::kCheckpoint: {
+      models_[model_id]->Checkpoint(msg);
+      break;
+    }
+    case Flag::kLoad:
+    case Flag::kRestore: {
+      models_[model_id]->Load(msg);
+      break;
+    }
+    case Flag::kSubscribe: {
+      models_[model_id]->Subscribe(msg);
+      break;
+    }
+    case Flag::kAdaptStaleness: {
+      models_[model_id]->AdaptStaleness(msg);
+      break;
+    }
+    case Flag::kRetireWorkers: {
+      models_[model_id]->RetireWorkers(msg);
+      break;
+    }
     default:
       CHECK(false) << "Unknown flag in msg: " << FlagName[static_cast<int>(msg.meta.flag)];
     }
@@ -3,7 +3,9 @@
 #include "base/message.hpp"
 #include "base/threadsafe_queue.hpp"
 #include "server/abstract_model.hpp"
+#include "server/apply_pool.hpp"
 
+#include <memory>
 #include <thread>
 #include <unordered_map>
 #ifdef USE_TIMER
@@ -16,7 +18,11 @@ namespace flexps {
 
 class ServerThread {
  public:
-  ServerThread(uint32_t server_id) : server_id_(server_id) {}
+  // num_apply_threads > 0 gives the thread an ApplyPool of that many more threads, see GetApplyPool.
+  ServerThread(uint32_t server_id, uint32_t num_apply_threads = 0) : server_id_(server_id) {
+    if (num_apply_threads > 0)
+      apply_pool_.reset(new ApplyPool(num_apply_threads));
+  }
   ~ServerThread();
 
   void RegisterModel(uint32_t model_id, std::unique_ptr<AbstractModel>&& model);
@@ -28,12 +34,15 @@ class ServerThread {
 
   AbstractModel* GetModel(uint32_t model_id);
   uint32_t GetServerId() const;
+  // The pool the storages of this thread apply large requests with, nullptr if none.
+  ApplyPool* GetApplyPool() { return apply_pool_.get(); }
 
  private:
   uint32_t server_id_;
   std::thread work_thread_;
   ThreadsafeQueue<Message> work_queue_;
   std::unordered_map<uint32_t, std::unique_ptr<AbstractModel>> models_;
+  std::unique_ptr<ApplyPool> apply_pool_;
 
 #ifdef USE_TIMER
   std::chrono::microseconds clock_time_{0};
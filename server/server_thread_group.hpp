@@ -10,10 +10,11 @@ namespace flexps {
 
 class ServerThreadGroup {
  public:
-  ServerThreadGroup(const std::vector<uint32_t>& server_id_vec, ThreadsafeQueue<Message>* reply_queue)
+  ServerThreadGroup(const std::vector<uint32_t>& server_id_vec, ThreadsafeQueue<Message>* reply_queue,
+                    uint32_t num_apply_threads = 0)
       : reply_queue_(reply_queue) {
     for (auto& server_id : server_id_vec)
-      server_threads.emplace_back(new ServerThread(server_id));
+      server_threads.emplace_back(new ServerThread(server_id, num_apply_threads));
   }
 
   ThreadsafeQueue<Message>* GetReplyQueue() { return reply_queue_; }
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace flexps {
+
+/*
+ * Element-wise kernels used by the dense storages on contiguous runs of keys.
+ *
+ * The float/double specializations use AVX-512 or AVX/AVX2 when the translation unit is compiled
+ * for them (e.g. `cmake .. -DUSE_NATIVE_ARCH=ON`), and otherwise fall back to the scalar loop.
+ */
+
+// dst[i] += src[i], i in [0, n)
+template <typename Val>
+inline void AddTo(Val* dst, const Val* src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] += src[i];
+}
+
+template <>
+inline void AddTo<float>(float* dst, const float* src, size_t n) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(dst + i), _mm512_loadu_ps(src + i)));
+#elif defined(__AVX__)
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+#endif
+  for (; i < n; ++i)
+    dst[i] += src[i];
+}
+
+template <>
+inline void AddTo<double>(double* dst, const double* src, size_t n) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  for (; i + 8 <= n; i += 8)
+    _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+#elif defined(__AVX__)
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+#endif
+  for (; i < n; ++i)
+    dst[i] += src[i];
+}
+
+// dst[i] = src[i], i in [0, n). memcpy is already vectorized by libc for every instruction set.
+template <typename Val>
+inline void CopyTo(Val* dst, const Val* src, size_t n) {
+  std::memcpy(dst, src, n * sizeof(Val));
+}
+
+/*
+ * Call f(begin, length) for every maximal run of consecutive keys keys[begin..begin+length),
+ * i.e. keys[i + 1] == keys[i] + 1 inside a run.
+ */
+template <typename K, typename F>
+inline void ForEachRun(const K* keys, size_t n, F f) {
+  if (n == 0)
+    return;
+  // Dense pulls are usually a single run. This check has no early exit so that it vectorizes.
+  size_t num_steps = 0;
+  for (size_t i = 1; i < n; ++i)
+    num_steps += (keys[i] == keys[i - 1] + 1);
+  if (num_steps == n - 1) {
+    f(0, n);
+    return;
+  }
+  size_t start = 0;
+  for (size_t i = 1; i < n; ++i) {
+    if (keys[i] != keys[i - 1] + 1) {
+      f(start, i - start);
+      start = i;
+    }
+  }
+  f(start, n - start);
+}
+
+}  // namespace flexps
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "server/abstract_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/initializer.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * A sorted-array storage for sparse tables which exploits that the keys of every request are
+ * sorted (see KVTableBox and SimpleRangePartitionManager::Slice).
+ *
+ * Instead of an independent lookup per key, SubAdd/SubGet walk the request keys and the stored
+ * keys together, using galloping (exponential then binary) search to skip over stored keys, so a
+ * large request is a single forward pass. Keys that are not stored yet are merged in with one
+ * linear pass at the end of SubAdd, so this storage suits tables whose key set stabilizes after
+ * the first few iterations.
+ *
+ * Values are stored in rows of chunk_size_ with the same key and initialization semantics as
+ * HashStorage.
+ */
+template <typename Val, typename Init = Initializer<Val>>
+class SortedStorage : public AbstractStorage {
+ public:
+  SortedStorage(uint32_t chunk_size = 1, Init init = Init()) : chunk_size_(chunk_size), init_(init) {
+    CHECK_GT(chunk_size_, 0);
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size(), typed_vals.size());
+    AddImpl(typed_keys, typed_vals, false);
+  }
+
+  virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_vals.size()/typed_keys.size(), chunk_size_);
+    AddImpl(typed_keys, typed_vals, true);
+  }
+
+  // Absent keys are read as init_(key) and are not inserted.
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size());
+    size_t pos = 0;
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      Key row_key = typed_keys[i] / chunk_size_;
+      pos = Seek(row_key, pos);
+      if (pos < keys_.size() && keys_[pos] == row_key)
+        reply_vals[i] = vals_[pos * chunk_size_ + typed_keys[i] % chunk_size_];
+      else
+        reply_vals[i] = init_(typed_keys[i]);
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size() * chunk_size_);
+    size_t pos = 0;
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      pos = Seek(typed_keys[i], pos);
+      Val* dst = reply_vals.data() + i * chunk_size_;
+      if (pos < keys_.size() && keys_[pos] == typed_keys[i])
+        std::copy(vals_.begin() + pos * chunk_size_, vals_.begin() + (pos + 1) * chunk_size_, dst);
+      else
+        for (size_t j = 0; j < chunk_size_; j++)
+          dst[j] = init_(typed_keys[i] * chunk_size_ + j);
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual void FinishIter() override {}
+
+  // Flushed in key order, the merge of the new rows is one pass per iteration.
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>(chunk_size_));
+  }
+
+  // Number of rows (chunks) materialized in the table.
+  size_t Size() const { return keys_.size(); }
+
+  // Remove the rows (chunk keys) row_keys, which are sorted, absent ones are skipped. One pass.
+  void Erase(const std::vector<Key>& row_keys) {
+    DCHECK(std::is_sorted(row_keys.begin(), row_keys.end()));
+    size_t out = 0, b = 0;
+    for (size_t a = 0; a < keys_.size(); a++) {
+      while (b < row_keys.size() && row_keys[b] < keys_[a])
+        b += 1;
+      if (b < row_keys.size() && row_keys[b] == keys_[a])
+        continue;
+      if (out != a) {
+        keys_[out] = keys_[a];
+        std::copy(vals_.begin() + a * chunk_size_, vals_.begin() + (a + 1) * chunk_size_,
+                  vals_.begin() + out * chunk_size_);
+      }
+      out += 1;
+    }
+    keys_.resize(out);
+    vals_.resize(out * chunk_size_);
+  }
+
+ private:
+  /*
+   * Return the first position >= lo whose key is not less than key. Galloping from the previous
+   * position makes a sorted request a single pass; an out-of-order key restarts from 0.
+   */
+  size_t Seek(Key key, size_t lo) const {
+    if (lo > keys_.size() || (lo > 0 && keys_[lo - 1] >= key))
+      lo = 0;
+    size_t hi = lo;
+    size_t step = 1;
+    while (hi < keys_.size() && keys_[hi] < key) {
+      lo = hi + 1;
+      hi += step;
+      step <<= 1;
+    }
+    hi = std::min(hi, keys_.size());
+    return std::lower_bound(keys_.begin() + lo, keys_.begin() + hi, key) - keys_.begin();
+  }
+
+  Key RowKey(const third_party::SArray<Key>& typed_keys, size_t i, bool is_chunk) const {
+    return is_chunk ? typed_keys[i] : typed_keys[i] / chunk_size_;
+  }
+
+  void AddToRow(Val* row, const third_party::SArray<Key>& typed_keys, const third_party::SArray<Val>& typed_vals,
+                size_t i, bool is_chunk) const {
+    if (is_chunk) {
+      const Val* src = typed_vals.data() + i * chunk_size_;
+      for (size_t j = 0; j < chunk_size_; j++)
+        row[j] += src[j];
+    } else {
+      row[typed_keys[i] % chunk_size_] += typed_vals[i];
+    }
+  }
+
+  void AddImpl(const third_party::SArray<Key>& typed_keys, const third_party::SArray<Val>& typed_vals,
+               bool is_chunk) {
+    // 1. Update the existing rows in place and remember the request indices of the missing ones.
+    std::vector<size_t> missing;
+    size_t pos = 0;
+    for (size_t i = 0; i < typed_keys.size(); i++) {
+      Key row_key = RowKey(typed_keys, i, is_chunk);
+      pos = Seek(row_key, pos);
+      if (pos < keys_.size() && keys_[pos] == row_key)
+        AddToRow(vals_.data() + pos * chunk_size_, typed_keys, typed_vals, i, is_chunk);
+      else
+        missing.push_back(i);
+    }
+    if (missing.empty())
+      return;
+
+    // 2. Merge the missing rows into the sorted arrays in one pass.
+    auto row_key_less = [&](size_t a, size_t b) {
+      return RowKey(typed_keys, a, is_chunk) < RowKey(typed_keys, b, is_chunk);
+    };
+    if (!std::is_sorted(missing.begin(), missing.end(), row_key_less))
+      std::stable_sort(missing.begin(), missing.end(), row_key_less);
+    std::vector<Key> new_keys;
+    std::vector<Val> new_vals;
+    new_keys.reserve(keys_.size() + missing.size());
+    new_vals.reserve((keys_.size() + missing.size()) * chunk_size_);
+    size_t a = 0, b = 0;
+    while (a < keys_.size() || b < missing.size()) {
+      if (b == missing.size() || (a < keys_.size() && keys_[a] < RowKey(typed_keys, missing[b], is_chunk))) {
+        new_keys.push_back(keys_[a]);
+        new_vals.insert(new_vals.end(), vals_.begin() + a * chunk_size_, vals_.begin() + (a + 1) * chunk_size_);
+        a += 1;
+      } else {
+        Key row_key = RowKey(typed_keys, missing[b], is_chunk);
+        new_keys.push_back(row_key);
+        for (size_t j = 0; j < chunk_size_; j++)
+          new_vals.push_back(init_(row_key * chunk_size_ + j));
+        Val* row = new_vals.data() + new_vals.size() - chunk_size_;
+        // Several request entries may fall into the same new row.
+        while (b < missing.size() && RowKey(typed_keys, missing[b], is_chunk) == row_key) {
+          AddToRow(row, typed_keys, typed_vals, missing[b], is_chunk);
+          b += 1;
+        }
+      }
+    }
+    keys_.swap(new_keys);
+    vals_.swap(new_vals);
+  }
+
+  std::vector<Key> keys_;
+  std::vector<Val> vals_;
+  uint32_t chunk_size_;
+  Init init_;
+};
+
+}  // namespace flexps
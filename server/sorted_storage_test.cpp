@@ -0,0 +1,166 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/sorted_storage.hpp"
+
+namespace flexps {
+namespace {
+
+class TestSortedStorage : public testing::Test {
+ public:
+  TestSortedStorage() {}
+  ~TestSortedStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestSortedStorage, AddGetInt) {
+  SortedStorage<int> s;
+
+  Message m;
+  third_party::SArray<Key> s_keys({13, 14, 15});
+  third_party::SArray<int> s_vals({1, 2, 3});
+  m.AddData(s_keys);
+  m.AddData(s_vals);
+  s.Add(m);
+
+  Message m2;
+  m2.AddData(s_keys);
+  Message rep = s.Get(m2);
+
+  EXPECT_EQ(rep.data.size(), 2);
+  auto rep_keys = third_party::SArray<Key>(rep.data[0]);
+  auto rep_vals = third_party::SArray<int>(rep.data[1]);
+  for (int index = 0; index < s_keys.size(); index++) {
+    EXPECT_EQ(rep_keys[index], s_keys[index]);
+    EXPECT_EQ(rep_vals[index], s_vals[index]);
+  }
+}
+
+TEST_F(TestSortedStorage, MergeInterleavedBatches) {
+  SortedStorage<int> s;
+
+  third_party::SArray<Key> keys1({2, 4, 6, 8});
+  third_party::SArray<int> vals1({1, 1, 1, 1});
+  s.SubAdd(keys1, third_party::SArray<char>(vals1));
+  third_party::SArray<Key> keys2({1, 4, 5, 8, 9});
+  third_party::SArray<int> vals2({10, 10, 10, 10, 10});
+  s.SubAdd(keys2, third_party::SArray<char>(vals2));
+  EXPECT_EQ(s.Size(), 7);
+
+  third_party::SArray<Key> get_keys({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(get_keys));
+  std::vector<int> expected({0, 10, 1, 0, 11, 10, 1, 0, 11, 10, 0});
+  for (int i = 0; i < get_keys.size(); ++ i) {
+    EXPECT_EQ(ret[i], expected[i]);
+  }
+  // Gets do not insert
+  EXPECT_EQ(s.Size(), 7);
+}
+
+TEST_F(TestSortedStorage, LargeSortedBatch) {
+  SortedStorage<int> s;
+
+  const int kNumKeys = 10000;
+  third_party::SArray<Key> s_keys(kNumKeys);
+  third_party::SArray<int> s_vals(kNumKeys);
+  for (int i = 0; i < kNumKeys; ++ i) {
+    s_keys[i] = i * 31;
+    s_vals[i] = i;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(s_keys));
+  for (int i = 0; i < kNumKeys; ++ i) {
+    EXPECT_EQ(ret[i], 2 * s_vals[i]);
+  }
+}
+
+TEST_F(TestSortedStorage, SubAddChunkSubGetChunk) {
+  SortedStorage<float> s(10);
+
+  third_party::SArray<Key> s_keys({1, 2});
+  third_party::SArray<float> s_vals(20);
+  for (int i = 0; i < 20; i++) {
+    s_vals[i] = i / 10.0;
+  }
+  s.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int i = 0; i < s_vals.size(); ++ i) {
+    EXPECT_EQ(ret[i], s_vals[i]);
+  }
+}
+
+TEST_F(TestSortedStorage, Initializer) {
+  InitializerConfig config;
+  config.type = InitType::Constant;
+  config.constant = 1.5;
+  SortedStorage<float> s(1, Initializer<float>(config));
+
+  // Absent keys are read as the initial value and are not inserted.
+  third_party::SArray<Key> s_keys({3, 7});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1.5);
+  EXPECT_EQ(ret[1], 1.5);
+  EXPECT_EQ(s.Size(), 0);
+
+  // The first Add starts from the initial value.
+  third_party::SArray<Key> add_keys({7});
+  third_party::SArray<float> add_vals({0.25});
+  s.SubAdd(add_keys, third_party::SArray<char>(add_vals));
+  ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1.5);
+  EXPECT_EQ(ret[1], 1.75);
+  EXPECT_EQ(s.Size(), 1);
+}
+
+TEST_F(TestSortedStorage, InitializerChunk) {
+  InitializerConfig config;
+  config.type = InitType::Uniform;
+  config.seed = 3;
+  Initializer<float> init(config);
+  SortedStorage<float> s(4, init);
+
+  // A chunk reads init of its element keys before and after the first Add.
+  third_party::SArray<Key> s_keys({2});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int j = 0; j < 4; ++ j) {
+    EXPECT_EQ(ret[j], init(8 + j));
+  }
+  third_party::SArray<float> s_vals({1, 1, 1, 1});
+  s.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  ret = third_party::SArray<float>(s.SubGetChunk(s_keys));
+  for (int j = 0; j < 4; ++ j) {
+    EXPECT_EQ(ret[j], init(8 + j) + 1);
+  }
+}
+
+TEST_F(TestSortedStorage, Erase) {
+  SortedStorage<int> s;
+  const int kNumKeys = 1000;
+  third_party::SArray<Key> s_keys(kNumKeys);
+  third_party::SArray<int> s_vals(kNumKeys);
+  for (int i = 0; i < kNumKeys; ++ i) {
+    s_keys[i] = i * 7;
+    s_vals[i] = i + 1;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+
+  // Erase every other key and one absent key.
+  std::vector<Key> erased;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    erased.push_back(i * 7);
+  }
+  erased.push_back(kNumKeys * 7);
+  s.Erase(erased);
+  EXPECT_EQ(s.Size(), kNumKeys / 2);
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(s_keys));
+  for (int i = 0; i < kNumKeys; ++ i) {
+    EXPECT_EQ(ret[i], i % 2 ? s_vals[i] : 0);
+  }
+}
+
+}  // namespace
+}  // namespace flexps
@@ -0,0 +1,209 @@
+#include "server/sparsessp/bitset_sparse_ssp_recorder.hpp"
+#include "glog/logging.h"
+
+namespace flexps {
+
+BitsetSparseSSPRecorder::BitsetSparseSSPRecorder(uint32_t staleness, uint32_t speculation, third_party::Range range)
+    : staleness_(staleness), speculation_(speculation), range_(range) {
+  // Same levels as VectorSparseSSPRecorder, one bit each
+  level_size_ = staleness_ + 2 * speculation_ + 3;
+  CHECK_LE(level_size_, 32) << "staleness + 2 * speculation + 3 must fit in the 32 bits of a key mask";
+  DCHECK(range_.end() > range_.begin());
+  masks_.resize(range_.end() - range_.begin(), 0);
+}
+
+BitsetSparseSSPRecorder::~BitsetSparseSSPRecorder() {
+#ifdef USE_TIMER
+  LOG(INFO) << "add_record_time: " << add_record_time_.count()/1000. << " ms";
+  LOG(INFO) << "remove_record_time: " << remove_record_time_.count()/1000.
+      << " ms";
+  LOG(INFO) << "handle_own_get_time: " << handle_own_get_time_.count()/1000. << " ms";
+  LOG(INFO) << "key_count: " << key_count_;
+  LOG(INFO) << "by_staleness: " << by_staleness_
+      << " forward: " << forward_
+      << " by_speculation: " << by_speculation_
+      << " too_fast: " << too_fast_
+      << " total_forward: " << total_forward_;
+#endif
+}
+
+void BitsetSparseSSPRecorder::GetNonConflictMsgs(int progress, int sender, int min_clock, std::vector<Message>* const msgs) {
+  // Get() that are block here
+#ifdef USE_TIMER
+  auto start_time = std::chrono::steady_clock::now();
+#endif
+  if (future_keys_[sender].size() > 0 && future_keys_[sender].front().first == progress - 1) {
+    RemoveRecordAndGetNonConflictMsgs(progress - 1, min_clock, sender, future_keys_[sender].front().second, msgs);
+    future_keys_[sender].pop();
+  }
+#ifdef USE_TIMER
+  auto end_time = std::chrono::steady_clock::now();
+  remove_record_time_ += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+#endif
+
+  // Its own Get()
+#ifdef USE_TIMER
+  start_time = std::chrono::steady_clock::now();
+#endif
+  if (future_msgs_[sender].size() > 0 && future_msgs_[sender].front().first == progress) {
+    Message& msg = future_msgs_[sender].front().second;
+    // min_clock is never negative, the version is compared in uint32_t as with the other bounds.
+    CHECK(msg.meta.version >= static_cast<uint32_t>(min_clock) &&
+          msg.meta.version < min_clock + staleness_ + speculation_ + 2)
+        << "msg version: " << msg.meta.version << " min_clock: " << min_clock << " staleness: " << staleness_ << " speculation: " << speculation_ ;
+    if (msg.meta.version <= staleness_ + min_clock) {
+      msgs->push_back(std::move(msg));
+#ifdef USE_TIMER
+      by_staleness_ += 1;
+#endif
+    } else if (msg.meta.version <= min_clock + staleness_ + speculation_) {
+      if (CheckAndForward(std::move(msg), min_clock, msgs)) {
+#ifdef USE_TIMER
+        forward_ += 1;
+#endif
+      } else {
+#ifdef USE_TIMER
+        by_speculation_ += 1;
+#endif
+      }
+    } else if (msg.meta.version == min_clock + staleness_ + speculation_ + 1) {
+      too_fast_buffer_.push_back(std::move(msg));
+#ifdef USE_TIMER
+      too_fast_ += 1;
+#endif
+    } else {
+      CHECK(false) << " version: " << msg.meta.version << " tid: " << msg.meta.sender;
+    }
+    future_msgs_[sender].pop();
+  }
+#ifdef USE_TIMER
+  end_time = std::chrono::steady_clock::now();
+  handle_own_get_time_ += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+#endif
+}
+
+void BitsetSparseSSPRecorder::HandleTooFastBuffer(int min_clock, std::vector<Message>* const msgs) {
+  for (auto& msg : too_fast_buffer_) {
+    CheckAndForward(std::move(msg), min_clock, msgs);
+  }
+  too_fast_buffer_.clear();
+}
+
+void BitsetSparseSSPRecorder::AddRecord(Message& msg) {
+  DCHECK_LT(future_keys_[msg.meta.sender].size(), speculation_ + 1);
+  future_keys_[msg.meta.sender].push({msg.meta.version, third_party::SArray<Key>(msg.data[0])});
+
+#ifdef USE_TIMER
+  auto start_time = std::chrono::steady_clock::now();
+#endif
+  const uint32_t bit = 1u << (msg.meta.version % level_size_);
+  for (auto key : third_party::SArray<Key>(msg.data[0])) {
+    uint32_t& mask = masks_[key - range_.begin()];
+    if (mask & bit) {
+      extra_counts_[Slot(key, msg.meta.version)] += 1;
+    } else {
+      mask |= bit;
+    }
+#ifdef USE_TIMER
+    key_count_ += 1;
+#endif
+  }
+#ifdef USE_TIMER
+  auto end_time = std::chrono::steady_clock::now();
+  add_record_time_ += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+#endif
+
+  int version = msg.meta.version;
+  if (version != 0) {
+    future_msgs_[msg.meta.sender].push({version, std::move(msg)});
+  }
+}
+
+void BitsetSparseSSPRecorder::RemoveRecordAndGetNonConflictMsgs(int version, int min_clock, uint32_t tid,
+                                          const third_party::SArray<Key>& keys, std::vector<Message>* msgs) {
+  std::vector<Message> msgs_to_be_handled;
+  const uint32_t bit = 1u << (version % level_size_);
+  for (auto key : keys) {
+    uint32_t& mask = masks_[key - range_.begin()];
+    DCHECK(mask & bit);
+    if (!extra_counts_.empty()) {
+      auto extra = extra_counts_.find(Slot(key, version));
+      if (extra != extra_counts_.end()) {
+        if (--extra->second == 0)
+          extra_counts_.erase(extra);
+        continue;
+      }
+    }
+    mask &= ~bit;
+    if (!forwarded_msgs_.empty()) {
+      auto forwarded = forwarded_msgs_.find(Slot(key, version));
+      if (forwarded != forwarded_msgs_.end()) {
+        for (auto& msg : forwarded->second) {
+          msgs_to_be_handled.push_back(std::move(msg));
+        }
+        forwarded_msgs_.erase(forwarded);
+      }
+    }
+  }
+
+  for (auto& msg : msgs_to_be_handled) {
+    CheckAndForward(std::move(msg), min_clock, msgs);
+  }
+}
+
+void BitsetSparseSSPRecorder::RemoveRecord(const int version) {}
+
+bool BitsetSparseSSPRecorder::CheckAndForward(Message&& msg, int min_clock, std::vector<Message>* msgs) {
+  Key forwarded_key = 0;
+  int forwarded_version = -1;
+  if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock, msg.meta.version - staleness_ - 1,
+         &forwarded_key, &forwarded_version)) {
+    forwarded_msgs_[Slot(forwarded_key, forwarded_version)].push_back(std::move(msg));
+#ifdef USE_TIMER
+    total_forward_ += 1;
+#endif
+    return true;
+  }
+  msgs->push_back(std::move(msg));
+  return false;
+}
+
+/* IF:
+ *   NO conflict: return false
+ *   ONE or SEVERAL conflict: return true with the first key recorded at the latest conflicting version,
+ *   as VectorSparseSSPRecorder does
+ */
+bool BitsetSparseSSPRecorder::HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
+                                          const int end_version, Key* forwarded_key, int* forwarded_version) {
+  uint32_t window = 0;
+  for (int check_version = begin_version; check_version <= end_version; check_version++) {
+    window |= 1u << (check_version % level_size_);
+  }
+  if (window == 0)
+    return false;
+
+  uint32_t hit = 0;
+  for (auto key : keys) {
+    hit |= masks_[key - range_.begin()];
+  }
+  hit &= window;
+  if (hit == 0)
+    return false;
+
+  for (int check_version = end_version; check_version >= begin_version; check_version--) {
+    const uint32_t bit = 1u << (check_version % level_size_);
+    if (!(hit & bit))
+      continue;
+    for (auto key : keys) {
+      if (masks_[key - range_.begin()] & bit) {
+        *forwarded_key = key;
+        *forwarded_version = check_version;
+        return true;
+      }
+    }
+  }
+  CHECK(false) << "unreachable";
+  return false;
+}
+
+} // namespace flexps
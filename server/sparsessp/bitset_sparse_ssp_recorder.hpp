@@ -0,0 +1,79 @@
+#pragma once
+
+#include "server/sparsessp/abstract_sparse_ssp_recorder.hpp"
+#include "glog/logging.h"
+
+#include <unordered_map>
+#include <queue>
+
+#ifdef USE_TIMER
+#include <chrono>
+#endif
+
+namespace flexps {
+
+/*
+ * The VectorSparseSSPRecorder with the record of each key packed into one word.
+ *
+ * Bit (version % levels) of the mask of a key is set while some worker has the key recorded at that
+ * version, so a conflict check ANDs one word per key against the mask of the version window instead
+ * of probing every version of the window for every key. The rare counts above one and the forwarded
+ * Gets live in side tables keyed by (key, version level).
+ */
+class BitsetSparseSSPRecorder : public AbstractSparseSSPRecorder {
+public:
+  BitsetSparseSSPRecorder(uint32_t staleness, uint32_t speculation, third_party::Range range);
+  ~BitsetSparseSSPRecorder();
+  virtual void GetNonConflictMsgs(int progress, int sender, int min_clock, std::vector<Message>* const msgs) override;
+  virtual void HandleTooFastBuffer(int min_clock, std::vector<Message>* const msgs) override;
+  virtual void RemoveRecord(int version) override;
+  virtual void AddRecord(Message& msg) override;
+
+private:
+  void RemoveRecordAndGetNonConflictMsgs(int version, int min_clock, uint32_t tid,
+                       const third_party::SArray<Key>& keys, std::vector<Message>* msgs);
+
+  bool HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
+                   const int end_version, Key* forwarded_key, int* forwarded_version);
+  // Forward msg to the latest conflicting record and return true, or append it to msgs.
+  bool CheckAndForward(Message&& msg, int min_clock, std::vector<Message>* msgs);
+
+  uint64_t Slot(Key key, int version) const {
+    return static_cast<uint64_t>(key - range_.begin()) * level_size_ + version % level_size_;
+  }
+
+  uint32_t staleness_;
+  uint32_t speculation_;
+  uint32_t level_size_ = 0;
+  third_party::Range range_;
+
+  // <key, bit (version % level_size_) set iff recorded at the version>
+  std::vector<uint32_t> masks_;
+  // <Slot(key, version), count - 1>, for the keys recorded by more than one worker at a version
+  std::unordered_map<uint64_t, uint32_t> extra_counts_;
+  // <Slot(key, version), [msg]>, the Gets waiting for the record to be removed
+  std::unordered_map<uint64_t, std::vector<Message>> forwarded_msgs_;
+
+  // <thread_id, [<version, key>]>, has at most speculation_ + 1 queue size for each thread_id
+  std::unordered_map<int, std::queue<std::pair<int, third_party::SArray<Key>>>> future_keys_;
+
+  // <thread_id, [<version, msg>]>
+  std::unordered_map<int, std::queue<std::pair<int, Message>>> future_msgs_;
+
+  std::vector<Message> too_fast_buffer_;
+
+  // timer
+#ifdef USE_TIMER
+  std::chrono::microseconds add_record_time_{0};
+  int key_count_ = 0;
+  std::chrono::microseconds remove_record_time_{0};
+  std::chrono::microseconds handle_own_get_time_{0};
+  int by_staleness_ = 0;
+  int forward_ = 0;
+  int total_forward_ = 0;
+  int by_speculation_ = 0;
+  int too_fast_ = 0;
+#endif
+};
+
+}  // namespace flexps
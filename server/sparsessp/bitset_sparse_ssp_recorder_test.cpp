@@ -0,0 +1,112 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/map_storage.hpp"
+
+#include "server/sparsessp/bitset_sparse_ssp_recorder.hpp"
+#include "server/sparsessp/sparse_ssp_replay.hpp"
+#include "server/sparsessp/vector_sparse_ssp_recorder.hpp"
+
+namespace flexps {
+namespace {
+
+class TestBitsetSparseSSPRecorder : public testing::Test {
+ public:
+  TestBitsetSparseSSPRecorder() {}
+  ~TestBitsetSparseSSPRecorder() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+Message CreateGet(int sender, int version, third_party::SArray<Key> keys) {
+  Message m;
+  m.meta.flag = Flag::kGet;
+  m.meta.sender = sender;
+  m.meta.version = version;
+  m.AddData(keys);
+  return m;
+}
+
+TEST_F(TestBitsetSparseSSPRecorder, ForwardUntilRemoved) {
+  BitsetSparseSSPRecorder recorder(0, 1, third_party::Range(0, 4));
+  std::vector<Message> msgs;
+
+  Message get_2_0 = CreateGet(2, 0, {0});
+  recorder.AddRecord(get_2_0);
+  Message get_3_0 = CreateGet(3, 0, {0});
+  recorder.AddRecord(get_3_0);
+  Message get_2_1 = CreateGet(2, 1, {0, 1});
+  recorder.AddRecord(get_2_1);
+
+  // Worker 2 clocks: Get_2_1 conflicts with key 0 of Get_3_0
+  recorder.GetNonConflictMsgs(1, 2, 0, &msgs);
+  EXPECT_EQ(msgs.size(), 0);
+
+  // Worker 3 clocks: its record of key 0 is removed and Get_2_1 released with its own Get_3_1
+  Message get_3_1 = CreateGet(3, 1, {2});
+  recorder.AddRecord(get_3_1);
+  recorder.GetNonConflictMsgs(1, 3, 1, &msgs);
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[0].meta.sender, 2);
+  EXPECT_EQ(msgs[0].meta.version, 1);
+  EXPECT_EQ(msgs[1].meta.sender, 3);
+  EXPECT_EQ(msgs[1].meta.version, 1);
+}
+
+TEST_F(TestBitsetSparseSSPRecorder, CountAboveOne) {
+  BitsetSparseSSPRecorder recorder(0, 1, third_party::Range(0, 4));
+  std::vector<Message> msgs;
+
+  for (int tid : {2, 3, 4}) {
+    Message get = CreateGet(tid, 0, {1});
+    recorder.AddRecord(get);
+  }
+  Message get_2_1 = CreateGet(2, 1, {1});
+  recorder.AddRecord(get_2_1);
+  recorder.GetNonConflictMsgs(1, 2, 0, &msgs);
+  EXPECT_EQ(msgs.size(), 0);
+
+  // Key 1 is still recorded at version 0 by worker 4
+  Message get_3_1 = CreateGet(3, 1, {3});
+  recorder.AddRecord(get_3_1);
+  recorder.GetNonConflictMsgs(1, 3, 0, &msgs);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].meta.sender, 3);
+
+  msgs.clear();
+  Message get_4_1 = CreateGet(4, 1, {3});
+  recorder.AddRecord(get_4_1);
+  recorder.GetNonConflictMsgs(1, 4, 1, &msgs);
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[0].meta.sender, 2);
+  EXPECT_EQ(msgs[1].meta.sender, 4);
+}
+
+TEST_F(TestBitsetSparseSSPRecorder, SameRepliesAsVector) {
+  const int num_workers = 4;
+  const int num_keys = 8;
+  const int num_iters = 50;
+  auto keys = RandomReplayKeys(num_workers, num_iters, num_keys, 3, 0);
+  third_party::Range range(0, num_keys);
+  for (int staleness : {0, 1, 2}) {
+    for (int speculation : {1, 2}) {
+      SparseSSPReplayLog expected;
+      EXPECT_TRUE(ReplaySparseSSP(std::unique_ptr<AbstractStorage>(new MapStorage<int>()),
+                                  std::unique_ptr<AbstractSparseSSPRecorder>(
+                                      new VectorSparseSSPRecorder(staleness, speculation, range)),
+                                  staleness, speculation, keys, 0, &expected));
+      SparseSSPReplayLog log;
+      EXPECT_TRUE(ReplaySparseSSP(std::unique_ptr<AbstractStorage>(new MapStorage<int>()),
+                                  std::unique_ptr<AbstractSparseSSPRecorder>(
+                                      new BitsetSparseSSPRecorder(staleness, speculation, range)),
+                                  staleness, speculation, keys, 0, &log));
+      EXPECT_EQ(log.size(), num_workers * num_iters);
+      EXPECT_TRUE(log == expected) << "staleness: " << staleness << " speculation: " << speculation;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace flexps
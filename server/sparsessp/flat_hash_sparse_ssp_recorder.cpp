@@ -0,0 +1,222 @@
+#include "server/sparsessp/flat_hash_sparse_ssp_recorder.hpp"
+#include "glog/logging.h"
+
+namespace flexps {
+
+FlatHashSparseSSPRecorder::FlatHashSparseSSPRecorder(uint32_t staleness, uint32_t speculation, size_t init_capacity)
+    : staleness_(staleness), speculation_(speculation) {
+  // Same levels as VectorSparseSSPRecorder
+  level_size_ = staleness_ + 2 * speculation_ + 3;
+  size_t capacity = 16;
+  while (capacity < init_capacity)
+    capacity <<= 1;
+  Rehash(capacity);
+}
+
+void FlatHashSparseSSPRecorder::GetNonConflictMsgs(int progress, int sender, int min_clock, std::vector<Message>* const msgs) {
+  Worker& worker = GetWorker(sender);
+  // Get() that are block here
+  if (worker.future_keys.size() > 0 && worker.future_keys.front().first == progress - 1) {
+    RemoveRecordAndGetNonConflictMsgs(progress - 1, min_clock, worker.future_keys.front().second, msgs);
+    worker.future_keys.pop();
+  }
+  // Its own Get()
+  if (worker.future_msgs.size() > 0 && worker.future_msgs.front().first == progress) {
+    Message& msg = worker.future_msgs.front().second;
+    // min_clock is never negative, the version is compared in uint32_t as with the other bounds.
+    CHECK(msg.meta.version >= static_cast<uint32_t>(min_clock) &&
+          msg.meta.version < min_clock + staleness_ + speculation_ + 2)
+        << "msg version: " << msg.meta.version << " min_clock: " << min_clock << " staleness: " << staleness_ << " speculation: " << speculation_ ;
+    if (msg.meta.version <= staleness_ + min_clock) {
+      msgs->push_back(std::move(msg));
+    } else if (msg.meta.version <= min_clock + staleness_ + speculation_) {
+      CheckAndForward(std::move(msg), min_clock, msgs);
+    } else if (msg.meta.version == min_clock + staleness_ + speculation_ + 1) {
+      too_fast_buffer_.push_back(std::move(msg));
+    } else {
+      CHECK(false) << " version: " << msg.meta.version << " tid: " << msg.meta.sender;
+    }
+    worker.future_msgs.pop();
+  }
+}
+
+void FlatHashSparseSSPRecorder::HandleTooFastBuffer(int min_clock, std::vector<Message>* const msgs) {
+  for (auto& msg : too_fast_buffer_) {
+    CheckAndForward(std::move(msg), min_clock, msgs);
+  }
+  too_fast_buffer_.clear();
+}
+
+void FlatHashSparseSSPRecorder::AddRecord(Message& msg) {
+  Worker& worker = GetWorker(msg.meta.sender);
+  DCHECK_LT(worker.future_keys.size(), speculation_ + 1);
+  third_party::SArray<Key> keys(msg.data[0]);
+  worker.future_keys.push({msg.meta.version, keys});
+
+  const uint32_t level = msg.meta.version % level_size_;
+  for (auto key : keys) {
+    FindOrInsert(key, level)->count += 1;
+  }
+
+  int version = msg.meta.version;
+  if (version != 0) {
+    worker.future_msgs.push({version, std::move(msg)});
+  }
+}
+
+void FlatHashSparseSSPRecorder::RemoveRecordAndGetNonConflictMsgs(int version, int min_clock,
+                                          const third_party::SArray<Key>& keys, std::vector<Message>* msgs) {
+  std::vector<Message> msgs_to_be_handled;
+  const uint32_t level = version % level_size_;
+  for (auto key : keys) {
+    Entry* entry = Find(key, level);
+    DCHECK(entry != nullptr);
+    entry->count -= 1;
+    if (entry->count == 0) {
+      for (int32_t node = entry->head; node != kNil;) {
+        int32_t next = pool_[node].next;
+        msgs_to_be_handled.push_back(std::move(pool_[node].msg));
+        pool_[node].msg = Message();
+        pool_[node].next = free_;
+        free_ = node;
+        node = next;
+      }
+      Erase(entry);
+    }
+  }
+
+  for (auto& msg : msgs_to_be_handled) {
+    CheckAndForward(std::move(msg), min_clock, msgs);
+  }
+}
+
+// The records are dropped when their count reaches 0.
+void FlatHashSparseSSPRecorder::RemoveRecord(const int version) {}
+
+void FlatHashSparseSSPRecorder::CheckAndForward(Message&& msg, int min_clock, std::vector<Message>* msgs) {
+  Key forwarded_key = 0;
+  int forwarded_version = -1;
+  if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock, msg.meta.version - staleness_ - 1,
+         &forwarded_key, &forwarded_version)) {
+    int32_t node = NewNode(std::move(msg));
+    Entry* entry = Find(forwarded_key, forwarded_version % level_size_);
+    if (entry->head == kNil) {
+      entry->head = node;
+    } else {
+      pool_[entry->tail].next = node;
+    }
+    entry->tail = node;
+  } else {
+    msgs->push_back(std::move(msg));
+  }
+}
+
+/* IF:
+ *   NO conflict: return false
+ *   ONE or SEVERAL conflict: return true with the first key recorded at the latest conflicting version
+ */
+bool FlatHashSparseSSPRecorder::HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
+                                          const int end_version, Key* forwarded_key, int* forwarded_version) {
+  for (int check_version = end_version; check_version >= begin_version; check_version--) {
+    const uint32_t level = check_version % level_size_;
+    for (auto key : keys) {
+      if (Find(key, level)) {
+        *forwarded_key = key;
+        *forwarded_version = check_version;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+FlatHashSparseSSPRecorder::Worker& FlatHashSparseSSPRecorder::GetWorker(int tid) {
+  auto it = worker_slots_.find(tid);
+  if (it != worker_slots_.end())
+    return workers_[it->second];
+  worker_slots_[tid] = workers_.size();
+  workers_.emplace_back();
+  workers_.back().future_keys.Reserve(speculation_ + 1);
+  workers_.back().future_msgs.Reserve(speculation_ + 1);
+  return workers_.back();
+}
+
+size_t FlatHashSparseSSPRecorder::Home(Key key, uint32_t level) const {
+  // Fibonacci hashing of the key and the level, as in HashStorage
+  uint64_t h = static_cast<uint64_t>(key) * level_size_ + level;
+  return static_cast<size_t>((h * 0x9E3779B97F4A7C15ULL) >> shift_);
+}
+
+FlatHashSparseSSPRecorder::Entry* FlatHashSparseSSPRecorder::Find(Key key, uint32_t level) {
+  size_t mask = entries_.size() - 1;
+  for (size_t pos = Home(key, level);; pos = (pos + 1) & mask) {
+    Entry& entry = entries_[pos];
+    if (entry.count == 0)
+      return nullptr;
+    if (entry.key == key && entry.level == level)
+      return &entry;
+  }
+}
+
+FlatHashSparseSSPRecorder::Entry* FlatHashSparseSSPRecorder::FindOrInsert(Key key, uint32_t level) {
+  // Keep the load factor under 0.7 so that probe sequences stay short.
+  if ((size_ + 1) * 10 > entries_.size() * 7)
+    Rehash(entries_.size() * 2);
+  size_t mask = entries_.size() - 1;
+  size_t pos = Home(key, level);
+  while (entries_[pos].count != 0 && !(entries_[pos].key == key && entries_[pos].level == level))
+    pos = (pos + 1) & mask;
+  Entry& entry = entries_[pos];
+  if (entry.count == 0) {
+    entry = {key, level, 0, kNil, kNil};
+    size_ += 1;
+  }
+  return &entry;
+}
+
+/*
+ * Backward-shift deletion as in HashStorage: the entries after the hole in its probe cluster move
+ * into the hole unless their home slot lies after it.
+ */
+void FlatHashSparseSSPRecorder::Erase(Entry* entry) {
+  size_t mask = entries_.size() - 1;
+  size_t hole = entry - entries_.data();
+  for (size_t next = (hole + 1) & mask; entries_[next].count != 0; next = (next + 1) & mask) {
+    size_t home = Home(entries_[next].key, entries_[next].level);
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      entries_[hole] = entries_[next];
+      hole = next;
+    }
+  }
+  entries_[hole].count = 0;
+  size_ -= 1;
+}
+
+void FlatHashSparseSSPRecorder::Rehash(size_t new_capacity) {
+  std::vector<Entry> old_entries(new_capacity, Entry{0, 0, 0, kNil, kNil});
+  old_entries.swap(entries_);
+  shift_ = 64;
+  for (size_t c = new_capacity; c > 1; c >>= 1)
+    shift_ -= 1;
+  size_ = 0;
+  for (const auto& old : old_entries) {
+    if (old.count == 0)
+      continue;
+    *FindOrInsert(old.key, old.level) = old;
+  }
+}
+
+int32_t FlatHashSparseSSPRecorder::NewNode(Message&& msg) {
+  int32_t node = free_;
+  if (node == kNil) {
+    node = pool_.size();
+    pool_.push_back({Message(), kNil});
+  } else {
+    free_ = pool_[node].next;
+  }
+  pool_[node].msg = std::move(msg);
+  pool_[node].next = kNil;
+  return node;
+}
+
+}  // namespace flexps
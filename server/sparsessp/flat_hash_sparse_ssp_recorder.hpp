@@ -0,0 +1,113 @@
+#pragma once
+
+#include "server/sparsessp/abstract_sparse_ssp_recorder.hpp"
+#include "glog/logging.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * The UnorderedMapSparseSSPRecorder for sparse, huge key spaces, without the allocations per key.
+ *
+ * The records live in one flat open-addressing (linear probing) table keyed by (key, version %
+ * levels), an entry being dropped as soon as its count reaches 0. The Gets forwarded to an entry are
+ * a linked list of nodes in a pool whose freed nodes are reused, and the per-thread queues are ring
+ * buffers of speculation + 1 elements indexed by the dense slot of the worker.
+ */
+class FlatHashSparseSSPRecorder : public AbstractSparseSSPRecorder {
+public:
+  FlatHashSparseSSPRecorder(uint32_t staleness, uint32_t speculation, size_t init_capacity = 1024);
+  virtual void GetNonConflictMsgs(int progress, int sender, int min_clock, std::vector<Message>* const msgs) override;
+  virtual void HandleTooFastBuffer(int min_clock, std::vector<Message>* const msgs) override;
+  virtual void RemoveRecord(int version) override;
+  virtual void AddRecord(Message& msg) override;
+
+  // Number of (key, version) records.
+  size_t Size() const { return size_; }
+
+private:
+  static const int32_t kNil = -1;
+
+  struct Entry {
+    Key key;
+    uint32_t level;
+    uint32_t count;  // 0 iff the entry is free
+    int32_t head;    // forwarded Gets, in arrival order
+    int32_t tail;
+  };
+
+  struct Node {
+    Message msg;
+    int32_t next;
+  };
+
+  // A fixed-capacity FIFO, the slots are reused instead of reallocated.
+  template <typename T>
+  class Ring {
+   public:
+    void Reserve(size_t capacity) { buf_.resize(capacity); }
+    size_t size() const { return size_; }
+    T& front() { return buf_[head_]; }
+    void push(T&& t) {
+      CHECK_LT(size_, buf_.size());
+      buf_[(head_ + size_) % buf_.size()] = std::move(t);
+      size_ += 1;
+    }
+    void pop() {
+      buf_[head_] = T();
+      head_ = (head_ + 1) % buf_.size();
+      size_ -= 1;
+    }
+
+   private:
+    std::vector<T> buf_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+  };
+
+  struct Worker {
+    // <version, keys>, has at most speculation_ + 1 elements
+    Ring<std::pair<int, third_party::SArray<Key>>> future_keys;
+    // <version, msg>
+    Ring<std::pair<int, Message>> future_msgs;
+  };
+
+  void RemoveRecordAndGetNonConflictMsgs(int version, int min_clock, const third_party::SArray<Key>& keys,
+                                         std::vector<Message>* msgs);
+
+  bool HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
+                   const int end_version, Key* forwarded_key, int* forwarded_version);
+  // Forward msg to the latest conflicting record, or append it to msgs.
+  void CheckAndForward(Message&& msg, int min_clock, std::vector<Message>* msgs);
+
+  Worker& GetWorker(int tid);
+
+  size_t Home(Key key, uint32_t level) const;
+  Entry* Find(Key key, uint32_t level);
+  Entry* FindOrInsert(Key key, uint32_t level);
+  void Erase(Entry* entry);
+  void Rehash(size_t new_capacity);
+
+  int32_t NewNode(Message&& msg);
+
+  uint32_t staleness_;
+  uint32_t speculation_;
+  uint32_t level_size_;
+
+  std::vector<Entry> entries_;
+  size_t size_ = 0;
+  uint32_t shift_ = 64;
+
+  std::vector<Node> pool_;
+  int32_t free_ = kNil;
+
+  // <thread_id, dense slot in workers_>
+  std::unordered_map<int, uint32_t> worker_slots_;
+  std::vector<Worker> workers_;
+
+  std::vector<Message> too_fast_buffer_;
+};
+
+}  // namespace flexps
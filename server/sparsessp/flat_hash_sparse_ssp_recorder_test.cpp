@@ -0,0 +1,106 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/map_storage.hpp"
+
+#include "server/sparsessp/flat_hash_sparse_ssp_recorder.hpp"
+#include "server/sparsessp/sparse_ssp_replay.hpp"
+#include "server/sparsessp/unordered_map_sparse_ssp_recorder.hpp"
+
+namespace flexps {
+namespace {
+
+class TestFlatHashSparseSSPRecorder : public testing::Test {
+ public:
+  TestFlatHashSparseSSPRecorder() {}
+  ~TestFlatHashSparseSSPRecorder() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+Message CreateGet(int sender, int version, third_party::SArray<Key> keys) {
+  Message m;
+  m.meta.flag = Flag::kGet;
+  m.meta.sender = sender;
+  m.meta.version = version;
+  m.AddData(keys);
+  return m;
+}
+
+TEST_F(TestFlatHashSparseSSPRecorder, ForwardUntilRemoved) {
+  FlatHashSparseSSPRecorder recorder(0, 1);
+  std::vector<Message> msgs;
+
+  // Keys far apart, as in a huge key space
+  const Key k0 = 7, k1 = 1u << 30;
+  Message get_2_0 = CreateGet(2, 0, {k0});
+  recorder.AddRecord(get_2_0);
+  Message get_3_0 = CreateGet(3, 0, {k0, k1});
+  recorder.AddRecord(get_3_0);
+  EXPECT_EQ(recorder.Size(), 2);
+  Message get_2_1 = CreateGet(2, 1, {k0, k1});
+  recorder.AddRecord(get_2_1);
+  EXPECT_EQ(recorder.Size(), 4);
+
+  // Worker 2 clocks: Get_2_1 conflicts with Get_3_0
+  recorder.GetNonConflictMsgs(1, 2, 0, &msgs);
+  EXPECT_EQ(msgs.size(), 0);
+  EXPECT_EQ(recorder.Size(), 4);
+
+  // Worker 3 clocks: its records are removed and Get_2_1 released with its own Get_3_1
+  Message get_3_1 = CreateGet(3, 1, {k1});
+  recorder.AddRecord(get_3_1);
+  recorder.GetNonConflictMsgs(1, 3, 1, &msgs);
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[0].meta.sender, 2);
+  EXPECT_EQ(msgs[0].meta.version, 1);
+  EXPECT_EQ(msgs[1].meta.sender, 3);
+  EXPECT_EQ(msgs[1].meta.version, 1);
+  EXPECT_EQ(recorder.Size(), 2);
+}
+
+TEST_F(TestFlatHashSparseSSPRecorder, Grow) {
+  FlatHashSparseSSPRecorder recorder(1, 1, 16);
+  const int num_keys = 1000;
+  third_party::SArray<Key> keys;
+  for (int k = 0; k < num_keys; ++k)
+    keys.push_back(k * 7919);
+  Message get_2_0 = CreateGet(2, 0, keys);
+  recorder.AddRecord(get_2_0);
+  EXPECT_EQ(recorder.Size(), num_keys);
+
+  std::vector<Message> msgs;
+  recorder.GetNonConflictMsgs(1, 2, 0, &msgs);
+  EXPECT_EQ(msgs.size(), 0);
+  EXPECT_EQ(recorder.Size(), 0);
+}
+
+TEST_F(TestFlatHashSparseSSPRecorder, SameRepliesAsUnorderedMap) {
+  const int num_workers = 4;
+  const int num_iters = 50;
+  for (Key num_keys : {8u, 1000000u}) {
+    auto keys = RandomReplayKeys(num_workers, num_iters, num_keys, num_keys == 8 ? 3 : 100, 0);
+    for (int staleness : {0, 1, 2}) {
+      for (int speculation : {1, 2}) {
+        SparseSSPReplayLog expected;
+        EXPECT_TRUE(ReplaySparseSSP(std::unique_ptr<AbstractStorage>(new MapStorage<int>()),
+                                    std::unique_ptr<AbstractSparseSSPRecorder>(
+                                        new UnorderedMapSparseSSPRecorder(staleness, speculation)),
+                                    staleness, speculation, keys, 0, &expected));
+        SparseSSPReplayLog log;
+        EXPECT_TRUE(ReplaySparseSSP(std::unique_ptr<AbstractStorage>(new MapStorage<int>()),
+                                    std::unique_ptr<AbstractSparseSSPRecorder>(
+                                        new FlatHashSparseSSPRecorder(staleness, speculation, 16)),
+                                    staleness, speculation, keys, 0, &log));
+        EXPECT_EQ(log.size(), num_workers * num_iters);
+        EXPECT_TRUE(log == expected) << "num_keys: " << num_keys << " staleness: " << staleness
+                                     << " speculation: " << speculation;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace flexps
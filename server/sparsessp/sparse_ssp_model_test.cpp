@@ -31,7 +31,7 @@ TEST_F(TestSparseSSPModel, SArrayCasting) {
 TEST_F(TestSparseSSPModel, CreateMessage) {
   Message m1 = CreateMessage(Flag::kAdd, 0, 3, 0, 0, {1}, {2});
   EXPECT_EQ(m1.data.size(), 2);
-  auto rep_keys = third_party::SArray<int>(m1.data[0]);
+  auto rep_keys = third_party::SArray<Key>(m1.data[0]);
   auto rep_vals = third_party::SArray<int>(m1.data[1]);
   EXPECT_EQ(m1.meta.flag, Flag::kAdd);
   EXPECT_EQ(rep_keys.size(), 1);
@@ -41,7 +41,7 @@ TEST_F(TestSparseSSPModel, CreateMessage) {
 
   Message m2 = CreateMessage(Flag::kGet, 0, 3, 0, 0, {3});
   EXPECT_EQ(m2.data.size(), 1);
-  rep_keys = third_party::SArray<int>(m2.data[0]);
+  rep_keys = third_party::SArray<Key>(m2.data[0]);
   EXPECT_EQ(m2.meta.flag, Flag::kGet);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_keys[0], 3);
@@ -84,7 +84,7 @@ TEST_F(TestSparseSSPModel, GetAndAdd) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   // worker2 add 0 to param 0 with version 0
@@ -102,7 +102,7 @@ TEST_F(TestSparseSSPModel, GetAndAdd) {
   // // Check
   // reply_queue.WaitAndPop(&check_msg);
   // EXPECT_EQ(check_msg.data.size(), 2);
-  // rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  // rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   // rep_vals = third_party::SArray<int>(check_msg.data[1]);
   // EXPECT_EQ(rep_keys.size(), 1);
   // EXPECT_EQ(rep_vals.size(), 1);
@@ -118,7 +118,7 @@ TEST_F(TestSparseSSPModel, GetAndAdd) {
 
   // reply_queue.WaitAndPop(&check_msg);
   // EXPECT_EQ(check_msg.data.size(), 2);
-  // rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  // rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   // rep_vals = third_party::SArray<int>(check_msg.data[1]);
   // EXPECT_EQ(rep_keys.size(), 1);
   // EXPECT_EQ(rep_vals.size(), 1);
@@ -148,7 +148,7 @@ TEST_F(TestSparseSSPModel, GetAndAdd) {
 
   // reply_queue.WaitAndPop(&check_msg);
   // EXPECT_EQ(check_msg.data.size(), 2);
-  // rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  // rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   // rep_vals = third_party::SArray<int>(check_msg.data[1]);
   // EXPECT_EQ(rep_keys.size(), 1);
   // EXPECT_EQ(rep_vals.size(), 1);
@@ -182,7 +182,7 @@ TEST_F(TestSparseSSPModel, SpeculationNoConflict) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   // Message1
@@ -245,7 +245,7 @@ TEST_F(TestSparseSSPModel, SpeculationNoConflict) {
   // check
   reply_queue.WaitAndPop(&check_msg);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -264,7 +264,7 @@ TEST_F(TestSparseSSPModel, SpeculationNoConflict) {
   // check
   reply_queue.WaitAndPop(&check_msg);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -313,7 +313,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1Conflict) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -330,7 +330,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1Conflict) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -343,7 +343,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1Conflict) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -404,7 +404,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase1) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -421,7 +421,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase1) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -434,7 +434,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase1) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -454,7 +454,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase1) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -515,7 +515,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase2) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -532,7 +532,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase2) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -545,7 +545,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase2) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -566,7 +566,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase2) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -594,7 +594,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation1NoConflictCase2) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -638,7 +638,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Conflict) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -655,7 +655,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Conflict) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -668,7 +668,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Conflict) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -738,7 +738,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case1) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -755,7 +755,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case1) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -768,7 +768,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case1) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -795,7 +795,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case1) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 1);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -815,7 +815,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case1) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 2);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -872,7 +872,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case2) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -889,7 +889,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case2) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -902,7 +902,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case2) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -929,7 +929,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case2) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 1);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -949,7 +949,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case2) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 2);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1015,7 +1015,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case3) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -1032,7 +1032,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case3) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1045,7 +1045,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case3) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1072,7 +1072,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case3) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 1);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1092,7 +1092,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case3) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 2);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1165,7 +1165,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case4) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -1182,7 +1182,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case4) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1195,7 +1195,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case4) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1222,7 +1222,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case4) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 1);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1242,7 +1242,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case4) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 2);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1325,7 +1325,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case5) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -1342,7 +1342,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case5) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1355,7 +1355,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case5) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1382,7 +1382,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case5) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 1);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1448,7 +1448,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case6) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -1465,7 +1465,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case6) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1478,7 +1478,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case6) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1505,7 +1505,7 @@ TEST_F(TestSparseSSPModel, staleness0speculation2Case6) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 1);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1579,7 +1579,7 @@ TEST_F(TestSparseSSPModel, ClockWithoutGet) {
 
   // for Check use
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   Message msg;
@@ -1596,7 +1596,7 @@ TEST_F(TestSparseSSPModel, ClockWithoutGet) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 0);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1609,7 +1609,7 @@ TEST_F(TestSparseSSPModel, ClockWithoutGet) {
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 3);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -1634,7 +1634,7 @@ TEST_F(TestSparseSSPModel, ClockWithoutGet) {
   EXPECT_EQ(check_msg.meta.recver, 2);
   EXPECT_EQ(check_msg.meta.version, 1);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
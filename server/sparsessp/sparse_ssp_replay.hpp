@@ -0,0 +1,128 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "base/threadsafe_queue.hpp"
+#include "server/abstract_storage.hpp"
+#include "server/sparsessp/abstract_sparse_ssp_recorder.hpp"
+#include "server/sparsessp/sparse_ssp_model.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace flexps {
+
+// <recver, version, keys> of every reply of a replay
+using SparseSSPReplayLog = std::vector<std::tuple<int, int, std::vector<Key>>>;
+
+// keys[w][c], 1 to max_nonzeros distinct sorted keys in [0, num_keys) for clock c of worker w
+inline std::vector<std::vector<third_party::SArray<Key>>> RandomReplayKeys(int num_workers, int num_iters,
+                                                                          Key num_keys, int max_nonzeros,
+                                                                          uint32_t seed) {
+  CHECK_GT(max_nonzeros, 0);
+  CHECK_LE(static_cast<Key>(max_nonzeros), num_keys);
+  std::mt19937_64 gen(seed);
+  std::vector<std::vector<third_party::SArray<Key>>> keys(num_workers);
+  std::vector<Key> picked;
+  for (auto& worker_keys : keys) {
+    for (int c = 0; c < num_iters; ++c) {
+      size_t num_nonzeros = 1 + gen() % max_nonzeros;
+      picked.clear();
+      while (picked.size() < num_nonzeros) {
+        Key key = gen() % num_keys;
+        if (std::find(picked.begin(), picked.end(), key) == picked.end())
+          picked.push_back(key);
+      }
+      std::sort(picked.begin(), picked.end());
+      worker_keys.push_back(third_party::SArray<Key>(picked));
+    }
+  }
+  return keys;
+}
+
+/*
+ * Replay the Gets of keys[w][c] of workers 2 to keys.size() + 1 on a SparseSSPModel in one thread,
+ * for testing and benchmarking the recorders without an engine.
+ *
+ * Each worker sends its Get of clock 0 and, once the reply of clock c arrives, the Get of clock
+ * c + 1 before the Clock of c, as a SparseKVClientTable with speculation >= 1 does. The worker to
+ * go next is drawn from the replied ones by a generator seeded with seed, so that a replay is the
+ * same for every recorder that replies the same. Return false if the workers got blocked before
+ * their last clock.
+ */
+inline bool ReplaySparseSSP(std::unique_ptr<AbstractStorage>&& storage,
+                            std::unique_ptr<AbstractSparseSSPRecorder>&& recorder, int staleness, int speculation,
+                            const std::vector<std::vector<third_party::SArray<Key>>>& keys, uint32_t seed,
+                            SparseSSPReplayLog* log = nullptr) {
+  CHECK_GE(speculation, 1);
+  const int num_workers = keys.size();
+  ThreadsafeQueue<Message> reply_queue;
+  SparseSSPModel model(0, std::move(storage), std::move(recorder), &reply_queue, staleness, speculation);
+  third_party::SArray<uint32_t> tids;
+  for (int i = 0; i < num_workers; ++i)
+    tids.push_back(i + 2);
+  Message reset_msg;
+  reset_msg.AddData(tids);
+  model.ResetWorker(reset_msg);
+  Message reply;
+  reply_queue.WaitAndPop(&reply);
+
+  auto send_get = [&model, &keys](int i, int version) {
+    Message get;
+    get.meta.flag = Flag::kGet;
+    get.meta.sender = i + 2;
+    get.meta.version = version;
+    get.AddData(keys[i][version]);
+    model.Get(get);
+  };
+
+  std::mt19937 gen(seed);
+  std::vector<int> clocks(num_workers, 0);
+  std::vector<bool> replied(num_workers, false);
+  for (int i = 0; i < num_workers; ++i) {
+    if (!keys[i].empty())
+      send_get(i, 0);
+  }
+  std::vector<int> ready;
+  while (true) {
+    while (reply_queue.Size() > 0) {
+      reply_queue.WaitAndPop(&reply);
+      int i = reply.meta.recver - 2;
+      CHECK_EQ(reply.meta.version, clocks[i]);
+      replied[i] = true;
+      if (log) {
+        third_party::SArray<Key> reply_keys(reply.data[0]);
+        log->emplace_back(reply.meta.recver, reply.meta.version,
+                          std::vector<Key>(reply_keys.begin(), reply_keys.end()));
+      }
+    }
+    ready.clear();
+    for (int i = 0; i < num_workers; ++i) {
+      if (replied[i])
+        ready.push_back(i);
+    }
+    if (ready.empty())
+      break;
+    int i = ready[gen() % ready.size()];
+    replied[i] = false;
+    if (clocks[i] + 1 < static_cast<int>(keys[i].size()))
+      send_get(i, clocks[i] + 1);
+    Message clock;
+    clock.meta.flag = Flag::kClock;
+    clock.meta.sender = i + 2;
+    clock.meta.version = clocks[i];
+    model.Clock(clock);
+    clocks[i] += 1;
+  }
+  for (int i = 0; i < num_workers; ++i) {
+    if (clocks[i] != static_cast<int>(keys[i].size()))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace flexps
@@ -17,7 +17,7 @@ void UnorderedMapSparseSSPRecorder::GetNonConflictMsgs(int progress, int sender,
     if (msg.meta.version <= staleness_ + min_clock) {
       msgs->push_back(std::move(msg));
     } else if (msg.meta.version <= min_clock + staleness_ + speculation_) {
-      int forwarded_key = -1;
+      Key forwarded_key = 0;
       int forwarded_version = -1;
       if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock, 
              msg.meta.version - staleness_ - 1, &forwarded_key, &forwarded_version)) {
@@ -36,7 +36,7 @@ void UnorderedMapSparseSSPRecorder::GetNonConflictMsgs(int progress, int sender,
 
 void UnorderedMapSparseSSPRecorder::HandleTooFastBuffer(int min_clock, std::vector<Message>* const msgs) {
   for (auto& msg : too_fast_buffer_) {
-    int forwarded_key = -1;
+    Key forwarded_key = 0;
     int forwarded_version = -1;
     if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock,
           msg.meta.version - staleness_ - 1, &forwarded_key, &forwarded_version)) {
@@ -78,7 +78,7 @@ void UnorderedMapSparseSSPRecorder::RemoveRecordAndGetNonConflictMsgs(int versio
     }
   }
   for (auto& msg : msgs_to_be_handled) {
-    int forwarded_key = -1;
+    Key forwarded_key = 0;
     int forwarded_version = -1;
     if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock, msg.meta.version - staleness_ - 1,
            &forwarded_key, &forwarded_version)) {
@@ -98,7 +98,7 @@ void UnorderedMapSparseSSPRecorder::RemoveRecord(const int version) {
  *   ONE or SEVERAL conflict: append to the corresponding get buffer, return true
  */
 bool UnorderedMapSparseSSPRecorder::HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
-                                          const int end_version, int* forwarded_key, int* forwarded_version) {
+                                          const int end_version, Key* forwarded_key, int* forwarded_version) {
   for (int check_version = end_version; check_version >= begin_version; check_version--) {
     for (auto& key : keys) {
       auto it = main_recorder_[check_version].find(key);
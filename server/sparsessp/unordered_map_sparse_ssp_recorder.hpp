@@ -21,13 +21,13 @@ private:
                        const third_party::SArray<Key>& keys, std::vector<Message>* msgs);
 
   bool HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
-                   const int end_version, int* forwarded_key, int* forwarded_version);
+                   const int end_version, Key* forwarded_key, int* forwarded_version);
 
   uint32_t staleness_;
   uint32_t speculation_;
 
   // <version, <key, {count, [msg]}>>
-  std::unordered_map<int, std::unordered_map<uint32_t, std::pair<uint32_t, std::vector<Message>>>> main_recorder_;
+  std::unordered_map<int, std::unordered_map<Key, std::pair<uint32_t, std::vector<Message>>>> main_recorder_;
 
   // <thread_id, [<version, key>]>, has at most speculation_ + 1 queue size for each thread_id
   std::unordered_map<int, std::queue<std::pair<int, third_party::SArray<Key>>>> future_keys_;
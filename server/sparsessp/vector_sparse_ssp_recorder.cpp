@@ -60,7 +60,7 @@ void VectorSparseSSPRecorder::GetNonConflictMsgs(int progress, int sender, int m
       by_staleness_ += 1;
 #endif
     } else if (msg.meta.version <= min_clock + staleness_ + speculation_) {
-      int forwarded_key = -1;
+      Key forwarded_key = 0;
       int forwarded_version = -1;
       if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock, 
              msg.meta.version - staleness_ - 1, &forwarded_key, &forwarded_version)) {
@@ -93,7 +93,7 @@ void VectorSparseSSPRecorder::GetNonConflictMsgs(int progress, int sender, int m
 
 void VectorSparseSSPRecorder::HandleTooFastBuffer(int min_clock, std::vector<Message>* const msgs) {
   for (auto& msg : too_fast_buffer_) {
-    int forwarded_key = -1;
+    Key forwarded_key = 0;
     int forwarded_version = -1;
     if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock,
           msg.meta.version - staleness_ - 1, &forwarded_key, &forwarded_version)) {
@@ -137,7 +137,7 @@ void VectorSparseSSPRecorder::RemoveRecordAndGetNonConflictMsgs(int version, int
   std::vector<Message> msgs_to_be_handled;
   int version_after_mod = version % main_recorder_version_level_size_;
   for (auto key : keys) {
-    int key_after_minus = key - range_.begin();
+    size_t key_after_minus = key - range_.begin();
     DCHECK_GE(main_recorder_[version_after_mod][key_after_minus].first, 0);
     main_recorder_[version_after_mod][key_after_minus].first -= 1;
     if (main_recorder_[version_after_mod][key_after_minus].first == 0) {
@@ -149,7 +149,7 @@ void VectorSparseSSPRecorder::RemoveRecordAndGetNonConflictMsgs(int version, int
   }
 
   for (auto& msg : msgs_to_be_handled) {
-    int forwarded_key = -1;
+    Key forwarded_key = 0;
     int forwarded_version = -1;
     if (HasConflict(third_party::SArray<Key>(msg.data[0]), min_clock, msg.meta.version - staleness_ - 1,
            &forwarded_key, &forwarded_version)) {
@@ -174,7 +174,7 @@ void VectorSparseSSPRecorder::RemoveRecord(const int version) {
  *   ONE or SEVERAL conflict: append to the corresponding get buffer, return true
  */
 bool VectorSparseSSPRecorder::HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
-                                          const int end_version, int* forwarded_key, int* forwarded_version) {
+                                          const int end_version, Key* forwarded_key, int* forwarded_version) {
   for (int check_version = end_version; check_version >= begin_version; check_version--) {
     for (auto& key : keys) {
       if (main_recorder_[check_version % main_recorder_version_level_size_][key - range_.begin()].first > 0) {
@@ -23,10 +23,10 @@ public:
 
 private:
   void RemoveRecordAndGetNonConflictMsgs(int version, int min_clock, uint32_t tid,
-                       const third_party::SArray<uint32_t>& keys, std::vector<Message>* msgs);
+                       const third_party::SArray<Key>& keys, std::vector<Message>* msgs);
 
-  bool HasConflict(const third_party::SArray<uint32_t>& keys, const int begin_version,
-                   const int end_version, int* forwarded_key, int* forwarded_version);
+  bool HasConflict(const third_party::SArray<Key>& keys, const int begin_version,
+                   const int end_version, Key* forwarded_key, int* forwarded_version);
 
   uint32_t staleness_;
   uint32_t speculation_;
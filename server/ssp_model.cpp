@@ -48,6 +48,7 @@ void SSPModel::ResetWorker(Message& msg) {
   for (auto tid : tids)
     tids_vec.push_back(tid);
   this->progress_tracker_.Init(tids_vec);
+  buffer_.Reset();
   Message reply_msg;
   reply_msg.meta.model_id = model_id_;
   reply_msg.meta.recver = msg.meta.sender;
@@ -11,6 +11,10 @@
 
 namespace flexps {
 
+/*
+ * Deprecated: KVEngine builds Model<Storage, SSPConsistency> (server/model.hpp) instead, which also
+ * supports Subscribe and AdaptStaleness. Kept for test/test_server.cpp and the model benchmark only.
+ */
 class SSPModel : public AbstractModel {
  public:
   explicit SSPModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr, int staleness,
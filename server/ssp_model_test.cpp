@@ -46,7 +46,7 @@ TEST_F(TestSSPModel, CheckGetAndAdd) {
   m3.meta.model_id = 0;
   m3.meta.sender = 2;
   m3.meta.recver = 0;
-  third_party::SArray<int> m3_keys({0});
+  third_party::SArray<Key> m3_keys({0});
   third_party::SArray<int> m3_vals({1});
   m3.AddData(m3_keys);
   m3.AddData(m3_vals);
@@ -57,7 +57,7 @@ TEST_F(TestSSPModel, CheckGetAndAdd) {
   m4.meta.model_id = 0;
   m4.meta.sender = 3;
   m4.meta.recver = 0;
-  third_party::SArray<int> m4_keys({1});
+  third_party::SArray<Key> m4_keys({1});
   third_party::SArray<int> m4_vals({2});
   m4.AddData(m4_keys);
   m4.AddData(m4_vals);
@@ -68,7 +68,7 @@ TEST_F(TestSSPModel, CheckGetAndAdd) {
   m5.meta.model_id = 0;
   m5.meta.sender = 2;
   m5.meta.recver = 0;
-  third_party::SArray<int> m5_keys({0});
+  third_party::SArray<Key> m5_keys({0});
   m5.AddData(m5_keys);
 
   // Message6
@@ -77,7 +77,7 @@ TEST_F(TestSSPModel, CheckGetAndAdd) {
   m6.meta.model_id = 0;
   m6.meta.sender = 3;
   m6.meta.recver = 0;
-  third_party::SArray<int> m6_keys({1});
+  third_party::SArray<Key> m6_keys({1});
   m6.AddData(m6_keys);
 
   model.get()->Add(m3);
@@ -87,14 +87,14 @@ TEST_F(TestSSPModel, CheckGetAndAdd) {
 
   // Check
   Message check_msg;
-  auto rep_keys = third_party::SArray<int>();
+  auto rep_keys = third_party::SArray<Key>();
   auto rep_vals = third_party::SArray<int>();
 
   EXPECT_EQ(reply_queue.Size(), 2);
 
   reply_queue.WaitAndPop(&check_msg);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -105,7 +105,7 @@ TEST_F(TestSSPModel, CheckGetAndAdd) {
 
   reply_queue.WaitAndPop(&check_msg);
   EXPECT_EQ(check_msg.data.size(), 2);
-  rep_keys = third_party::SArray<int>(check_msg.data[0]);
+  rep_keys = third_party::SArray<Key>(check_msg.data[0]);
   rep_vals = third_party::SArray<int>(check_msg.data[1]);
   EXPECT_EQ(rep_keys.size(), 1);
   EXPECT_EQ(rep_vals.size(), 1);
@@ -177,7 +177,7 @@ TEST_F(TestSSPModel, CheckStaleness) {
   m1.meta.model_id = 0;
   m1.meta.sender = 2;
   m1.meta.recver = 0;
-  third_party::SArray<int> m1_keys({0});
+  third_party::SArray<Key> m1_keys({0});
   m1.AddData(m1_keys);
   model.get()->Get(m1);
   reply_queue.WaitAndPop(&m1);
@@ -196,7 +196,7 @@ TEST_F(TestSSPModel, CheckStaleness) {
   m3.meta.model_id = 0;
   m3.meta.sender = 2;
   m3.meta.recver = 0;
-  third_party::SArray<int> m3_keys({0});
+  third_party::SArray<Key> m3_keys({0});
   third_party::SArray<int> m3_vals({1});
   m3.AddData(m3_keys);
   m3.AddData(m3_vals);
@@ -224,7 +224,7 @@ TEST_F(TestSSPModel, CheckStaleness) {
   m.meta.model_id = 0;
   m.meta.sender = 2;
   m.meta.recver = 0;
-  third_party::SArray<int> m_keys1({0});
+  third_party::SArray<Key> m_keys1({0});
   m.AddData(m_keys1);
   model.get()->Get(m);
   EXPECT_EQ(dynamic_cast<SSPModel*>(model.get())->GetPendingSize(1), 1);
@@ -243,7 +243,7 @@ TEST_F(TestSSPModel, CheckStaleness) {
   m7.meta.model_id = 0;
   m7.meta.sender = 2;
   m7.meta.recver = 0;
-  third_party::SArray<int> m7_keys({0});
+  third_party::SArray<Key> m7_keys({0});
   m7.AddData(m7_keys);
   model.get()->Get(m7);
   EXPECT_EQ(dynamic_cast<SSPModel*>(model.get())->GetPendingSize(1), 0);
@@ -0,0 +1,103 @@
+#include "server/staleness_controller.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+
+namespace flexps {
+
+constexpr double StalenessController::kMaxEvenSpread;
+constexpr double StalenessController::kIntervalWeight;
+
+StalenessController::StalenessController(int min_staleness, int max_staleness, int staleness, int window,
+                                         double raise_ratio, double lower_ratio)
+    : min_staleness_(min_staleness),
+      max_staleness_(max_staleness),
+      window_(window),
+      raise_ratio_(raise_ratio),
+      lower_ratio_(lower_ratio),
+      staleness_(std::min(std::max(staleness, min_staleness), max_staleness)) {
+  CHECK_GE(min_staleness, 0);
+  CHECK_LE(min_staleness, max_staleness);
+  CHECK_GT(window, 0);
+  CHECK_LE(lower_ratio, raise_ratio);
+}
+
+void StalenessController::OnClock(int tid, TimePoint now) {
+  auto it = rates_.find(tid);
+  if (it == rates_.end()) {
+    rates_[tid].last_clock = now;
+    return;
+  }
+  auto& rate = it->second;
+  double interval_ns = std::chrono::duration<double, std::nano>(now - rate.last_clock).count();
+  rate.interval_ns =
+      rate.interval_ns == 0 ? interval_ns : kIntervalWeight * interval_ns + (1 - kIntervalWeight) * rate.interval_ns;
+  rate.last_clock = now;
+}
+
+void StalenessController::OnBlocked(int delta, TimePoint now) {
+  AccumulateBlocked(now);
+  num_blocked_ += delta;
+  CHECK_GE(num_blocked_, 0);
+}
+
+void StalenessController::Reset() {
+  rates_.clear();
+  num_blocked_ = 0;
+  blocked_ns_ = 0;
+  num_advances_ = -1;
+}
+
+int StalenessController::OnMinClock(int min_clock, TimePoint now) {
+  AccumulateBlocked(now);
+  if (num_advances_ < 0 || ++num_advances_ < window_) {
+    if (num_advances_ < 0) {
+      // The window starts at the first advance, after the workers started.
+      num_advances_ = 0;
+      window_start_ = now;
+      blocked_ns_ = 0;
+    }
+    return staleness_;
+  }
+  double elapsed_ns = std::chrono::duration<double, std::nano>(now - window_start_).count();
+  double blocked_ratio = elapsed_ns > 0 && !rates_.empty() ? blocked_ns_ / (elapsed_ns * rates_.size()) : 0;
+  double spread = Spread();
+  int staleness = staleness_;
+  if (blocked_ratio > raise_ratio_ && staleness_ < max_staleness_)
+    staleness = staleness_ + 1;
+  else if (blocked_ratio < lower_ratio_ && spread <= kMaxEvenSpread && staleness_ > min_staleness_)
+    staleness = staleness_ - 1;
+  if (staleness != staleness_)
+    LOG(INFO) << "Staleness " << staleness_ << " -> " << staleness << " at min clock " << min_clock
+              << ": workers blocked " << blocked_ratio * 100 << "% of the time, slowest/fastest clock interval "
+              << spread;
+  else
+    VLOG(1) << "Staleness stays " << staleness_ << " at min clock " << min_clock << ": workers blocked "
+            << blocked_ratio * 100 << "% of the time, slowest/fastest clock interval " << spread;
+  staleness_ = staleness;
+  num_advances_ = 0;
+  window_start_ = now;
+  blocked_ns_ = 0;
+  return staleness_;
+}
+
+void StalenessController::AccumulateBlocked(TimePoint now) {
+  if (num_blocked_ > 0)
+    blocked_ns_ += num_blocked_ * std::chrono::duration<double, std::nano>(now - last_blocked_change_).count();
+  last_blocked_change_ = now;
+}
+
+double StalenessController::Spread() const {
+  double fastest = 0, slowest = 0;
+  for (const auto& kv : rates_) {
+    double interval_ns = kv.second.interval_ns;
+    if (interval_ns == 0)
+      continue;
+    fastest = fastest == 0 ? interval_ns : std::min(fastest, interval_ns);
+    slowest = std::max(slowest, interval_ns);
+  }
+  return fastest > 0 ? slowest / fastest : 1;
+}
+
+}  // namespace flexps
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+namespace flexps {
+
+/*
+ * Adjusts the staleness of an SSP model within [min_staleness, max_staleness] (see
+ * KVEngine::AdaptStaleness).
+ *
+ * The model reports the clocks of the workers and the changes of the number of Gets blocked in its
+ * PendingBuffer. Every window min clock advances, the controller compares the time the workers spent
+ * blocked with the time elapsed:
+ * - above raise_ratio, the staleness grows by one so that the workers ahead wait less;
+ * - below lower_ratio, with the workers clocking at about the same rate (no straggler left), the
+ *   staleness shrinks by one so that the workers read fresher values again.
+ * Each change is logged. A persistent straggler makes the workers ahead drift at most max_staleness
+ * clocks ahead, as with a fixed staleness.
+ */
+class StalenessController {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  // The ratios are of the time the workers spent blocked.
+  StalenessController(int min_staleness, int max_staleness, int staleness, int window = 8,
+                      double raise_ratio = 0.05, double lower_ratio = 0.01);
+
+  int GetStaleness() const { return staleness_; }
+
+  void OnClock(int tid, TimePoint now);
+  // The worker left the model (see KVEngine::RetireWorkers).
+  void OnRetire(int tid) { rates_.erase(tid); }
+  // The number of blocked Gets changed by delta.
+  void OnBlocked(int delta, TimePoint now);
+  // The min clock advanced to min_clock, return the staleness from now on.
+  int OnMinClock(int min_clock, TimePoint now);
+  // A new task starts with no blocked Gets (see SSPConsistency::Reset), the staleness carries over.
+  void Reset();
+
+ private:
+  // A worker whose clock interval is at most this many times the one of the fastest is not a straggler.
+  static constexpr double kMaxEvenSpread = 1.25;
+  // The weight of the latest interval in the moving average of the clock interval of a worker.
+  static constexpr double kIntervalWeight = 0.25;
+
+  struct WorkerRate {
+    TimePoint last_clock;
+    double interval_ns = 0;  // 0 until the second clock
+  };
+
+  void AccumulateBlocked(TimePoint now);
+  // The clock interval of the slowest worker over the one of the fastest, 1 if unknown.
+  double Spread() const;
+
+  const int min_staleness_;
+  const int max_staleness_;
+  const int window_;
+  const double raise_ratio_;
+  const double lower_ratio_;
+  int staleness_;
+
+  std::unordered_map<int, WorkerRate> rates_;
+  int num_blocked_ = 0;
+  TimePoint last_blocked_change_;
+  // Blocked Gets times the time they were blocked, in the current window
+  double blocked_ns_ = 0;
+  TimePoint window_start_;
+  int num_advances_ = -1;  // -1 before the first min clock advance
+};
+
+}  // namespace flexps
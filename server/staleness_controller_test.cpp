@@ -0,0 +1,86 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/staleness_controller.hpp"
+
+namespace flexps {
+namespace {
+
+class TestStalenessController : public testing::Test {
+ public:
+  TestStalenessController() {}
+  ~TestStalenessController() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+using TimePoint = StalenessController::TimePoint;
+
+TimePoint At(int ms) { return TimePoint(std::chrono::milliseconds(ms)); }
+
+/*
+ * Worker 0 clocks every fast_ms and worker 1 every slow_ms ms, for num_clocks clocks of worker 1
+ * from start_ms on, and the min clock advances with worker 1. If blocked, worker 0 waits for the
+ * min clock from its second clock on. Return the staleness after each advance.
+ */
+std::vector<int> RunClocks(StalenessController* controller, int start_ms, int fast_ms, int slow_ms, int num_clocks,
+                     bool blocked) {
+  std::vector<int> staleness;
+  for (int i = 1; i <= num_clocks; ++i) {
+    for (int t = (i - 1) * slow_ms + fast_ms; t <= i * slow_ms; t += fast_ms)
+      controller->OnClock(0, At(start_ms + t));
+    if (blocked)
+      controller->OnBlocked(1, At(start_ms + (i - 1) * slow_ms + fast_ms));
+    controller->OnClock(1, At(start_ms + i * slow_ms));
+    if (blocked)
+      controller->OnBlocked(-1, At(start_ms + i * slow_ms));
+    staleness.push_back(controller->OnMinClock(i, At(start_ms + i * slow_ms)));
+  }
+  return staleness;
+}
+
+TEST_F(TestStalenessController, Clamp) {
+  EXPECT_EQ(StalenessController(2, 4, 0).GetStaleness(), 2);
+  EXPECT_EQ(StalenessController(2, 4, 3).GetStaleness(), 3);
+  EXPECT_EQ(StalenessController(2, 4, 9).GetStaleness(), 4);
+}
+
+TEST_F(TestStalenessController, RaiseWhenBlocked) {
+  StalenessController controller(0, 2, 0, 4);
+  // Worker 0 is blocked most of the time: +1 every 4 advances, up to the max.
+  auto staleness = RunClocks(&controller, 0, 10, 40, 13, true);
+  EXPECT_EQ(staleness[3], 0);  // the first window starts at the first advance
+  EXPECT_EQ(staleness[4], 1);
+  EXPECT_EQ(staleness[8], 2);
+  EXPECT_EQ(staleness[12], 2);
+}
+
+TEST_F(TestStalenessController, LowerWithoutStraggler) {
+  StalenessController controller(1, 5, 3, 4);
+  // A straggler that blocks no one keeps the staleness.
+  auto staleness = RunClocks(&controller, 0, 10, 40, 9, false);
+  EXPECT_EQ(staleness.back(), 3);
+  // Once the clock rates of the workers even out, it shrinks to the min.
+  staleness = RunClocks(&controller, 360, 40, 40, 16, false);
+  EXPECT_EQ(staleness[3], 3);  // the moving average of worker 0 still lags
+  EXPECT_EQ(staleness[7], 2);
+  EXPECT_EQ(staleness[11], 1);
+  EXPECT_EQ(staleness.back(), 1);
+}
+
+TEST_F(TestStalenessController, Reset) {
+  StalenessController controller(0, 2, 0, 4);
+  auto staleness = RunClocks(&controller, 0, 10, 40, 5, true);
+  EXPECT_EQ(staleness.back(), 1);
+  // The staleness carries over, the window starts again at the first advance of the new task.
+  controller.Reset();
+  EXPECT_EQ(controller.GetStaleness(), 1);
+  staleness = RunClocks(&controller, 1000, 10, 40, 5, true);
+  EXPECT_EQ(staleness[3], 1);
+  EXPECT_EQ(staleness[4], 2);
+}
+
+}  // namespace
+}  // namespace flexps
@@ -0,0 +1,56 @@
+#include "server/subscriptions.hpp"
+
+#include "base/key_ranges.hpp"
+
+#include "glog/logging.h"
+
+namespace flexps {
+
+Message& Subscriptions::Add(const Message& msg) {
+  CHECK(msg.meta.flag == Flag::kSubscribe);
+  CHECK_EQ(msg.data.size(), 1);
+  third_party::SArray<Key> keys(msg.data[0]);
+  Message get;
+  get.meta = msg.meta;
+  third_party::SArray<Key> ranges = ToKeyRanges(keys);
+  if (ranges.size() < keys.size()) {
+    get.meta.flag = Flag::kGetRange;
+    get.AddData(ranges);
+  } else {
+    get.meta.flag = Flag::kGet;
+    get.AddData(keys);
+  }
+  auto it = index_.find(msg.meta.sender);
+  if (it != index_.end()) {
+    gets_[it->second] = std::move(get);
+    return gets_[it->second];
+  }
+  index_[msg.meta.sender] = gets_.size();
+  gets_.push_back(std::move(get));
+  return gets_.back();
+}
+
+void Subscriptions::Remove(int sender) {
+  auto it = index_.find(sender);
+  if (it == index_.end())
+    return;
+  size_t pos = it->second;
+  index_.erase(it);
+  if (pos + 1 != gets_.size()) {
+    gets_[pos] = std::move(gets_.back());
+    index_[gets_[pos].meta.sender] = pos;
+  }
+  gets_.pop_back();
+}
+
+Message Subscriptions::ToPush(Message&& reply, int version) {
+  CHECK_EQ(reply.data.size(), 2);
+  Message push;
+  push.meta = reply.meta;
+  push.meta.flag = Flag::kPush;
+  push.meta.version = version;
+  push.data.push_back(std::move(reply.data[1]));
+  return push;
+}
+
+}  // namespace flexps
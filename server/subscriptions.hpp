@@ -0,0 +1,44 @@
+#pragma once
+
+#include "base/message.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * The key sets the workers subscribed to with kSubscribe (see KVClientTable::Subscribe).
+ *
+ * Each subscription is kept as the Get request of its keys, a kGetRange if the keys are mostly runs,
+ * so that the subscriptions can be served together by AbstractStorage::GetBatch whenever the min
+ * clock advances. Their replies are turned into kPush messages to the subscribers, whose version is
+ * the latest clock the pushed values may serve.
+ */
+class Subscriptions {
+ public:
+  // Register the subscription of msg.meta.sender to the sorted keys msg.data[0] of a kSubscribe and
+  // return its Get request. A later subscription of the same worker replaces it.
+  Message& Add(const Message& msg);
+  // Drop the subscription of a worker, on a kSubscribe without keys.
+  void Remove(int sender);
+  // Drop every subscription, for a new task.
+  void Clear() {
+    gets_.clear();
+    index_.clear();
+  }
+
+  bool Empty() const { return gets_.empty(); }
+  // One Get request per subscriber.
+  std::vector<Message>& GetRequests() { return gets_; }
+
+  // The push of the values of a reply to a subscription, data[0] holds the values only.
+  static Message ToPush(Message&& reply, int version);
+
+ private:
+  std::vector<Message> gets_;
+  // Subscriber -> its request in gets_
+  std::unordered_map<int, size_t> index_;
+};
+
+}  // namespace flexps
@@ -0,0 +1,61 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/subscriptions.hpp"
+
+namespace flexps {
+namespace {
+
+class TestSubscriptions : public testing::Test {
+ public:
+  TestSubscriptions() {}
+  ~TestSubscriptions() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestSubscriptions, AddRemove) {
+  Subscriptions subscriptions;
+  EXPECT_TRUE(subscriptions.Empty());
+  Message m1 = CreateMessage(Flag::kSubscribe, 0, 2, 0, 0, {1, 4, 9});
+  Message m2 = CreateMessage(Flag::kSubscribe, 0, 3, 0, 0, {0, 1, 2, 3, 4, 5});
+  Message m3 = CreateMessage(Flag::kSubscribe, 0, 2, 0, 0, {7});
+
+  // Sparse keys are read by a kGet, runs by a kGetRange.
+  EXPECT_EQ(subscriptions.Add(m1).meta.flag, Flag::kGet);
+  Message& get = subscriptions.Add(m2);
+  EXPECT_EQ(get.meta.flag, Flag::kGetRange);
+  third_party::SArray<Key> ranges(get.data[0]);
+  ASSERT_EQ(ranges.size(), 2);
+  EXPECT_EQ(ranges[0], 0);
+  EXPECT_EQ(ranges[1], 5);
+
+  subscriptions.Add(m3);
+  ASSERT_EQ(subscriptions.GetRequests().size(), 2);
+  EXPECT_EQ(third_party::SArray<Key>(subscriptions.GetRequests()[0].data[0]).size(), 1);
+
+  subscriptions.Remove(2);
+  ASSERT_EQ(subscriptions.GetRequests().size(), 1);
+  EXPECT_EQ(subscriptions.GetRequests()[0].meta.sender, 3);
+  subscriptions.Remove(2);
+  subscriptions.Remove(3);
+  EXPECT_TRUE(subscriptions.Empty());
+}
+
+TEST_F(TestSubscriptions, ToPush) {
+  Message reply = CreateMessage(Flag::kGetReply, 0, 1, 2, 0, {3, 4}, {30, 40});
+  Message push = Subscriptions::ToPush(std::move(reply), 5);
+  EXPECT_EQ(push.meta.flag, Flag::kPush);
+  EXPECT_EQ(push.meta.sender, 1);
+  EXPECT_EQ(push.meta.recver, 2);
+  EXPECT_EQ(push.meta.version, 5);
+  ASSERT_EQ(push.data.size(), 1);
+  third_party::SArray<int> vals(push.data[0]);
+  ASSERT_EQ(vals.size(), 2);
+  EXPECT_EQ(vals[1], 40);
+}
+
+}  // namespace
+}  // namespace flexps
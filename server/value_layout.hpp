@@ -0,0 +1,54 @@
+#pragma once
+
+#include "server/simd_kernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace flexps {
+
+/*
+ * Values of a table do not have to be scalars: a POD struct such as
+ *
+ *   struct FTRLEntry { float w; float z; float n; };
+ *
+ * is sent as one value per key (the wire format is the raw bytes of the SArray<Val>), so a worker
+ * fetches all the fields of a key with a single Get instead of one table per field.
+ *
+ * To store a struct in struct-of-arrays layout, specialize ValueTraits with the scalar type of its
+ * fields and the number of fields, e.g.
+ *
+ *   template <> struct ValueTraits<FTRLEntry> { using Scalar = float; static const uint32_t kNumFields = 3; };
+ */
+template <typename Val>
+struct ValueTraits {
+  using Scalar = Val;
+  static const uint32_t kNumFields = 1;
+};
+
+// Layouts of VectorStorage: array-of-structs (one Val after another) or struct-of-arrays (one array per field).
+struct AoS {};
+struct SoA {};
+
+// The default combine of an Add, dst += src. A custom combine is any functor with this signature.
+struct AddCombine {
+  template <typename Val>
+  void operator()(Val& dst, const Val& src) const {
+    dst += src;
+  }
+};
+
+// dst[i] = combine(dst[i], src[i]), i in [0, n)
+template <typename Combine, typename Val>
+inline void CombineTo(const Combine& combine, Val* dst, const Val* src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    combine(dst[i], src[i]);
+}
+
+template <typename Val>
+inline void CombineTo(const AddCombine&, Val* dst, const Val* src, size_t n) {
+  AddTo(dst, src, n);
+}
+
+}  // namespace flexps
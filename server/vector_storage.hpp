@@ -1,89 +1,355 @@
 #pragma once
 
+#include "base/key_ranges.hpp"
 #include "base/message.hpp"
 #include "base/third_party/range.h"
 #include "server/abstract_storage.hpp"
+#include "server/apply_pool.hpp"
+#include "server/checkpointer.hpp"
+#include "server/mapped_file.hpp"
+#include "server/simd_kernels.hpp"
+#include "server/value_layout.hpp"
 
 #include "glog/logging.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace flexps {
 
-template <typename Val>
+/*
+ * Val may be a POD struct (see server/value_layout.hpp). Layout selects whether the values are
+ * stored as an array of Val (AoS) or as ValueTraits<Val>::kNumFields arrays of scalars (SoA), and
+ * Combine is how an added value is merged into the stored one (+= by default).
+ *
+ * Checkpoint() writes the blocks of storage_ modified since the last checkpoint in the background
+ * (see server/checkpointer.hpp).
+ *
+ * The blocks of kFlushBlockSize values written to are tracked as well, so that FlushTo() adds only
+ * the blocks a delta was written to since the previous flush.
+ *
+ * With an ApplyPool (see SetApplyPool), requests of at least kMinParallelSize values are split by
+ * key into contiguous parts applied in parallel. The checkpoint blocks are marked dirty by the
+ * server thread first, and the entries of a key repeated in a request stay in one part.
+ */
+template <typename Val, typename Layout = AoS, typename Combine = AddCombine>
 class VectorStorage : public AbstractStorage {
+  using Scalar = typename ValueTraits<Val>::Scalar;
+  static const bool kSoA = std::is_same<Layout, SoA>::value;
+  static const uint32_t kNumArrays = kSoA ? ValueTraits<Val>::kNumFields : 1;
+  // The element type of storage_
+  using Elem = typename std::conditional<kSoA, Scalar, Val>::type;
+  static_assert(kSoA || std::is_same<Layout, AoS>::value, "Layout must be AoS or SoA");
+  static_assert(!kSoA || sizeof(Val) == ValueTraits<Val>::kNumFields * sizeof(Scalar),
+                "SoA needs a Val made of ValueTraits<Val>::kNumFields fields of ValueTraits<Val>::Scalar");
+
  public:
+  // Smaller requests are applied by the server thread alone.
+  static const size_t kMinParallelSize = 1 << 16;
+  // The granularity of FlushTo(), in values
+  static const size_t kFlushBlockSize = 1 << 10;
+
   VectorStorage() = delete;
   /*
    * The storage is in charge of range [range.begin(), range.end()).
    */
-  VectorStorage(third_party::Range range, uint32_t chunk_size = 1) : range_(range), storage_(range.size(), Val()), chunk_size_(chunk_size) {
+  VectorStorage(third_party::Range range, uint32_t chunk_size = 1, Combine combine = Combine())
+      : range_(range),
+        storage_(range.size() * kNumArrays, Elem()),
+        chunk_size_(chunk_size),
+        combine_(combine),
+        touched_((range.size() + kFlushBlockSize - 1) / kFlushBlockSize),
+        checkpointer_(reinterpret_cast<char*>(storage_.data()), storage_.size() * sizeof(Elem)) {
     CHECK_LE(range_.begin(), range_.end());
   }
 
   virtual void SubAdd(const third_party::SArray<Key>& typed_keys, 
       const third_party::SArray<char>& vals) override {
     auto typed_vals = third_party::SArray<Val>(vals);
-    for (size_t index = 0; index < typed_keys.size(); index++) { 
-      CHECK_GE(typed_keys[index], range_.begin());                                                                                                                                                    
-      CHECK_LT(typed_keys[index], range_.end());  
-      storage_[typed_keys[index] - range_.begin()] += typed_vals[index];  
-    }
+    CHECK_EQ(typed_keys.size(), typed_vals.size());
+    CheckKeysInRange(typed_keys, range_);
+    AddKeys(typed_keys, typed_vals.data(), 1);
   }
 
   virtual void SubAddChunk(const third_party::SArray<Key>& typed_keys, 
       const third_party::SArray<char>& vals) override {
     auto typed_vals = third_party::SArray<Val>(vals);
     CHECK_EQ(typed_vals.size()/typed_keys.size(), chunk_size_);
-    for (size_t index = 0; index < typed_keys.size(); index++) {
-      CHECK_GE(typed_keys[index] * chunk_size_, range_.begin());
-      CHECK_LT(typed_keys[index] * chunk_size_, range_.end());
-      for (size_t chunk_index = 0; chunk_index < chunk_size_; chunk_index++)
-        storage_[typed_keys[index] * chunk_size_ - range_.begin() + chunk_index] += typed_vals[index * chunk_size_ + chunk_index];
-    }
+    CheckKeysInRange(typed_keys, range_, chunk_size_);
+    // Consecutive chunk keys are consecutive rows, so a run of chunks is one contiguous span.
+    AddKeys(typed_keys, typed_vals.data(), chunk_size_);
   }
 
 
   virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
-    third_party::SArray<Val> reply_vals(typed_keys.size());
-    for (size_t i = 0; i < typed_keys.size(); i++) {                                                                                                                                      
-      CHECK_GE(typed_keys[i], range_.begin());                                                                                                                                                    
-      CHECK_LT(typed_keys[i], range_.end());
-      reply_vals[i] = storage_[typed_keys[i] - range_.begin()];
-    }  
+    // Every position is overwritten by the runs below, so skip the zero-fill.
+    third_party::SArray<Val> reply_vals(new Val[typed_keys.size()], typed_keys.size(), true);
+    CheckKeysInRange(typed_keys, range_);
+    GetKeys(typed_keys, reply_vals.data(), 1);
     return third_party::SArray<char>(reply_vals);
   }
 
   virtual third_party::SArray<char> SubGetChunk(const third_party::SArray<Key>& typed_keys) override {
-    third_party::SArray<Val> reply_vals(typed_keys.size() * chunk_size_);
-    for (int i = 0; i < typed_keys.size(); ++ i) {
-      CHECK_GE(typed_keys[i] * chunk_size_, range_.begin());
-      CHECK_LT(typed_keys[i] * chunk_size_, range_.end());
-      for (int j = 0; j < chunk_size_; ++ j)
-        reply_vals[i * chunk_size_ + j] = storage_[typed_keys[i] * chunk_size_ - range_.begin() + j];
-    }
+    third_party::SArray<Val> reply_vals(new Val[typed_keys.size() * chunk_size_], typed_keys.size() * chunk_size_, true);
+    CheckKeysInRange(typed_keys, range_, chunk_size_);
+    GetKeys(typed_keys, reply_vals.data(), chunk_size_);
     return third_party::SArray<char>(reply_vals);
   }
 
+  // A run of keys is a contiguous span of storage_, so the keyless requests need no key array at all.
+  virtual void SubAddRange(const third_party::SArray<Key>& ranges, const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    size_t num_keys = NumKeysInRanges(ranges);
+    CHECK_EQ(num_keys, typed_vals.size());
+    CheckKeyRangesInRange(ranges, range_);
+    if (!Parallel(num_keys)) {
+      ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+        AddRun(first - range_.begin(), typed_vals.data() + pos, len);
+      });
+      return;
+    }
+    // The parts split the runs, which must not share keys.
+    bool disjoint = true;
+    Key next = 0;
+    ForEachKeyRange(ranges, [&](Key first, size_t len, size_t pos) {
+      MarkDirty(first - range_.begin(), len);
+      disjoint = disjoint && (pos == 0 || first >= next);
+      next = first + len;
+    });
+    auto add = [&](size_t begin, size_t end) {
+      ForEachKeyRange(ranges, begin, end, [&](Key first, size_t len, size_t pos) {
+        CombineRun(first - range_.begin(), typed_vals.data() + pos, len, Layout());
+      });
+    };
+    if (disjoint)
+      apply_pool_->ParallelFor(num_keys, add);
+    else
+      add(0, num_keys);
+  }
+
+  virtual third_party::SArray<char> SubGetRange(const third_party::SArray<Key>& ranges) override {
+    size_t num_keys = NumKeysInRanges(ranges);
+    third_party::SArray<Val> reply_vals(new Val[num_keys], num_keys, true);
+    CheckKeyRangesInRange(ranges, range_);
+    auto get = [&](size_t begin, size_t end) {
+      ForEachKeyRange(ranges, begin, end, [&](Key first, size_t len, size_t pos) {
+        GetRun(reply_vals.data() + pos, first - range_.begin(), len, Layout());
+      });
+    };
+    if (Parallel(num_keys))
+      apply_pool_->ParallelFor(num_keys, get);
+    else
+      get(0, num_keys);
+    return third_party::SArray<char>(reply_vals);
+  }
 
   virtual void FinishIter() override {}
 
-  int GetBegin() {
+  // With AddCombine, a dense delta of the range.
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return CreateDelta(std::is_same<Combine, AddCombine>());
+  }
+
+  // The runs of blocks written to since the last flush are added to target, and zeroed here.
+  virtual void FlushTo(AbstractStorage* target) override {
+    std::vector<Key> bounds;
+    for (size_t block = 0; block < touched_.size(); ++block) {
+      if (!touched_[block])
+        continue;
+      size_t end = std::min((block + 1) * kFlushBlockSize, static_cast<size_t>(range_.size()));
+      if (!bounds.empty() && bounds.back() + 1 == range_.begin() + block * kFlushBlockSize) {
+        bounds.back() = static_cast<Key>(range_.begin() + end - 1);
+      } else {
+        bounds.push_back(static_cast<Key>(range_.begin() + block * kFlushBlockSize));
+        bounds.push_back(static_cast<Key>(range_.begin() + end - 1));
+      }
+      touched_[block] = 0;
+    }
+    if (bounds.empty())
+      return;
+    third_party::SArray<Key> ranges(bounds);
+    if (!kSoA && ranges.size() == 2)  // one run, added straight from storage_
+      target->SubAddRange(ranges, third_party::SArray<char>(third_party::SArray<Val>(
+                                      reinterpret_cast<Val*>(storage_.data()) + (ranges[0] - range_.begin()),
+                                      ranges[1] - ranges[0] + 1, false)));
+    else
+      target->SubAddRange(ranges, SubGetRange(ranges));
+    ForEachKeyRange(ranges, [&](Key first, size_t len, size_t) {
+      for (uint32_t f = 0; f < kNumArrays; ++f) {
+        auto begin = storage_.begin() + f * range_.size() + (first - range_.begin());
+        std::fill(begin, begin + len, Elem());
+      }
+    });
+  }
+
+  virtual void Checkpoint(const std::string& path) override { checkpointer_.Start(path); }
+  virtual void Restore(const std::string& path) override {
+    checkpointer_.Restore(path);
+    std::fill(touched_.begin(), touched_.end(), 1);
+  }
+
+  // The file holds one Val after another, in AoS layout whatever Layout is.
+  virtual void LoadRange(const std::string& path) override {
+    MappedFile file(path);
+    size_t offset = range_.begin() * sizeof(Val);
+    size_t bytes = range_.size() * sizeof(Val);
+    CHECK_GE(file.size(), offset + bytes) << path << " does not cover the range [" << range_.begin() << ", "
+                                          << range_.end() << ")";
+    file.WillNeed(offset, bytes);
+    checkpointer_.BeforeWrite(0, storage_.size() * sizeof(Elem));
+    std::fill(touched_.begin(), touched_.end(), 1);
+    LoadRun(file.data() + offset, Layout());
+  }
+  // Wait until the running checkpoint is on disk.
+  void WaitCheckpoint() { checkpointer_.Wait(); }
+  // The checkpoint blocks modified since the last checkpoint
+  size_t NumDirtyBlocks() const { return checkpointer_.NumDirtyBlocks(); }
+  // Apply the large requests on apply_pool (not owned), nullptr to apply all on the server thread.
+  void SetApplyPool(ApplyPool* apply_pool) { apply_pool_ = apply_pool; }
+
+  Key GetBegin() {
     return range_.begin();
   }
 
-  int GetEnd() {
+  Key GetEnd() {
     return range_.end();
   }
 
   size_t Size() const {
-    CHECK_EQ(range_.size(), storage_.size());
-    return storage_.size();
+    CHECK_EQ(range_.size() * kNumArrays, storage_.size());
+    return range_.size();
   }
  private:
+  bool Parallel(size_t num_vals) const { return apply_pool_ != nullptr && num_vals >= kMinParallelSize; }
+
+  std::unique_ptr<AbstractStorage> CreateDelta(std::true_type) const {
+    return std::unique_ptr<AbstractStorage>(new VectorStorage<Val>(range_, chunk_size_));
+  }
+  std::unique_ptr<AbstractStorage> CreateDelta(std::false_type) const { return nullptr; }
+
+  // Combine the values of the sorted keys, width values (a chunk) per key.
+  void AddKeys(const third_party::SArray<Key>& keys, const Val* vals, uint32_t width) {
+    size_t n = keys.size();
+    if (!Parallel(n * width)) {
+      ForEachRun(keys.data(), n, [&](size_t begin, size_t len) {
+        AddRun(keys[begin] * width - range_.begin(), vals + begin * width, len * width);
+      });
+      return;
+    }
+    ForEachRun(keys.data(), n, [&](size_t begin, size_t len) {
+      MarkDirty(keys[begin] * width - range_.begin(), len * width);
+    });
+    apply_pool_->ParallelFor(n, [&](size_t begin, size_t end) {
+      AlignToKeys(keys.data(), n, &begin, &end);
+      if (begin >= end)
+        return;
+      ForEachRun(keys.data() + begin, end - begin, [&](size_t b, size_t len) {
+        CombineRun(keys[begin + b] * width - range_.begin(), vals + (begin + b) * width, len * width, Layout());
+      });
+    });
+  }
+
+  // Copy the values of the sorted keys to dst, width values (a chunk) per key.
+  void GetKeys(const third_party::SArray<Key>& keys, Val* dst, uint32_t width) {
+    auto get = [&](size_t begin, size_t end) {
+      ForEachRun(keys.data() + begin, end - begin, [&](size_t b, size_t len) {
+        GetRun(dst + (begin + b) * width, keys[begin + b] * width - range_.begin(), len * width, Layout());
+      });
+    };
+    if (Parallel(keys.size() * width))
+      apply_pool_->ParallelFor(keys.size(), get);
+    else
+      get(0, keys.size());
+  }
+
+  // Move the bounds of a part of sorted keys forward so that the entries of a key are in one part.
+  static void AlignToKeys(const Key* keys, size_t n, size_t* begin, size_t* end) {
+    while (*begin > 0 && *begin < n && keys[*begin] == keys[*begin - 1])
+      *begin += 1;
+    while (*end < n && keys[*end] == keys[*end - 1])
+      *end += 1;
+  }
+
+  // Combine vals[0, len) into the values at [offset, offset + len) of the range.
+  void AddRun(size_t offset, const Val* vals, size_t len) {
+    MarkDirty(offset, len);
+    CombineRun(offset, vals, len, Layout());
+  }
+
+  // Tell the checkpointer and FlushTo() that the values at [offset, offset + len) are about to change.
+  void MarkDirty(size_t offset, size_t len) {
+    if (len == 0)
+      return;
+    for (size_t block = offset / kFlushBlockSize; block <= (offset + len - 1) / kFlushBlockSize; ++block)
+      touched_[block] = 1;
+    for (uint32_t f = 0; f < kNumArrays; ++f) {
+      size_t begin = f * range_.size() + offset;
+      checkpointer_.BeforeWrite(begin * sizeof(Elem), (begin + len) * sizeof(Elem));
+    }
+  }
+
+  void CombineRun(size_t offset, const Val* vals, size_t len, AoS) {
+    CombineTo(combine_, storage_.data() + offset, vals, len);
+  }
+
+  void CombineRun(size_t offset, const Val* vals, size_t len, SoA) {
+    for (size_t i = 0; i < len; ++i) {
+      Val val = Load(offset + i);
+      combine_(val, vals[i]);
+      Store(offset + i, val);
+    }
+  }
+
+  // Overwrite the values of the range with the raw values at src.
+  void LoadRun(const char* src, AoS) {
+    if (!storage_.empty())
+      memcpy(storage_.data(), src, storage_.size() * sizeof(Elem));
+  }
+
+  void LoadRun(const char* src, SoA) {
+    Val val;
+    for (size_t i = 0; i < range_.size(); ++i) {
+      memcpy(&val, src + i * sizeof(Val), sizeof(Val));
+      Store(i, val);
+    }
+  }
+
+  // Copy the values at [offset, offset + len) of the range to dst.
+  void GetRun(Val* dst, size_t offset, size_t len, AoS) const { CopyTo(dst, storage_.data() + offset, len); }
+
+  void GetRun(Val* dst, size_t offset, size_t len, SoA) const {
+    for (size_t i = 0; i < len; ++i)
+      dst[i] = Load(offset + i);
+  }
+
+  // SoA only, field f of the value at offset is storage_[f * range_.size() + offset].
+  Val Load(size_t offset) const {
+    Val val;
+    Scalar* fields = reinterpret_cast<Scalar*>(&val);
+    for (uint32_t f = 0; f < kNumArrays; ++f)
+      fields[f] = storage_[f * range_.size() + offset];
+    return val;
+  }
+
+  void Store(size_t offset, const Val& val) {
+    const Scalar* fields = reinterpret_cast<const Scalar*>(&val);
+    for (uint32_t f = 0; f < kNumArrays; ++f)
+      storage_[f * range_.size() + offset] = fields[f];
+  }
+
   third_party::Range range_;
-  std::vector<Val> storage_;
+  std::vector<Elem> storage_;
   uint32_t chunk_size_;
+  Combine combine_;
+  // The blocks of kFlushBlockSize values written to since the last FlushTo()
+  std::vector<uint8_t> touched_;
+  // Declared after storage_, which it points into
+  Checkpointer checkpointer_;
+  ApplyPool* apply_pool_ = nullptr;  // not owned
 };
 
 }  // namespace flexps
@@ -3,9 +3,63 @@
 
 #include "server/vector_storage.hpp"
 
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
 namespace flexps {
+
+struct FTRLEntry {
+  float w;
+  float z;
+  float n;
+};
+
+template <>
+struct ValueTraits<FTRLEntry> {
+  using Scalar = float;
+  static const uint32_t kNumFields = 3;
+};
+
 namespace {
 
+// Keep the latest w, accumulate z and n.
+struct FTRLCombine {
+  void operator()(FTRLEntry& dst, const FTRLEntry& src) const {
+    dst.w = src.w;
+    dst.z += src.z;
+    dst.n += src.n;
+  }
+};
+
+template <typename Storage>
+void CheckStructValues(Storage* s) {
+  third_party::SArray<Key> keys({11, 12, 13, 17});
+  third_party::SArray<FTRLEntry> vals(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    vals[i] = {float(i), 1.0f, float(i) * 2};
+  s->SubAdd(keys, third_party::SArray<char>(vals));
+  for (size_t i = 0; i < keys.size(); ++i)
+    vals[i].w = 10 + i;
+  s->SubAdd(keys, third_party::SArray<char>(vals));
+
+  third_party::SArray<FTRLEntry> ret(s->SubGet(third_party::SArray<Key>({11, 12, 13, 16, 17})));
+  ASSERT_EQ(ret.size(), 5);
+  for (size_t i = 0, j = 0; i < ret.size(); ++i) {
+    if (i == 3) {
+      EXPECT_EQ(ret[i].w, 0);
+      EXPECT_EQ(ret[i].z, 0);
+      EXPECT_EQ(ret[i].n, 0);
+      continue;
+    }
+    EXPECT_EQ(ret[i].w, 10 + j);
+    EXPECT_EQ(ret[i].z, 2);
+    EXPECT_EQ(ret[i].n, j * 4);
+    j += 1;
+  }
+}
+
 class TestVectorStorage : public testing::Test {
  public:
   TestVectorStorage() {}
@@ -103,7 +157,248 @@ TEST_F(TestVectorStorage, SubAddChunkSubGetChunk) {
   }
 }
 
+TEST_F(TestVectorStorage, SubAddSubGetRuns) {
+  VectorStorage<float> s({0, 100});
+
+  // Two runs of consecutive keys longer than a SIMD register plus scattered keys.
+  std::vector<Key> keys;
+  for (Key k = 3; k < 40; ++k)
+    keys.push_back(k);
+  keys.push_back(45);
+  keys.push_back(47);
+  for (Key k = 50; k < 71; ++k)
+    keys.push_back(k);
+  third_party::SArray<Key> s_keys(keys);
+  third_party::SArray<float> s_vals(s_keys.size());
+  for (int i = 0; i < s_vals.size(); ++ i) {
+    s_vals[i] = i + 0.5;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  ASSERT_EQ(ret.size(), s_keys.size());
+  for (int i = 0; i < s_keys.size(); ++ i) {
+    EXPECT_EQ(ret[i], 2 * s_vals[i]);
+  }
+  third_party::SArray<Key> untouched_keys({0, 44, 46, 99});
+  ret = third_party::SArray<float>(s.SubGet(untouched_keys));
+  for (int i = 0; i < untouched_keys.size(); ++ i) {
+    EXPECT_EQ(ret[i], 0);
+  }
+}
+
+TEST_F(TestVectorStorage, SubAddChunkSubGetChunkRuns) {
+  VectorStorage<double> s({0, 100}, 3);
+  third_party::SArray<Key> s_keys({1, 2, 3, 7, 8});
+  third_party::SArray<double> s_vals(s_keys.size() * 3);
+  for (int i = 0; i < s_vals.size(); i++) {
+    s_vals[i] = i;
+  }
+  s.SubAddChunk(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<double> ret = third_party::SArray<double>(s.SubGetChunk(s_keys));
+  ASSERT_EQ(ret.size(), s_vals.size());
+  for (int i = 0; i < s_vals.size(); ++ i) {
+    EXPECT_EQ(ret[i], s_vals[i]);
+  }
+  // Element 22 is column 1 of chunk 7
+  third_party::SArray<Key> elem_keys({22});
+  ret = third_party::SArray<double>(s.SubGet(elem_keys));
+  EXPECT_EQ(ret[0], s_vals[10]);
+}
+
+TEST_F(TestVectorStorage, StructAoS) {
+  VectorStorage<FTRLEntry, AoS, FTRLCombine> s({10, 20});
+  CheckStructValues(&s);
+}
+
+TEST_F(TestVectorStorage, StructSoA) {
+  VectorStorage<FTRLEntry, SoA, FTRLCombine> s({10, 20});
+  EXPECT_EQ(s.Size(), 10);
+  CheckStructValues(&s);
+}
+
+TEST_F(TestVectorStorage, StructSoAChunk) {
+  VectorStorage<FTRLEntry, SoA, FTRLCombine> s({0, 20}, 5);
+  third_party::SArray<Key> keys({1, 3});
+  third_party::SArray<FTRLEntry> vals(10);
+  for (size_t i = 0; i < vals.size(); ++i)
+    vals[i] = {float(i), float(i), float(i)};
+  s.SubAddChunk(keys, third_party::SArray<char>(vals));
+  s.SubAddChunk(keys, third_party::SArray<char>(vals));
+  third_party::SArray<FTRLEntry> ret(s.SubGetChunk(keys));
+  ASSERT_EQ(ret.size(), 10);
+  for (size_t i = 0; i < ret.size(); ++i) {
+    EXPECT_EQ(ret[i].w, i);
+    EXPECT_EQ(ret[i].z, 2 * i);
+  }
+  // Element keys 5..9 are the elements of chunk 1.
+  third_party::SArray<FTRLEntry> elems(s.SubGet(third_party::SArray<Key>({5, 9})));
+  EXPECT_EQ(elems[0].n, 0);
+  EXPECT_EQ(elems[1].n, 8);
+}
+
+TEST_F(TestVectorStorage, ScalarSoA) {
+  VectorStorage<float, SoA> s({10, 20});
+  third_party::SArray<Key> keys({12, 13});
+  third_party::SArray<float> vals({0.5, 1.5});
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  EXPECT_EQ(ret[0], 1.0);
+  EXPECT_EQ(ret[1], 3.0);
+}
+
+TEST_F(TestVectorStorage, LoadRange) {
+  // Values of keys [0, 30): w = key, z = 2 * key, n = 1
+  std::string path = "/tmp/flexps_vector_storage_test_" + std::to_string(getpid());
+  std::vector<FTRLEntry> values(30);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = {float(i), float(2 * i), 1.0f};
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(fwrite(values.data(), sizeof(FTRLEntry), values.size(), file), values.size());
+  fclose(file);
+
+  VectorStorage<FTRLEntry, AoS, FTRLCombine> aos({10, 20});
+  VectorStorage<FTRLEntry, SoA, FTRLCombine> soa({10, 20});
+  aos.LoadRange(path);
+  soa.LoadRange(path);
+  third_party::SArray<Key> keys({10, 15, 19});
+  third_party::SArray<FTRLEntry> aos_ret(aos.SubGet(keys));
+  third_party::SArray<FTRLEntry> soa_ret(soa.SubGet(keys));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(aos_ret[i].w, keys[i]);
+    EXPECT_EQ(aos_ret[i].z, 2 * keys[i]);
+    EXPECT_EQ(aos_ret[i].n, 1);
+    EXPECT_EQ(soa_ret[i].w, keys[i]);
+    EXPECT_EQ(soa_ret[i].z, 2 * keys[i]);
+    EXPECT_EQ(soa_ret[i].n, 1);
+  }
+  remove(path.c_str());
+}
+
+TEST_F(TestVectorStorage, AddGetRange) {
+  VectorStorage<float> s({10, 20});
+
+  // Keys 12-15 and 18, as [first, last] runs.
+  third_party::SArray<Key> ranges({12, 15, 18, 18});
+  third_party::SArray<float> s_vals({0.5, 1.5, 2.5, 3.5, 4.5});
+  Message m;
+  m.meta.flag = Flag::kAddRange;
+  m.AddData(ranges);
+  m.AddData(s_vals);
+  s.Add(m);
+  s.Add(m);
+
+  Message m2;
+  m2.meta.flag = Flag::kGetRange;
+  m2.AddData(ranges);
+  Message rep = s.Get(m2);
+  EXPECT_EQ(rep.meta.flag, Flag::kGetRangeReply);
+  ASSERT_EQ(rep.data.size(), 2);
+  auto rep_ranges = third_party::SArray<Key>(rep.data[0]);
+  auto rep_vals = third_party::SArray<float>(rep.data[1]);
+  ASSERT_EQ(rep_ranges.size(), ranges.size());
+  ASSERT_EQ(rep_vals.size(), s_vals.size());
+  for (int i = 0; i < s_vals.size(); ++ i) {
+    EXPECT_EQ(rep_vals[i], 2 * s_vals[i]);
+  }
+
+  // The keyed path reads the same values.
+  third_party::SArray<Key> s_keys({12, 15, 16, 18});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  EXPECT_EQ(ret[0], 1);
+  EXPECT_EQ(ret[1], 7);
+  EXPECT_EQ(ret[2], 0);
+  EXPECT_EQ(ret[3], 9);
+}
+
+
+TEST_F(TestVectorStorage, ParallelApply) {
+  const size_t n = VectorStorage<float>::kMinParallelSize * 2;
+  ApplyPool pool(3);
+  VectorStorage<float> s({0, n + 1000});
+  VectorStorage<float> serial({0, n + 1000});
+  s.SetApplyPool(&pool);
+
+  // Sorted keys with gaps and duplicates, large enough to be split.
+  third_party::SArray<Key> keys;
+  third_party::SArray<float> vals;
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back(i + i / 1000);
+    vals.push_back(i % 7);
+    if (i % 5 == 0) {
+      keys.push_back(i + i / 1000);
+      vals.push_back(1);
+    }
+  }
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  serial.SubAdd(keys, third_party::SArray<char>(vals));
+  third_party::SArray<float> ret(s.SubGet(keys));
+  third_party::SArray<float> expected(serial.SubGet(keys));
+  ASSERT_EQ(ret.size(), expected.size());
+  for (size_t i = 0; i < ret.size(); ++i)
+    ASSERT_EQ(ret[i], expected[i]) << i;
+
+  // Keyless runs
+  third_party::SArray<Key> ranges({0, n / 2 - 1, n / 2 + 10, n + 9});
+  third_party::SArray<float> range_vals(n, 2);
+  s.SubAddRange(ranges, third_party::SArray<char>(range_vals));
+  serial.SubAddRange(ranges, third_party::SArray<char>(range_vals));
+  ret = third_party::SArray<float>(s.SubGetRange(ranges));
+  expected = third_party::SArray<float>(serial.SubGetRange(ranges));
+  ASSERT_EQ(ret.size(), n);
+  for (size_t i = 0; i < ret.size(); ++i)
+    ASSERT_EQ(ret[i], expected[i]) << i;
+}
+
+TEST_F(TestVectorStorage, ParallelApplyChunkSoA) {
+  const uint32_t chunk_size = 3;
+  const size_t num_chunks = VectorStorage<FTRLEntry>::kMinParallelSize;
+  ApplyPool pool(2);
+  VectorStorage<FTRLEntry, SoA, FTRLCombine> s({0, num_chunks * chunk_size}, chunk_size);
+  VectorStorage<FTRLEntry, SoA, FTRLCombine> serial({0, num_chunks * chunk_size}, chunk_size);
+  s.SetApplyPool(&pool);
+
+  third_party::SArray<Key> keys;
+  for (size_t i = 0; i < num_chunks; i += 2)
+    keys.push_back(i);
+  third_party::SArray<FTRLEntry> vals(keys.size() * chunk_size);
+  for (size_t i = 0; i < vals.size(); ++i)
+    vals[i] = {float(i), 1.0f, float(i % 11)};
+  for (int k = 0; k < 2; ++k) {
+    s.SubAddChunk(keys, third_party::SArray<char>(vals));
+    serial.SubAddChunk(keys, third_party::SArray<char>(vals));
+  }
+  third_party::SArray<FTRLEntry> ret(s.SubGetChunk(keys));
+  third_party::SArray<FTRLEntry> expected(serial.SubGetChunk(keys));
+  ASSERT_EQ(ret.size(), expected.size());
+  for (size_t i = 0; i < ret.size(); ++i) {
+    ASSERT_EQ(ret[i].w, expected[i].w);
+    ASSERT_EQ(ret[i].z, expected[i].z);
+    ASSERT_EQ(ret[i].n, expected[i].n);
+  }
+}
+
+TEST_F(TestVectorStorage, FlushTo) {
+  EXPECT_TRUE((VectorStorage<FTRLEntry, SoA, FTRLCombine>({0, 4}).CreateDelta() == nullptr));
+  VectorStorage<float, SoA> target({2, 6});
+  auto delta = target.CreateDelta();
+  ASSERT_TRUE(delta != nullptr);
+  third_party::SArray<Key> keys({2, 5});
+  third_party::SArray<float> vals({0.5, 2.0});
+  delta->SubAdd(keys, third_party::SArray<char>(vals));
+  delta->SubAdd(keys, third_party::SArray<char>(vals));
+  target.SubAdd(keys, third_party::SArray<char>(vals));
+
+  delta->FlushTo(&target);
+  third_party::SArray<float> ret(target.SubGet(keys));
+  EXPECT_EQ(ret[0], 1.5);
+  EXPECT_EQ(ret[1], 6.0);
+  ret = third_party::SArray<float>(delta->SubGet(keys));
+  EXPECT_EQ(ret[0], 0);
+  EXPECT_EQ(ret[1], 0);
+}
 
 }  // namespace
 }  // namespace flexps
-
@@ -22,6 +22,9 @@ class AbstractPartitionManager {
   size_t GetNumServers() const { return server_thread_ids_.size(); }
   const std::vector<uint32_t>& GetServerThreadIds() const { return server_thread_ids_; }
 
+  // The width in bytes of the keys of this table on the wire, see Meta::key_width.
+  virtual uint8_t GetKeyWidth() const { return sizeof(Key); }
+
   // slice key-value pairs into <server_id, key_value_partition> pairs
   virtual SlicedKVs Slice(const KVPairs<char>& kvs) const = 0;
   virtual SlicedKVs SliceChunk(const KVPairs<char>& kvs) const = 0;
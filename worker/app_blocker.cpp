@@ -41,6 +41,11 @@ void AppBlocker::WaitRequest(uint32_t app_thread_id, uint32_t model_id) {
   });
 }
 void AppBlocker::AddResponse(uint32_t app_thread_id, uint32_t model_id, Message& msg) {
+  // A push does not answer a request, it only goes to the recv handle.
+  if (msg.meta.flag == Flag::kPush) {
+    recv_handle_[app_thread_id][model_id](msg);
+    return;
+  }
   bool recv_finish = false;
   {
     std::lock_guard<std::mutex> lk(mu_);
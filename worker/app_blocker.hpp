@@ -20,6 +20,7 @@ namespace flexps {
  *
  * Should register handle before use.
  * Should call NewRequest before sending out the request.
+ * A kPush (see KVClientTable::Subscribe) is passed to the recv handle without counting as a response.
  */
 class AppBlocker : public AbstractCallbackRunner, public AbstractReceiver {
  public:
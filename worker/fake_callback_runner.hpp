@@ -34,6 +34,10 @@ class FakeCallbackRunner : public AbstractCallbackRunner {
   }
   void AddResponse(Message m) {
     EXPECT_NE(recv_handle_, nullptr);
+    if (m.meta.flag == Flag::kPush) {
+      recv_handle_(m);
+      return;
+    }
     bool recv_finish = false;
     {
       std::lock_guard<std::mutex> lk(mu_);
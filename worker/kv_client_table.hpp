@@ -4,6 +4,7 @@
 
 #include "worker/abstract_callback_runner.hpp"
 #include "worker/abstract_partition_manager.hpp"
+#include "worker/subscribed_values.hpp"
 
 namespace flexps {
 
@@ -15,12 +16,17 @@ namespace flexps {
  * 2. The Get() call will always wait for the result
  * If we add more background threads later, we need to lock this.
  *
+ * Under SSP, a table whose Gets read the same keys every iteration can Subscribe() to them once.
+ * The servers then push their values whenever the min clock advances, and a Get of subscribed keys
+ * is served from the pushed values as soon as they are within the staleness bound of the clock of
+ * the table, without a request to the servers.
  */
 template <typename Val>
 class KVClientTable {
  public:
   KVClientTable(uint32_t app_thread_id, uint32_t model_id, ThreadsafeQueue<Message>* const send_queue,
                 const AbstractPartitionManager* const partition_manager, AbstractCallbackRunner* const callback_runner);
+  ~KVClientTable();
   KVClientTable(const KVClientTable&) = delete;
   KVClientTable& operator=(const KVClientTable&) = delete;
   KVClientTable(KVClientTable&& other) = delete;
@@ -33,7 +39,13 @@ class KVClientTable {
   void Add(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& vals);
   void Get(const third_party::SArray<Key>& keys, third_party::SArray<Val>* vals);
 
+  // Subscribe to the sorted keys, once.
+  void Subscribe(const std::vector<Key>& keys);
+  void Subscribe(const third_party::SArray<Key>& keys);
+
   void Clock();
+  // See KVTableBox::SetClockAggregator.
+  void SetClockAggregator(uint32_t aggregator_id) { kv_table_box_.SetClockAggregator(aggregator_id); }
 
   using SlicedKVs = AbstractPartitionManager::SlicedKVs;
 
@@ -46,6 +58,8 @@ class KVClientTable {
 
   // Most of the operations are delegated to KVTableBox
   KVTableBox<Val> kv_table_box_;
+
+  SubscribedValues<Val> subscribed_;
 };
 
 template <typename Val>
@@ -53,8 +67,21 @@ KVClientTable<Val>::KVClientTable(uint32_t app_thread_id, uint32_t model_id, Thr
                                   const AbstractPartitionManager* const partition_manager,
                                   AbstractCallbackRunner* const callback_runner)
     : kv_table_box_(app_thread_id, model_id, send_queue, partition_manager), callback_runner_(callback_runner) {
-  callback_runner_->RegisterRecvHandle(kv_table_box_.app_thread_id_, kv_table_box_.model_id_,
-                                       [&](Message& msg) { kv_table_box_.HandleMsg(msg); });
+  callback_runner_->RegisterRecvHandle(kv_table_box_.app_thread_id_, kv_table_box_.model_id_, [&](Message& msg) {
+    if (msg.meta.flag == Flag::kPush)
+      subscribed_.Push(msg);
+    else
+      kv_table_box_.HandleMsg(msg);
+  });
+}
+
+// The subscription ends with the table, the pushes still on the way are dropped.
+template <typename Val>
+KVClientTable<Val>::~KVClientTable() {
+  if (subscribed_.Empty())
+    return;
+  callback_runner_->RegisterRecvHandle(kv_table_box_.app_thread_id_, kv_table_box_.model_id_, [](Message&) {});
+  kv_table_box_.Unsubscribe();
 }
 
 // vector version Add
@@ -85,6 +112,10 @@ void KVClientTable<Val>::Get(const third_party::SArray<Key>& keys, third_party::
 template <typename Val>
 template <typename C>
 void KVClientTable<Val>::Get_(const third_party::SArray<Key>& keys, C* vals) {
+  if (subscribed_.Covers(keys)) {
+    subscribed_.Read(keys, kv_table_box_.GetClock(), vals);
+    return;
+  }
   KVPairs<char> kvs;
   kvs.keys = keys;
   // 1. slice
@@ -101,6 +132,21 @@ void KVClientTable<Val>::Get_(const third_party::SArray<Key>& keys, C* vals) {
   callback_runner_->WaitRequest(kv_table_box_.app_thread_id_, kv_table_box_.model_id_);
 }
 
+template <typename Val>
+void KVClientTable<Val>::Subscribe(const std::vector<Key>& keys) {
+  Subscribe(third_party::SArray<Key>(keys));
+}
+
+// The subscription is sent without waiting, the first Get waits for the first pushes.
+template <typename Val>
+void KVClientTable<Val>::Subscribe(const third_party::SArray<Key>& keys) {
+  KVPairs<char> kvs;
+  kvs.keys = keys;
+  SlicedKVs sliced = kv_table_box_.Slice(kvs);
+  subscribed_.Init(sliced);
+  kv_table_box_.Subscribe(sliced);
+}
+
 template <typename Val>
 void KVClientTable<Val>::Clock() {
   kv_table_box_.Clock();
@@ -5,6 +5,7 @@
 #include "worker/fake_callback_runner.hpp"
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -247,5 +248,139 @@ TEST_F(TestKVClientTable, Clock) {
   EXPECT_EQ(m2.meta.flag, Flag::kClock);
 }
 
+TEST_F(TestKVClientTable, ClockAggregator) {
+  ThreadsafeQueue<Message> queue;
+  SimpleRangePartitionManager manager({{2, 4}, {4, 7}}, {0, 1});
+  FakeCallbackRunner callback_runner(kTestAppThreadId, kTestModelId);
+  KVClientTable<float> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+  table.SetClockAggregator(20);
+  table.Clock();  // -> the aggregator only
+  ASSERT_EQ(queue.Size(), 1);
+  Message m1;
+  queue.WaitAndPop(&m1);
+  EXPECT_EQ(m1.meta.sender, kTestAppThreadId);
+  EXPECT_EQ(m1.meta.recver, 20);
+  EXPECT_EQ(m1.meta.model_id, kTestModelId);
+  EXPECT_EQ(m1.meta.flag, Flag::kClock);
+
+  // The Adds carry the clock of the table
+  table.Add(std::vector<Key>{3}, std::vector<float>{0.1});
+  Message m2;
+  queue.WaitAndPop(&m2);
+  EXPECT_EQ(m2.meta.flag, Flag::kAdd);
+  EXPECT_EQ(m2.meta.version, 1);
+}
+
+TEST_F(TestKVClientTable, DenseAddGet) {
+  ThreadsafeQueue<Message> queue;
+  SimpleRangePartitionManager manager({{0, 10}, {10, 20}}, {0, 1});
+  FakeCallbackRunner callback_runner(kTestAppThreadId, kTestModelId);
+  std::vector<Key> keys;
+  for (Key k = 2; k < 8; ++ k)
+    keys.push_back(k);
+  for (Key k = 12; k < 20; ++ k)
+    keys.push_back(k);
+  std::thread th([&queue, &manager, &callback_runner, &keys]() {
+    KVClientTable<float> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+    table.Add(keys, std::vector<float>(keys.size(), 0.5));
+    std::vector<float> vals;
+    table.Get(keys, &vals);
+    ASSERT_EQ(vals.size(), keys.size());
+    for (int i = 0; i < keys.size(); ++ i) {
+      EXPECT_EQ(vals[i], keys[i] * 0.5f);
+    }
+  });
+  // The slices are single runs, the requests carry [first, last] instead of the keys.
+  std::vector<std::vector<Key>> expected_ranges{{2, 7}, {12, 19}};
+  Message m;
+  for (int i = 0; i < 2; ++ i) {
+    queue.WaitAndPop(&m);
+    EXPECT_EQ(m.meta.flag, Flag::kAddRange);
+    ASSERT_EQ(m.data.size(), 2);
+    third_party::SArray<Key> ranges(m.data[0]);
+    EXPECT_EQ(std::vector<Key>(ranges.begin(), ranges.end()), expected_ranges[i]);
+    EXPECT_EQ(third_party::SArray<float>(m.data[1]).size(), NumKeysInRanges(ranges));
+  }
+  for (int i = 0; i < 2; ++ i) {
+    queue.WaitAndPop(&m);
+    EXPECT_EQ(m.meta.flag, Flag::kGetRange);
+    ASSERT_EQ(m.data.size(), 1);
+    third_party::SArray<Key> ranges(m.data[0]);
+    EXPECT_EQ(std::vector<Key>(ranges.begin(), ranges.end()), expected_ranges[i]);
+  }
+
+  // Replies in reverse order
+  for (int i = 1; i >= 0; -- i) {
+    Message r;
+    r.meta.flag = Flag::kGetRangeReply;
+    third_party::SArray<Key> ranges(expected_ranges[i]);
+    third_party::SArray<float> vals;
+    for (Key k = expected_ranges[i][0]; k <= expected_ranges[i][1]; ++ k)
+      vals.push_back(k * 0.5f);
+    r.AddData(ranges);
+    r.AddData(vals);
+    callback_runner.AddResponse(r);
+  }
+  th.join();
+}
+
+TEST_F(TestKVClientTable, Subscribe) {
+  ThreadsafeQueue<Message> queue;
+  SimpleRangePartitionManager manager({{2, 4}, {4, 7}}, {0, 1});
+  FakeCallbackRunner callback_runner(kTestAppThreadId, kTestModelId);
+  std::unique_ptr<KVClientTable<float>> table(
+      new KVClientTable<float>(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner));
+  std::thread th([&table]() {
+    table->Subscribe(std::vector<Key>{3, 4, 5, 6});
+    std::vector<float> vals;
+    table->Get(std::vector<Key>{4, 6}, &vals);
+    EXPECT_EQ(vals, std::vector<float>({0.4, 0.3}));
+    table->Clock();
+    // Waits for the pushes of clock 1.
+    table->Get(std::vector<Key>{3, 4, 5, 6}, &vals);
+    EXPECT_EQ(vals, std::vector<float>({1.1, 1.4, 1.2, 1.3}));
+  });
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  EXPECT_EQ(m1.meta.flag, Flag::kSubscribe);
+  EXPECT_EQ(m1.meta.recver, 0);
+  ASSERT_EQ(m1.data.size(), 1);
+  EXPECT_EQ(third_party::SArray<Key>(m1.data[0]).size(), 1);
+  EXPECT_EQ(m2.meta.flag, Flag::kSubscribe);
+  EXPECT_EQ(m2.meta.recver, 1);
+  ASSERT_EQ(m2.data.size(), 1);
+  EXPECT_EQ(third_party::SArray<Key>(m2.data[0]).size(), 3);
+
+  auto push = [&callback_runner](int server, uint32_t version, const third_party::SArray<float>& vals) {
+    Message p;
+    p.meta.flag = Flag::kPush;
+    p.meta.sender = server;
+    p.meta.version = version;
+    p.AddData(vals);
+    callback_runner.AddResponse(p);
+  };
+  push(0, 0, {0.1});
+  push(1, 0, {0.4, 0.2, 0.3});
+  // The Gets of the subscribed keys send no request, only the clocks are sent.
+  Message c1, c2;
+  queue.WaitAndPop(&c1);
+  queue.WaitAndPop(&c2);
+  EXPECT_EQ(c1.meta.flag, Flag::kClock);
+  EXPECT_EQ(c2.meta.flag, Flag::kClock);
+  push(1, 1, {1.4, 1.2, 1.3});
+  push(0, 1, {1.1});
+  th.join();
+  EXPECT_EQ(queue.Size(), 0);
+
+  // The table unsubscribes when destroyed and drops the late pushes.
+  table.reset();
+  ASSERT_EQ(queue.Size(), 2);
+  queue.WaitAndPop(&m1);
+  EXPECT_EQ(m1.meta.flag, Flag::kSubscribe);
+  EXPECT_EQ(m1.data.size(), 0);
+  push(0, 2, {2.1});
+}
+
 }  // namespace
 }  // namespace flexps
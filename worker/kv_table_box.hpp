@@ -1,5 +1,6 @@
 #pragma once
 
+#include "base/key_ranges.hpp"
 #include "base/magic.hpp"
 #include "base/message.hpp"
 #include "base/third_party/range.h"
@@ -18,6 +19,14 @@ namespace flexps {
 
 /*
  * KVTableBox contains serveral operations shared by different KVTable.
+ *
+ * A slice of an Add/Get whose keys are mostly runs of consecutive keys, such as a full-model pull,
+ * is sent as kAddRange/kGetRange with the runs instead of the keys (see base/key_ranges.hpp), and
+ * the kGetRangeReply has no key array either.
+ *
+ * The Adds and Gets carry the number of Clock() calls as their version. With node clocks (see
+ * NodeClockAggregator), a Clock is one kClock to the aggregator of the node instead of one to every
+ * server.
  */
 template <typename Val>
 class KVTableBox {
@@ -32,7 +41,13 @@ class KVTableBox {
   using SlicedKVs = AbstractPartitionManager::SlicedKVs;
 
   void Clock();
+  // The number of Clock() calls so far
+  uint32_t GetClock() const { return clock_; }
+  // Send the Clocks to the aggregator thread aggregator_id from now on.
+  void SetClockAggregator(uint32_t aggregator_id) { clock_aggregator_id_ = aggregator_id; }
   void Send(const SlicedKVs& sliced, bool is_add);
+  void Subscribe(const SlicedKVs& sliced);
+  void Unsubscribe();
   void SendChunk(const SlicedKVs& sliced, bool is_add);
   void Add(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& vals);
   void AddChunk(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& vals);
@@ -48,13 +63,30 @@ class KVTableBox {
   uint32_t app_thread_id_;
   uint32_t model_id_;
 
+  // A slice is sent as key ranges when its runs are this long on average, the ranges then take at
+  // most half the bytes of the keys.
+  static const size_t kMinRunLength = 4;
+
  private:
+  // The reply of one server to a Get, covering num_keys keys of the request from first to last.
+  struct RecvSlice {
+    Key first;
+    Key last;
+    size_t num_keys;
+    third_party::SArray<Val> vals;
+  };
+
   // Not owned.
   ThreadsafeQueue<Message>* const send_queue_;
   // Not owned.
   const AbstractPartitionManager* const partition_manager_;
 
-  std::vector<KVPairs<Val>> recv_kvs_;
+  std::vector<RecvSlice> recv_kvs_;
+
+  // The number of Clock() calls
+  uint32_t clock_ = 0;
+  static const uint32_t kNoAggregator = -1;
+  uint32_t clock_aggregator_id_ = kNoAggregator;
 };
 
 template <typename Val>
@@ -102,9 +134,16 @@ void KVTableBox<Val>::Send(const SlicedKVs& sliced, bool is_add) {
     msg.meta.recver = sliced[i].first;
     msg.meta.model_id = model_id_;
     msg.meta.flag = is_add ? Flag::kAdd : Flag::kGet;
+    msg.meta.version = clock_;
+    msg.meta.key_width = partition_manager_->GetKeyWidth();
     const auto& kvs = sliced[i].second;
     if (kvs.keys.size()) {
-      msg.AddData(kvs.keys);
+      if (IsDense(kvs.keys, kMinRunLength)) {
+        msg.meta.flag = is_add ? Flag::kAddRange : Flag::kGetRange;
+        msg.AddData(ToKeyRanges(kvs.keys));
+      } else {
+        msg.AddData(kvs.keys);
+      }
       if (is_add) {
         msg.AddData(kvs.vals);
       }
@@ -113,6 +152,37 @@ void KVTableBox<Val>::Send(const SlicedKVs& sliced, bool is_add) {
   }
 }
 
+template <typename Val>
+void KVTableBox<Val>::Subscribe(const SlicedKVs& sliced) {
+  CHECK_NOTNULL(partition_manager_);
+  for (size_t i = 0; i < sliced.size(); ++i) {
+    if (sliced[i].second.keys.empty())
+      continue;
+    Message msg;
+    msg.meta.sender = app_thread_id_;
+    msg.meta.recver = sliced[i].first;
+    msg.meta.model_id = model_id_;
+    msg.meta.flag = Flag::kSubscribe;
+    msg.meta.key_width = partition_manager_->GetKeyWidth();
+    msg.AddData(sliced[i].second.keys);
+    send_queue_->Push(std::move(msg));
+  }
+}
+
+// A kSubscribe without keys to every server.
+template <typename Val>
+void KVTableBox<Val>::Unsubscribe() {
+  CHECK_NOTNULL(partition_manager_);
+  for (uint32_t server_id : partition_manager_->GetServerThreadIds()) {
+    Message msg;
+    msg.meta.sender = app_thread_id_;
+    msg.meta.recver = server_id;
+    msg.meta.model_id = model_id_;
+    msg.meta.flag = Flag::kSubscribe;
+    send_queue_->Push(std::move(msg));
+  }
+}
+
 template <typename Val>
 typename KVTableBox<Val>::SlicedKVs KVTableBox<Val>::SliceChunk(const KVPairs<char>& send) {
   CHECK_NOTNULL(partition_manager_);
@@ -128,6 +198,8 @@ void KVTableBox<Val>::SendChunk(const SlicedKVs& sliced, bool is_add) {
     msg.meta.recver = sliced[i].first;
     msg.meta.model_id = model_id_;
     msg.meta.flag = is_add ? Flag::kAddChunk : Flag::kGetChunk;
+    msg.meta.version = clock_;
+    msg.meta.key_width = partition_manager_->GetKeyWidth();
     const auto& kvs = sliced[i].second;
     if (kvs.keys.size()) {
       msg.AddData(kvs.keys);
@@ -142,6 +214,16 @@ void KVTableBox<Val>::SendChunk(const SlicedKVs& sliced, bool is_add) {
 
 template <typename Val>
 void KVTableBox<Val>::Clock() {
+  clock_ += 1;
+  if (clock_aggregator_id_ != kNoAggregator) {
+    Message msg;
+    msg.meta.sender = app_thread_id_;
+    msg.meta.recver = clock_aggregator_id_;
+    msg.meta.model_id = model_id_;
+    msg.meta.flag = Flag::kClock;
+    send_queue_->Push(std::move(msg));
+    return;
+  }
   CHECK_NOTNULL(partition_manager_);
   const auto& server_thread_ids = partition_manager_->GetServerThreadIds();
   for (uint32_t server_id : server_thread_ids) {
@@ -157,10 +239,14 @@ void KVTableBox<Val>::Clock() {
 template <typename Val>
 void KVTableBox<Val>::HandleMsg(Message& msg) {
   CHECK_EQ(msg.data.size(), 2);
-  KVPairs<Val> kvs;
-  kvs.keys = msg.data[0];
-  kvs.vals = msg.data[1];
-  recv_kvs_.push_back(kvs);
+  third_party::SArray<Key> keys(msg.data[0]);
+  CHECK(!keys.empty());
+  RecvSlice s;
+  s.first = keys.front();
+  s.last = keys.back();
+  s.num_keys = msg.meta.flag == Flag::kGetRangeReply ? NumKeysInRanges(keys) : keys.size();
+  s.vals = msg.data[1];
+  recv_kvs_.push_back(s);
 }
 
 template <typename Val>
@@ -168,14 +254,14 @@ template <typename C>
 void KVTableBox<Val>::HandleFinish(const third_party::SArray<Key>& keys, C* vals) {
   size_t total_key = 0, total_val = 0;
   for (const auto& s : recv_kvs_) {
-    third_party::Range range = third_party::FindRange(keys, s.keys.front(), s.keys.back() + 1);
-    CHECK_EQ(range.size(), s.keys.size()) << "unmatched keys size from one server";
-    total_key += s.keys.size();
+    third_party::Range range = third_party::FindRange(keys, s.first, s.last + 1);
+    CHECK_EQ(range.size(), s.num_keys) << "unmatched keys size from one server";
+    total_key += s.num_keys;
     total_val += s.vals.size();
   }
   CHECK_EQ(total_key, keys.size()) << "lost some servers?";
   std::sort(recv_kvs_.begin(), recv_kvs_.end(),
-            [](const KVPairs<Val>& a, const KVPairs<Val>& b) { return a.keys.front() < b.keys.front(); });
+            [](const RecvSlice& a, const RecvSlice& b) { return a.first < b.first; });
   CHECK_NOTNULL(vals);
   vals->resize(total_val);
   Val* p_vals = vals->data();
@@ -191,19 +277,19 @@ template <typename C>
 void KVTableBox<Val>::HandleChunkFinish(const third_party::SArray<Key>& keys, std::vector<C*>& vals) {
   size_t total_key = 0, total_val = 0;
   for (const auto& s : recv_kvs_) {
-    third_party::Range range = third_party::FindRange(keys, s.keys.front(), s.keys.back() + 1);
-    CHECK_EQ(range.size(), s.keys.size()) << "unmatched keys size from one server";
-    total_key += s.keys.size();
+    third_party::Range range = third_party::FindRange(keys, s.first, s.last + 1);
+    CHECK_EQ(range.size(), s.num_keys) << "unmatched keys size from one server";
+    total_key += s.num_keys;
     total_val += s.vals.size();
   }
   size_t chunk_size = total_val / total_key;
   CHECK_EQ(total_key, keys.size()) << "lost some servers?";
   std::sort(recv_kvs_.begin(), recv_kvs_.end(),
-            [](const KVPairs<Val>& a, const KVPairs<Val>& b) { return a.keys.front() < b.keys.front(); });
+            [](const RecvSlice& a, const RecvSlice& b) { return a.first < b.first; });
   int idx = 0;
   for (const auto& s : recv_kvs_) {
     int start = 0;
-    for (int i = 0; i < s.keys.size(); ++ i) {
+    for (size_t i = 0; i < s.num_keys; ++ i) {
       vals[idx]->resize(chunk_size);
       memcpy(vals[idx]->data(), s.vals.data()+start, chunk_size*sizeof(Val));
       start += chunk_size;
@@ -0,0 +1,36 @@
+#include "worker/node_clock_aggregator.hpp"
+
+#include "glog/logging.h"
+
+namespace flexps {
+
+void NodeClockAggregator::RegisterTable(uint32_t model_id, const std::vector<uint32_t>& local_tids,
+                                        const std::vector<uint32_t>& server_thread_ids) {
+  CHECK(!local_tids.empty());
+  std::lock_guard<std::mutex> lk(mu_);
+  Table& table = tables_[model_id];
+  table.tracker.Init(local_tids);
+  table.server_thread_ids = server_thread_ids;
+}
+
+int NodeClockAggregator::Clock(const Message& msg) {
+  CHECK(msg.meta.flag == Flag::kClock);
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = tables_.find(msg.meta.model_id);
+  CHECK(it != tables_.end()) << "Clocks of table " << msg.meta.model_id << " are not aggregated";
+  Table& table = it->second;
+  int node_clock = table.tracker.AdvanceAndGetChangedMinClock(msg.meta.sender);
+  if (node_clock == -1)
+    return -1;
+  for (uint32_t server_id : table.server_thread_ids) {
+    Message clock;
+    clock.meta.sender = helper_id_;
+    clock.meta.recver = server_id;
+    clock.meta.model_id = msg.meta.model_id;
+    clock.meta.flag = Flag::kClock;
+    send_queue_->Push(std::move(clock));
+  }
+  return node_clock;
+}
+
+}  // namespace flexps
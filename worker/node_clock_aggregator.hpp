@@ -0,0 +1,47 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "base/threadsafe_queue.hpp"
+#include "server/progress_tracker.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * The clock of a node on the tables with node clocks (see KVEngine::AggregateClocks).
+ *
+ * The workers of the node send their kClock to the worker helper thread, which passes it to
+ * Clock(). Once the slowest local worker of a table has advanced, one kClock from the helper is sent
+ * to each server of the table, so an iteration takes N x S clocks on the network instead of W x S
+ * for N nodes of W workers and S servers.
+ */
+class NodeClockAggregator {
+ public:
+  NodeClockAggregator(uint32_t helper_id, ThreadsafeQueue<Message>* const send_queue)
+      : helper_id_(helper_id), send_queue_(send_queue) {}
+
+  // Aggregate the clocks of local_tids on model_id, whose servers are server_thread_ids.
+  void RegisterTable(uint32_t model_id, const std::vector<uint32_t>& local_tids,
+                     const std::vector<uint32_t>& server_thread_ids);
+  // Return the node clock sent, -1 if the min clock of the local workers has not changed.
+  int Clock(const Message& msg);
+
+ private:
+  struct Table {
+    ProgressTracker tracker;
+    std::vector<uint32_t> server_thread_ids;
+  };
+
+  uint32_t helper_id_;
+  // Not owned.
+  ThreadsafeQueue<Message>* const send_queue_;
+
+  // The tables are registered by the engine thread while the helper thread runs.
+  std::mutex mu_;
+  std::unordered_map<uint32_t, Table> tables_;
+};
+
+}  // namespace flexps
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include "glog/logging.h"
+
+#include "worker/node_clock_aggregator.hpp"
+
+namespace flexps {
+namespace {
+
+class TestNodeClockAggregator : public testing::Test {
+ public:
+  TestNodeClockAggregator() {}
+  ~TestNodeClockAggregator() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+Message MakeClock(uint32_t sender, uint32_t model_id) {
+  Message msg;
+  msg.meta.flag = Flag::kClock;
+  msg.meta.sender = sender;
+  msg.meta.recver = 20;
+  msg.meta.model_id = model_id;
+  return msg;
+}
+
+TEST_F(TestNodeClockAggregator, SlowestWorker) {
+  ThreadsafeQueue<Message> queue;
+  NodeClockAggregator aggregator(20, &queue);
+  aggregator.RegisterTable(0, {100, 101, 102}, {0, 1000});
+
+  EXPECT_EQ(aggregator.Clock(MakeClock(100, 0)), -1);
+  EXPECT_EQ(aggregator.Clock(MakeClock(100, 0)), -1);
+  EXPECT_EQ(aggregator.Clock(MakeClock(102, 0)), -1);
+  EXPECT_EQ(queue.Size(), 0);
+  // The slowest worker clocks: one node clock per server
+  EXPECT_EQ(aggregator.Clock(MakeClock(101, 0)), 1);
+  ASSERT_EQ(queue.Size(), 2);
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  EXPECT_EQ(m1.meta.flag, Flag::kClock);
+  EXPECT_EQ(m1.meta.sender, 20);
+  EXPECT_EQ(m1.meta.recver, 0);
+  EXPECT_EQ(m1.meta.model_id, 0);
+  EXPECT_EQ(m2.meta.sender, 20);
+  EXPECT_EQ(m2.meta.recver, 1000);
+}
+
+TEST_F(TestNodeClockAggregator, Tables) {
+  ThreadsafeQueue<Message> queue;
+  NodeClockAggregator aggregator(20, &queue);
+  aggregator.RegisterTable(0, {100, 101}, {0});
+  aggregator.RegisterTable(1, {100, 101}, {0, 1});
+
+  EXPECT_EQ(aggregator.Clock(MakeClock(100, 1)), -1);
+  EXPECT_EQ(aggregator.Clock(MakeClock(101, 0)), -1);
+  EXPECT_EQ(aggregator.Clock(MakeClock(100, 0)), 1);
+  ASSERT_EQ(queue.Size(), 1);
+  EXPECT_EQ(aggregator.Clock(MakeClock(101, 1)), 1);
+  EXPECT_EQ(queue.Size(), 3);
+
+  // Registering again starts the table over, as a new Run does
+  aggregator.RegisterTable(0, {103}, {0});
+  EXPECT_EQ(aggregator.Clock(MakeClock(103, 0)), 1);
+  EXPECT_EQ(queue.Size(), 4);
+}
+
+}  // namespace
+}  // namespace flexps
@@ -35,6 +35,8 @@ class SimpleKVTable {
   void Get(const third_party::SArray<Key>& keys, third_party::SArray<Val>* vals);
 
   void Clock();
+  // See KVTableBox::SetClockAggregator.
+  void SetClockAggregator(uint32_t aggregator_id) { kv_table_box_.SetClockAggregator(aggregator_id); }
 
  protected:
   template <typename C>
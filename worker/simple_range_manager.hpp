@@ -1,5 +1,6 @@
 #pragma once
 
+#include "base/key_width.hpp"
 #include "base/third_party/range.h"
 #include "worker/abstract_partition_manager.hpp"
 #include "worker/kvpairs.hpp"
@@ -24,6 +25,13 @@ class SimpleRangePartitionManager : public AbstractPartitionManager {
   const std::vector<third_party::Range>& GetRanges() const { return ranges_; }
   const std::vector<uint32_t>& GetServerThreadIds() const { return server_thread_ids_; }
 
+  uint8_t GetKeyWidth() const override {
+    uint64_t key_end = 0;
+    for (const auto& range : ranges_)
+      key_end = std::max(key_end, range.end());
+    return flexps::GetKeyWidth(key_end);
+  }
+
   // slice key-value pairs into <server_id, key_value_partition> pairs
   SlicedKVs Slice(const KVPairs<char>& send) const override {
     SlicedKVs sliced;
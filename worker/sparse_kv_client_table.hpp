@@ -251,6 +251,7 @@ void SparseKVClientTable<Val>::Send_(const SlicedKVs& sliced, bool is_add, int v
     msg.meta.recver = sliced[i].first;
     msg.meta.model_id = model_id_;
     msg.meta.flag = is_add ? Flag::kAdd : Flag::kGet;
+    msg.meta.key_width = partition_manager_->GetKeyWidth();
     msg.meta.version = version;
     const auto& kvs = sliced[i].second;
     if (kvs.keys.size()) {
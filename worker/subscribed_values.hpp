@@ -0,0 +1,126 @@
+#pragma once
+
+#include "base/magic.hpp"
+#include "base/message.hpp"
+#include "base/third_party/sarray.h"
+
+#include "worker/abstract_partition_manager.hpp"
+
+#include "glog/logging.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace flexps {
+
+/*
+ * The values of the keys a KVClientTable subscribed to, as last pushed by the servers.
+ *
+ * Each server pushes the values of its slice of the keys in a kPush whose version is the latest
+ * clock the values may serve under the staleness bound. Push() is called by the worker helper thread
+ * and Read() by the app thread, which waits until every slice may serve its clock.
+ */
+template <typename Val>
+class SubscribedValues {
+ public:
+  // The subscribed keys as sliced to the servers, in key order.
+  void Init(const AbstractPartitionManager::SlicedKVs& sliced);
+  bool Empty() const { return slices_.empty(); }
+  // Whether each of the sorted keys is subscribed to.
+  bool Covers(const third_party::SArray<Key>& keys) const;
+
+  void Push(Message& msg);
+  template <typename C>
+  void Read(const third_party::SArray<Key>& keys, int clock, C* vals);
+
+ private:
+  struct Slice {
+    uint32_t server_id;
+    third_party::SArray<Key> keys;
+    third_party::SArray<Val> vals;
+    int version;
+  };
+
+  std::vector<Slice> slices_;
+  std::mutex mu_;
+  std::condition_variable cond_;
+};
+
+template <typename Val>
+void SubscribedValues<Val>::Init(const AbstractPartitionManager::SlicedKVs& sliced) {
+  std::lock_guard<std::mutex> lk(mu_);
+  CHECK(slices_.empty()) << "The keys are subscribed to once";
+  for (const auto& s : sliced) {
+    if (!s.second.keys.empty())
+      slices_.push_back({s.first, s.second.keys, {}, -1});
+  }
+}
+
+template <typename Val>
+bool SubscribedValues<Val>::Covers(const third_party::SArray<Key>& keys) const {
+  if (slices_.empty())
+    return false;
+  size_t k = 0;
+  for (const auto& s : slices_) {
+    size_t j = 0;
+    while (k < keys.size() && j < s.keys.size()) {
+      if (s.keys[j] < keys[k])
+        ++j;
+      else if (s.keys[j] == keys[k])
+        ++j, ++k;
+      else
+        return false;
+    }
+  }
+  return k == keys.size();
+}
+
+template <typename Val>
+void SubscribedValues<Val>::Push(Message& msg) {
+  CHECK(msg.meta.flag == Flag::kPush);
+  CHECK_EQ(msg.data.size(), 1);
+  std::lock_guard<std::mutex> lk(mu_);
+  for (auto& s : slices_) {
+    if (s.server_id == static_cast<uint32_t>(msg.meta.sender)) {
+      s.vals = third_party::SArray<Val>(msg.data[0]);
+      CHECK_EQ(s.vals.size(), s.keys.size()) << "unmatched keys size from one server";
+      s.version = msg.meta.version;
+      cond_.notify_all();
+      return;
+    }
+  }
+  CHECK(false) << "Push from server " << msg.meta.sender << " which is not subscribed to";
+}
+
+template <typename Val>
+template <typename C>
+void SubscribedValues<Val>::Read(const third_party::SArray<Key>& keys, int clock, C* vals) {
+  // The pushed arrays are replaced and never written, so they can be read out of the lock.
+  std::vector<third_party::SArray<Val>> pushed(slices_.size());
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    cond_.wait(lk, [this, clock] {
+      for (const auto& s : slices_) {
+        if (s.version < clock)
+          return false;
+      }
+      return true;
+    });
+    for (size_t i = 0; i < slices_.size(); ++i)
+      pushed[i] = slices_[i].vals;
+  }
+  CHECK_NOTNULL(vals);
+  vals->resize(keys.size());
+  size_t k = 0;
+  for (size_t i = 0; i < slices_.size(); ++i) {
+    const auto& slice_keys = slices_[i].keys;
+    for (size_t j = 0; k < keys.size() && j < slice_keys.size(); ++j) {
+      if (slice_keys[j] == keys[k])
+        (*vals)[k++] = pushed[i][j];
+    }
+  }
+  CHECK_EQ(k, keys.size()) << "Read of keys not subscribed to";
+}
+
+}  // namespace flexps
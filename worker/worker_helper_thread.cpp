@@ -22,6 +22,12 @@ void WorkerHelperThread::Main() {
     if (msg.meta.flag == Flag::kExit)
       break;
 
+    if (msg.meta.flag == Flag::kClock) {
+      CHECK_NOTNULL(clock_aggregator_);
+      clock_aggregator_->Clock(msg);
+      continue;
+    }
+
     CHECK_NOTNULL(receiver_);
     receiver_->AddResponse(msg.meta.recver, msg.meta.model_id, msg);
   }
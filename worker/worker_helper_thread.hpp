@@ -3,6 +3,7 @@
 #include "base/message.hpp"
 #include "base/threadsafe_queue.hpp"
 #include "worker/abstract_receiver.hpp"
+#include "worker/node_clock_aggregator.hpp"
 
 #include <condition_variable>
 #include <memory>
@@ -11,10 +12,12 @@
 
 namespace flexps {
 
+// The kClocks of the local workers are passed to clock_aggregator, see NodeClockAggregator.
 class WorkerHelperThread {
  public:
-  WorkerHelperThread(uint32_t helper_id, AbstractReceiver* const receiver)
-      : helper_id_(helper_id), receiver_(receiver) {}
+  WorkerHelperThread(uint32_t helper_id, AbstractReceiver* const receiver,
+                     NodeClockAggregator* const clock_aggregator = nullptr)
+      : helper_id_(helper_id), receiver_(receiver), clock_aggregator_(clock_aggregator) {}
 
   void Start();
   void Stop();
@@ -29,6 +32,8 @@ class WorkerHelperThread {
   ThreadsafeQueue<Message> work_queue_;
 
   AbstractReceiver* const receiver_;
+  // Not owned.
+  NodeClockAggregator* const clock_aggregator_;
 };
 
 }  // namespace flexps